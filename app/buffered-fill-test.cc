@@ -0,0 +1,189 @@
+/** Check that histograms filled through BufferedFill and BufferedFill2D end up exactly the same as
+ *  histograms filled directly with TH1::Fill: every bin including the underflow and overflow, the
+ *  per-bin sums of squared weights, the statistics and the entries. The values include the axis
+ *  edges, values below and above the axis, NaN, and weighted values (with the per-bin errors
+ *  switched on part way through, as TH1::Fill does on the first weight other than 1).
+ */
+
+// std library headers
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include "TArrayD.h"
+#include "TH1.h"
+#include "TH1D.h"
+#include "TH1F.h"
+#include "TH2.h"
+#include "TH2D.h"
+
+// MICA headers
+#include "mica/BufferedFill.hh"
+
+/** Are two numbers exactly equal, treating NaN as equal to NaN */
+bool same(double aA, double aB) {
+  return aA == aB || (std::isnan(aA) && std::isnan(aB));
+}
+
+/** Compare two histograms exactly, printing each difference found, return the number found */
+int compare(const std::string& aName, TH1& aDirect, TH1& aBuffered) {
+  int ndiff = 0;
+  for (int i = 0; i < aDirect.GetNcells(); ++i) {
+    if (!same(aDirect.GetBinContent(i), aBuffered.GetBinContent(i))) {
+      std::cerr << aName << ": bin " << i << " holds " << aDirect.GetBinContent(i)
+                << ", buffered " << aBuffered.GetBinContent(i) << "\n";
+      ++ndiff;
+    }
+  }
+  if (aDirect.GetSumw2N() != aBuffered.GetSumw2N()) {
+    std::cerr << aName << ": " << aDirect.GetSumw2N() << " sums of squared weights, buffered "
+              << aBuffered.GetSumw2N() << "\n";
+    ++ndiff;
+  } else {
+    for (int i = 0; i < aDirect.GetSumw2N(); ++i) {
+      if (!same(aDirect.GetSumw2()->fArray[i], aBuffered.GetSumw2()->fArray[i])) {
+        std::cerr << aName << ": bin " << i << " sum of squared weights "
+                  << aDirect.GetSumw2()->fArray[i] << ", buffered "
+                  << aBuffered.GetSumw2()->fArray[i] << "\n";
+        ++ndiff;
+      }
+    }
+  }
+  double direct_stats[TH1::kNstat] = {0.0};
+  double buffered_stats[TH1::kNstat] = {0.0};
+  aDirect.GetStats(direct_stats);
+  aBuffered.GetStats(buffered_stats);
+  for (int i = 0; i < TH1::kNstat; ++i) {
+    if (!same(direct_stats[i], buffered_stats[i])) {
+      std::cerr << aName << ": statistic " << i << " is " << direct_stats[i] << ", buffered "
+                << buffered_stats[i] << "\n";
+      ++ndiff;
+    }
+  }
+  if (aDirect.GetEntries() != aBuffered.GetEntries()) {
+    std::cerr << aName << ": " << aDirect.GetEntries() << " entries, buffered "
+              << aBuffered.GetEntries() << "\n";
+    ++ndiff;
+  }
+  std::cout << aName << ": " << (ndiff == 0 ? "same" : "DIFFERENT") << "\n";
+  return ndiff;
+}
+
+/** Make aN values for an axis from aLow to aUp with aNBins bins, mostly inside the axis but
+ *  including every bin edge, values just either side of the ends, far outside and NaN
+ */
+std::vector<double> make_values(std::mt19937& aGen, size_t aN, int aNBins, double aLow,
+                                double aUp) {
+  std::vector<double> special {aLow, aUp, std::nextafter(aLow, aLow - 1.0),
+                               std::nextafter(aUp, aUp + 1.0), std::nextafter(aUp, aLow),
+                               aLow - 1e6, aUp + 1e6, std::numeric_limits<double>::quiet_NaN(),
+                               -std::numeric_limits<double>::infinity(),
+                               std::numeric_limits<double>::infinity()};
+  for (int i = 1; i < aNBins; ++i) special.push_back(aLow + i * (aUp - aLow) / aNBins);
+  double margin = 0.2 * (aUp - aLow);
+  std::uniform_real_distribution<double> uniform(aLow - margin, aUp + margin);
+  std::uniform_int_distribution<size_t> pick(0, special.size() - 1);
+  std::vector<double> values;
+  for (size_t i = 0; i < aN; ++i) {
+    values.push_back(i % 5 == 0 ? special[pick(aGen)] : uniform(aGen));
+  }
+  return values;
+}
+
+/** Make aN weights, all 1 for the first aNUnweighted, then mixed, including 1, 0 and negative */
+std::vector<double> make_weights(std::mt19937& aGen, size_t aN, size_t aNUnweighted) {
+  std::uniform_real_distribution<double> uniform(-0.5, 2.5);
+  std::vector<double> weights;
+  for (size_t i = 0; i < aN; ++i) {
+    if (i < aNUnweighted || i % 7 == 0) {
+      weights.push_back(1.0);
+    } else if (i % 11 == 0) {
+      weights.push_back(0.0);
+    } else {
+      weights.push_back(uniform(aGen));
+    }
+  }
+  return weights;
+}
+
+/** Fill a 1D histogram and its copy, directly and buffered, and compare them */
+int check_1d(const std::string& aName, TH1& aDirect, const std::vector<double>& aX,
+             const std::vector<double>& aW) {
+  TH1* buffered = static_cast<TH1*>(aDirect.Clone((aName + "_buffered").c_str()));
+  mica::BufferedFill fill(buffered);
+  for (size_t i = 0; i < aX.size(); ++i) {
+    // Fill(x) for unit weights as an analyser would, so the errors are not switched on early
+    if (aW[i] == 1.0) {
+      aDirect.Fill(aX[i]);
+      fill.Fill(aX[i]);
+    } else {
+      aDirect.Fill(aX[i], aW[i]);
+      fill.Fill(aX[i], aW[i]);
+    }
+  }
+  fill.Flush();
+  int ndiff = compare(aName, aDirect, *buffered);
+  delete buffered;
+  return ndiff;
+}
+
+/** Fill a 2D histogram and its copy, directly and buffered, and compare them */
+int check_2d(const std::string& aName, TH2& aDirect, const std::vector<double>& aX,
+             const std::vector<double>& aY, const std::vector<double>& aW) {
+  TH2* buffered = static_cast<TH2*>(aDirect.Clone((aName + "_buffered").c_str()));
+  mica::BufferedFill2D fill(buffered);
+  for (size_t i = 0; i < aX.size(); ++i) {
+    if (aW[i] == 1.0) {
+      aDirect.Fill(aX[i], aY[i]);
+      fill.Fill(aX[i], aY[i]);
+    } else {
+      aDirect.Fill(aX[i], aY[i], aW[i]);
+      fill.Fill(aX[i], aY[i], aW[i]);
+    }
+  }
+  fill.Flush();
+  int ndiff = compare(aName, aDirect, *buffered);
+  delete buffered;
+  return ndiff;
+}
+
+/** The test app function */
+int main() {
+  TH1::AddDirectory(kFALSE);
+
+  // Several blocks of values, not a whole number of them, so the last flush is a partial block
+  const size_t n = 10 * mica::BufferedFill::kBlockSize + 17;
+  std::mt19937 gen(1);
+  std::vector<double> x = make_values(gen, n, 50, -10.0, 10.0);
+  std::vector<double> y = make_values(gen, n, 20, 0.0, 3.0);
+  std::vector<double> ones(n, 1.0);
+  std::vector<double> weights = make_weights(gen, n, 3 * mica::BufferedFill::kBlockSize + 5);
+  std::vector<double> all_weighted = make_weights(gen, n, 0);
+
+  int ndiff = 0;
+  TH1D unweighted("unweighted", "", 50, -10.0, 10.0);
+  ndiff += check_1d("TH1D unweighted", unweighted, x, ones);
+  TH1D weighted("weighted", "", 50, -10.0, 10.0);
+  ndiff += check_1d("TH1D weighted part way", weighted, x, weights);
+  TH1F single("single", "", 50, -10.0, 10.0);
+  ndiff += check_1d("TH1F weighted", single, x, all_weighted);
+  TH1D overflows("overflows", "", 50, -10.0, 10.0);
+  overflows.SetStatOverflows(TH1::kConsider);
+  ndiff += check_1d("TH1D overflows in statistics", overflows, x, weights);
+  std::vector<double> edges {-10.0, -5.0, -1.0, 0.0, 0.5, 2.0, 10.0};
+  TH1D variable("variable", "", static_cast<int>(edges.size() - 1), edges.data());
+  ndiff += check_1d("TH1D variable bins", variable, x, weights);
+  TH2D plane("plane", "", 50, -10.0, 10.0, 20, 0.0, 3.0);
+  ndiff += check_2d("TH2D weighted part way", plane, x, y, weights);
+
+  if (ndiff > 0) {
+    std::cerr << ndiff << " differences between direct and buffered filling\n";
+    return 1;
+  }
+  std::cout << "Buffered filling matches direct filling exactly\n";
+  return 0;
+}
@@ -24,6 +24,7 @@
 // MICA headers
 #include "mica/AnalyserBase.hh"
 #include "mica/AnalyserFactory.hh"
+#include "mica/EventContext.hh"
 #include "mica/AnalyserTrackerPRSeedResidual.hh"
 #include "mica/AnalyserTrackerPREfficiency.hh"
 
@@ -96,8 +97,9 @@ int main(int argc, char *argv[]) {
       MAUS::MCEvent* mevt = nullptr;
       if (event_counter < static_cast<int>(spill->GetMCEvents()->size()))
         mevt = spill->GetMCEvents()->at(event_counter);
+      mica::EventContext context(revt, mevt);
       for (auto an : analysers) {
-        an->Analyse(revt, mevt);
+        an->Analyse(context);
         an->Update();
         for (auto pad : an->GetPads()) {
           if (pad) {
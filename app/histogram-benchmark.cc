@@ -0,0 +1,121 @@
+/** Benchmark filling one shared AtomicHistogram2D from many threads against the per-thread
+ *  replica histograms plus merge used by the event loop, over a range of thread counts.
+ */
+
+// std library headers
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ROOT headers
+#include "TH1.h"
+#include "TH2.h"
+#include "TROOT.h"
+
+// MICA headers
+#include "mica/AtomicHistogram.hh"
+
+/** The values filled by one thread, made before the timing starts */
+typedef std::vector<std::pair<double, double>> Values;
+
+/** Return the time taken by a function (s) */
+template <class F>
+double time_it(F aFunction) {
+  auto start = std::chrono::steady_clock::now();
+  aFunction();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** The benchmark app function */
+int main(int argc, char *argv[]) {
+  long nfills = 20000000;
+  int nbins = 512;
+  int max_threads = 64;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-f" || arg == "--fills") && (i + 1) < argc) {
+      nfills = std::atol(argv[++i]);
+    } else if ((arg == "-b" || arg == "--bins") && (i + 1) < argc) {
+      nbins = std::atoi(argv[++i]);
+    } else if ((arg == "-t" || arg == "--max-threads") && (i + 1) < argc) {
+      max_threads = std::atoi(argv[++i]);
+    } else {
+      std::cerr << "Usage: histogram-benchmark [--fills N] [--bins N] [--max-threads N]\n";
+      return -1;
+    }
+  }
+
+  ROOT::EnableThreadSafety();
+  TH1::AddDirectory(kFALSE);
+
+  std::cout << "Filling " << nfills << " values into a " << nbins << " x " << nbins
+            << " histogram, times in s\n";
+  std::cout << std::setw(8) << "Threads" << std::setw(12) << "Atomic" << std::setw(12)
+            << "Replicas" << std::setw(12) << "(merge)" << std::setw(10) << "Speedup"
+            << std::setw(14) << "Atomic MB" << std::setw(14) << "Replicas MB" << "\n";
+  double cell_mb = static_cast<double>(nbins + 2) * (nbins + 2) * 8.0 / (1024.0 * 1024.0);
+
+  for (int nthreads = 1; nthreads <= max_threads; nthreads *= 2) {
+    // A narrow gaussian, so that the central bins are contended as in real data
+    std::vector<Values> values(nthreads);
+    for (int t = 0; t < nthreads; ++t) {
+      std::mt19937 gen(t);
+      std::normal_distribution<double> dist(0.0, 0.2);
+      values[t].resize(nfills / nthreads);
+      for (auto& v : values[t]) v = std::make_pair(dist(gen), dist(gen));
+    }
+
+    // One shared histogram filled by every thread, then converted for drawing
+    mica::AtomicHistogram2D shared("hShared", "Shared", nbins, -1.0, 1.0, nbins, -1.0, 1.0);
+    std::unique_ptr<TH2D> shared_result;
+    double atomic_time = time_it([&]() {
+      std::vector<std::thread> threads;
+      for (int t = 0; t < nthreads; ++t) {
+        threads.emplace_back([&shared, &values, t]() {
+          for (const auto& v : values[t]) shared.Fill(v.first, v.second);
+        });
+      }
+      for (auto& thread : threads) thread.join();
+      shared_result.reset(shared.Make<TH2D>());
+    });
+
+    // A replica per thread, merged into the first at the end
+    std::vector<std::unique_ptr<TH2D>> replicas(nthreads);
+    double merge_time = 0.0;
+    double replica_time = time_it([&]() {
+      std::vector<std::thread> threads;
+      for (int t = 0; t < nthreads; ++t) {
+        threads.emplace_back([&replicas, &values, nbins, t]() {
+          replicas[t].reset(new TH2D("hReplica", "Replica", nbins, -1.0, 1.0, nbins, -1.0, 1.0));
+          for (const auto& v : values[t]) replicas[t]->Fill(v.first, v.second);
+        });
+      }
+      for (auto& thread : threads) thread.join();
+      merge_time = time_it([&]() {
+        for (int t = 1; t < nthreads; ++t) replicas[0]->Add(replicas[t].get());
+      });
+    });
+
+    // The two methods must agree exactly
+    for (int i = 0; i < shared.GetNCells(); ++i) {
+      if (shared.GetBinContent(i) != replicas[0]->GetBinContent(i)) {
+        std::cerr << "Mismatch in cell " << i << " with " << nthreads << " threads\n";
+        return -1;
+      }
+    }
+
+    std::cout << std::setw(8) << nthreads << std::fixed << std::setprecision(3)
+              << std::setw(12) << atomic_time << std::setw(12) << replica_time
+              << std::setw(12) << merge_time << std::setw(10) << std::setprecision(2)
+              << replica_time / atomic_time << std::setw(14) << std::setprecision(1)
+              << cell_mb << std::setw(14) << cell_mb * nthreads << std::endl;
+  }
+  return 0;
+}
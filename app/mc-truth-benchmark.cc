@@ -0,0 +1,352 @@
+/** Benchmark building the tracker MC truth of dense synthetic MC events with mica::MCTruth, which
+ *  counts the stations and planes each track hit with TrackHitMasks, against the maps of station
+ *  and plane hits used before. The tracks MCTruth finds reconstructible, and the stations each
+ *  hit, must be exactly those the previous station counting gives, with each track's data taken
+ *  from its own first hit in the reference plane (the previous method took it from whichever
+ *  track's hit it found first, for the one track numbered as the reference station). Then count the
+ *  heap allocations per event when the events arrive in multi-event spills at an analyser group,
+ *  whose MC analysers share the pooled truths through the event contexts.
+ */
+
+// std library headers
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// MAUS headers
+#include "src/common_cpp/DataStructure/MCEvent.hh"
+#include "src/common_cpp/DataStructure/Hit.hh"
+#include "src/common_cpp/DataStructure/ThreeVector.hh"
+#include "src/common_cpp/Recon/SciFi/SciFiLookup.hh"
+
+// MICA headers
+#include "mica/AnalyserGroup.hh"
+#include "mica/AnalyserTrackerMC.hh"
+#include "mica/EventContext.hh"
+#include "mica/MCTruth.hh"
+
+/** The heap allocations made so far, counted by the replacement operator new below */
+std::atomic<long> gNAllocations{0};
+
+void* operator new(std::size_t aSize) {
+  ++gNAllocations;
+  void* ptr = std::malloc(aSize == 0 ? 1 : aSize);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* aPtr) noexcept {
+  std::free(aPtr);
+}
+
+/** An MC analyser which only reads the shared truth, standing in for the real MC analysers */
+class TruthReader : public mica::AnalyserTrackerMC {
+  public:
+    /** @brief Return the reconstructible tracks seen so far */
+    size_t GetNTracks() const { return mNTracks; }
+
+  private:
+    virtual bool analyse_recon(MAUS::ReconEvent* const aReconEvent) override {
+      mNTracks += GetMCDataTkU().size() + GetMCDataTkD().size();
+      return true;
+    }
+    virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override { return true; }
+
+    size_t mNTracks = 0; ///< The reconstructible tracks seen so far
+};
+
+/** The MCTrackData of one event, for each tracker */
+typedef std::array<std::vector<mica::MCTrackData>, 2> Result;
+
+/** Return the time taken by a function (s) */
+template <class F>
+double time_it(F aFunction) {
+  auto start = std::chrono::steady_clock::now();
+  aFunction();
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** The previous implementation of MCTruth::calc_stations_hit_by_track, kept verbatim: for each
+ *  station, a map of the planes hit by each track
+ */
+std::map<int, std::vector<int> > \
+    previous_stations_hit_by_track(std::map<int, std::vector<MAUS::SciFiHit*> >& hit_map,
+                                   int aNPlanes) {
+  std::map<int, std::vector<int> > stations_hit_by_track; // stations_hit_by_track[trk_id]
+  for (auto& station : hit_map) {
+    // planes_hit_by_track[track_id][plane] = true or false - did track generate hit in this plane
+    std::map<int, std::map<int, bool> > planes_hit_by_track;
+    for (auto hit : station.second) {
+      planes_hit_by_track[hit->GetTrackId()][hit->GetChannelId()->GetPlaneNumber()] = true;
+    }
+    for (auto& trk : planes_hit_by_track) {
+      if (trk.second.size() >= aNPlanes) { // Did track produce hits in >= 2 planes of this station
+        stations_hit_by_track[trk.first].push_back(station.first);
+      }
+    }
+  }
+  return stations_hit_by_track;
+}
+
+/** The previous method, kept verbatim: the lookup table, hits sorted into maps by station, then
+ *  maps of planes hit per track (see previous_stations_hit_by_track)
+ */
+Result with_maps(MAUS::MCEvent* aMCEvent, const mica::MCTruth::Settings& aSettings) {
+  Result result;
+  MAUS::SciFiLookup lookup;
+  lookup.make_hits_map(aMCEvent);
+  std::map<int, std::vector<MAUS::SciFiHit*> > hit_maps[2];
+  for (auto&& hit_ref : *aMCEvent->GetSciFiHits()) {
+    MAUS::SciFiHit* hit = &hit_ref;
+    int tracker = hit->GetChannelId()->GetTrackerNumber();
+    if (tracker == 0 || tracker == 1) {
+      hit_maps[tracker][hit->GetChannelId()->GetStationNumber()].push_back(hit);
+    }
+  }
+  for (int tracker = 0; tracker < 2; ++tracker) {
+    std::map<int, std::vector<int> > stations_hit_by_track = \
+        previous_stations_hit_by_track(hit_maps[tracker], aSettings.n_planes);
+    for (auto trk : stations_hit_by_track) {
+      if (static_cast<int>(trk.second.size()) < aSettings.n_stations) continue;
+      for (auto hit : hit_maps[tracker][trk.first]) {
+        if (hit->GetChannelId()->GetStationNumber() == aSettings.ref_station && \
+            hit->GetChannelId()->GetPlaneNumber() == aSettings.ref_plane) {
+          mica::MCTrackData data;
+          data.tracker = tracker;
+          data.track_id = trk.first;
+          data.pid = hit->GetParticleId();
+          data.energy = hit->GetEnergy();
+          data.pos = hit->GetPosition();
+          data.mom = hit->GetMomentum();
+          result[tracker].push_back(data);
+          break;
+        }
+      }
+    }
+  }
+  return result;
+}
+
+/** The MCTrackData expected of MCTruth: the tracks reconstructible by the previous station
+ *  counting, with the stations they hit, taking their data from their own first hit in the
+ *  reference plane
+ */
+Result expected(MAUS::MCEvent* aMCEvent, const mica::MCTruth::Settings& aSettings) {
+  Result result;
+  std::map<int, std::vector<MAUS::SciFiHit*> > hit_maps[2];
+  std::map<int, MAUS::SciFiHit*> ref_hits[2];
+  for (auto&& hit_ref : *aMCEvent->GetSciFiHits()) {
+    MAUS::SciFiHit* hit = &hit_ref;
+    int tracker = hit->GetChannelId()->GetTrackerNumber();
+    if (tracker == 0 || tracker == 1) {
+      hit_maps[tracker][hit->GetChannelId()->GetStationNumber()].push_back(hit);
+      if (hit->GetChannelId()->GetStationNumber() == aSettings.ref_station && \
+          hit->GetChannelId()->GetPlaneNumber() == aSettings.ref_plane) {
+        ref_hits[tracker].insert(std::make_pair(hit->GetTrackId(), hit));
+      }
+    }
+  }
+  for (int tracker = 0; tracker < 2; ++tracker) {
+    std::map<int, std::vector<int> > stations_hit_by_track = \
+        previous_stations_hit_by_track(hit_maps[tracker], aSettings.n_planes);
+    for (auto trk : stations_hit_by_track) {
+      if (static_cast<int>(trk.second.size()) < aSettings.n_stations) continue;
+      auto ref = ref_hits[tracker].find(trk.first);
+      if (ref == ref_hits[tracker].end()) continue;
+      MAUS::SciFiHit* hit = ref->second;
+      mica::MCTrackData data;
+      data.tracker = tracker;
+      data.track_id = trk.first;
+      data.pid = hit->GetParticleId();
+      data.energy = hit->GetEnergy();
+      data.pos = hit->GetPosition();
+      data.mom = hit->GetMomentum();
+      data.stations_hit = trk.second;
+      result[tracker].push_back(data);
+    }
+  }
+  return result;
+}
+
+/** The new method: the MCTruth, rebuilt event after event */
+Result with_truth(MAUS::MCEvent* aMCEvent, const mica::MCTruth::Settings& aSettings,
+                  mica::MCTruth& aTruth) {
+  Result result;
+  aTruth.Build(aMCEvent, aSettings);
+  for (auto data : aTruth.GetMCDataTkU()) result[0].push_back(*data);
+  for (auto data : aTruth.GetMCDataTkD()) result[1].push_back(*data);
+  return result;
+}
+
+/** Are two vectors exactly equal */
+bool same(const MAUS::ThreeVector& aA, const MAUS::ThreeVector& aB) {
+  return aA.x() == aB.x() && aA.y() == aB.y() && aA.z() == aB.z();
+}
+
+/** Are the MCTrackData of two results exactly equal */
+bool same(const Result& aA, const Result& aB) {
+  for (int tracker = 0; tracker < 2; ++tracker) {
+    if (aA[tracker].size() != aB[tracker].size()) return false;
+    for (size_t i = 0; i < aA[tracker].size(); ++i) {
+      const mica::MCTrackData& a = aA[tracker][i];
+      const mica::MCTrackData& b = aB[tracker][i];
+      if (a.tracker != b.tracker || a.track_id != b.track_id || a.pid != b.pid ||
+          a.energy != b.energy || !same(a.pos, b.pos) || !same(a.mom, b.mom) ||
+          a.stations_hit != b.stations_hit) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/** Make an MC event of aNTracks tracks, most crossing every plane of a tracker (often several hits
+ *  per plane, as from several fibres) and some leaving only a few scattered hits
+ */
+MAUS::MCEvent* make_event(std::mt19937& aGen, int aNTracks) {
+  MAUS::SciFiHitArray* hits = new MAUS::SciFiHitArray();
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::uniform_int_distribution<int> fibre(0, 213);
+  for (int trk = 1; trk <= aNTracks; ++trk) {
+    int tracker = trk % 2;
+    int pid = uniform(aGen) < 0.9 ? -13 : 11;
+    bool through_going = uniform(aGen) < 0.7;
+    for (int st = 1; st <= 5; ++st) {
+      for (int pl = 0; pl < 3; ++pl) {
+        double p = through_going ? 0.95 : 0.2;
+        while (uniform(aGen) < p) {
+          MAUS::SciFiChannelId* id = new MAUS::SciFiChannelId();
+          int channel = fibre(aGen);
+          id->SetTrackerNumber(tracker);
+          id->SetStationNumber(st);
+          id->SetPlaneNumber(pl);
+          id->SetFibreNumber(channel);
+          id->SetID(tracker * 100000 + st * 10000 + pl * 1000 + channel);
+          MAUS::SciFiHit hit;
+          hit.SetChannelId(id);
+          hit.SetTrackId(trk);
+          hit.SetParticleId(pid);
+          hit.SetEnergy(200.0 + 50.0 * uniform(aGen));
+          hit.SetPosition(MAUS::ThreeVector(100.0 * uniform(aGen), 100.0 * uniform(aGen),
+                                            1000.0 * st + pl));
+          hit.SetMomentum(MAUS::ThreeVector(20.0 * uniform(aGen), 20.0 * uniform(aGen),
+                                            200.0 * uniform(aGen)));
+          hits->push_back(hit);
+          p *= 0.5;
+        }
+      }
+    }
+  }
+  std::shuffle(hits->begin(), hits->end(), aGen);
+  MAUS::MCEvent* event = new MAUS::MCEvent();
+  event->SetSciFiHits(hits);
+  return event;
+}
+
+/** The benchmark app function */
+int main(int argc, char *argv[]) {
+  int nevents = 20000;
+  int ntracks = 40;
+  int spill_size = 100;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-e" || arg == "--events") && (i + 1) < argc) {
+      nevents = std::atoi(argv[++i]);
+    } else if ((arg == "-t" || arg == "--tracks") && (i + 1) < argc) {
+      ntracks = std::atoi(argv[++i]);
+    } else if ((arg == "-s" || arg == "--spill") && (i + 1) < argc) {
+      spill_size = std::atoi(argv[++i]);
+    } else {
+      nevents = 0;
+      break;
+    }
+  }
+  if (nevents <= 0 || ntracks <= 0 || spill_size <= 0) {
+    std::cerr << "Usage: mc-truth-benchmark [--events N] [--tracks N] [--spill N], with N > 0\n";
+    return -1;
+  }
+
+  std::mt19937 gen(1);
+  std::vector<std::unique_ptr<MAUS::MCEvent> > events(nevents);
+  size_t nhits = 0;
+  for (auto& event : events) {
+    event.reset(make_event(gen, ntracks));
+    nhits += event->GetSciFiHits()->size();
+  }
+  std::cout << "Building the tracker MC truth of " << nevents << " events of " << ntracks
+            << " tracks (" << nhits / nevents << " hits per event)\n";
+
+  mica::MCTruth::Settings settings;
+  std::vector<Result> map_results(nevents);
+  double map_time = time_it([&]() {
+    for (int i = 0; i < nevents; ++i) map_results[i] = with_maps(events[i].get(), settings);
+  });
+
+  std::vector<Result> truth_results(nevents);
+  mica::MCTruth truth;
+  double truth_time = time_it([&]() {
+    for (int i = 0; i < nevents; ++i) {
+      truth_results[i] = with_truth(events[i].get(), settings, truth);
+    }
+  });
+
+  // The truth must agree exactly with the previous station counting
+  for (int i = 0; i < nevents; ++i) {
+    if (!same(expected(events[i].get(), settings), truth_results[i])) {
+      std::cerr << "Mismatch in event " << i << "\n";
+      return -1;
+    }
+  }
+
+  std::cout << std::fixed << std::setprecision(3) << std::setw(10) << "Maps" << std::setw(12)
+            << map_time << " s\n" << std::setw(10) << "MCTruth" << std::setw(12) << truth_time
+            << " s\n" << std::setw(10) << "Speedup" << std::setw(12) << std::setprecision(1)
+            << map_time / truth_time << "\n";
+
+  // Allocations per event building one truth over and over, which is mostly the MAUS lookup
+  // table, then through an analyser group given whole spills. The first spill warms the pool.
+  long start = gNAllocations;
+  for (int i = 0; i < nevents; ++i) truth.Build(events[i].get(), settings);
+  double truth_allocations = static_cast<double>(gNAllocations - start) / nevents;
+
+  mica::AnalyserGroup analysers;
+  TruthReader* readers[2] = {new TruthReader(), new TruthReader()};
+  for (auto reader : readers) analysers.AddAnalyser(reader);
+  std::vector<mica::EventContext> contexts;
+  std::vector<const mica::EventContext*> pointers;
+  contexts.reserve(spill_size);
+  pointers.reserve(spill_size);
+  long nmeasured = 0;
+  for (int first = 0; first < nevents; first += spill_size) {
+    if (first == spill_size) start = gNAllocations;
+    int last = std::min(nevents, first + spill_size);
+    contexts.clear();
+    pointers.clear();
+    for (int i = first; i < last; ++i) contexts.emplace_back(nullptr, events[i].get());
+    for (const auto& context : contexts) pointers.push_back(&context);
+    analysers.AnalyseSpill(pointers);
+    if (first >= spill_size) nmeasured += last - first;
+  }
+  if (readers[0]->GetNTracks() != readers[1]->GetNTracks()) {
+    std::cerr << "The analysers saw different MC truths\n";
+    return -1;
+  }
+  std::cout << std::setprecision(1) << "Allocations per event, one truth rebuilt: "
+            << truth_allocations << "\n";
+  if (nmeasured > 0) {
+    std::cout << "Allocations per event, spills of " << spill_size << " events after the first: "
+              << static_cast<double>(gNAllocations - start) / nmeasured << "\n";
+  }
+  return 0;
+}
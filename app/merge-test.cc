@@ -0,0 +1,236 @@
+/** Check that analysing the spills of MAUS output files split between two replicas of the
+ *  analysers, then merging the replicas, gives the same results as analysing them all in one
+ *  instance. Every registered analyser which supports saving (see AnalyserBase::Save) is
+ *  compared: every histogram bin including the underflow and overflow, the bin errors, entries
+ *  and statistics, and every counter. The replicas are merged into a separate group twice,
+ *  resetting it in between as the checkpoints of EventLoop do, so anything Reset leaves behind
+ *  shows up as a difference too.
+ */
+
+// std library headers
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include "Rtypes.h"
+#include "TChain.h"
+#include "TDirectory.h"
+#include "TH1.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TMemFile.h"
+#include "TParameter.h"
+
+// MAUS headers
+#include "src/common_cpp/DataStructure/Data.hh"
+#include "src/common_cpp/DataStructure/Spill.hh"
+
+// MICA headers
+#include "mica/AnalyserFactory.hh"
+#include "mica/AnalyserGroup.hh"
+#include "mica/EventContext.hh"
+
+/** Every registered analyser */
+const std::vector<std::string> kAnalyserNames {"AnalyserTofTracker",
+                                               "AnalyserTrackerAngularMomentum",
+                                               "AnalyserTrackerChannelHits",
+                                               "AnalyserTrackerKFMomentum",
+                                               "AnalyserTrackerKFStats",
+                                               "AnalyserTrackerMCPRResiduals",
+                                               "AnalyserTrackerMCPurity",
+                                               "AnalyserTrackerPREfficiency",
+                                               "AnalyserTrackerPRSeedNPEResidual",
+                                               "AnalyserTrackerPRSeedResidual",
+                                               "AnalyserTrackerPRStats",
+                                               "AnalyserTrackerSpacePoints",
+                                               "AnalyserTrackerSpacePointSearch",
+                                               "AnalyserTrackerSpacePointSearchStation",
+                                               "AnalyserViewerRealSpace"};
+
+/** Are two numbers equal, up to the rounding from adding them up in a different order */
+bool same(double aA, double aB) {
+  if (std::isnan(aA) || std::isnan(aB)) return std::isnan(aA) && std::isnan(aB);
+  return std::fabs(aA - aB) <= 1e-9 * std::max(std::fabs(aA), std::fabs(aB));
+}
+
+/** Compare two histograms, printing each difference found, return the number found */
+int compare_histograms(const std::string& aPath, const TH1* aSingle, const TH1* aMerged) {
+  if (aSingle->GetNcells() != aMerged->GetNcells()) {
+    std::cerr << aPath << ": " << aSingle->GetNcells() << " bins, merged "
+              << aMerged->GetNcells() << "\n";
+    return 1;
+  }
+  int ndiff = 0;
+  for (int i = 0; i < aSingle->GetNcells(); ++i) {
+    if (!same(aSingle->GetBinContent(i), aMerged->GetBinContent(i)) ||
+        !same(aSingle->GetBinError(i), aMerged->GetBinError(i))) {
+      if (ndiff < 10) {
+        std::cerr << aPath << ": bin " << i << " holds " << aSingle->GetBinContent(i) << " +- "
+                  << aSingle->GetBinError(i) << ", merged " << aMerged->GetBinContent(i) << " +- "
+                  << aMerged->GetBinError(i) << "\n";
+      }
+      ++ndiff;
+    }
+  }
+  if (aSingle->GetEntries() != aMerged->GetEntries()) {
+    std::cerr << aPath << ": " << aSingle->GetEntries() << " entries, merged "
+              << aMerged->GetEntries() << "\n";
+    ++ndiff;
+  }
+  double single_stats[TH1::kNstat] = {0.0};
+  double merged_stats[TH1::kNstat] = {0.0};
+  aSingle->GetStats(single_stats);
+  aMerged->GetStats(merged_stats);
+  for (int i = 0; i < TH1::kNstat; ++i) {
+    if (!same(single_stats[i], merged_stats[i])) {
+      std::cerr << aPath << ": statistic " << i << " is " << single_stats[i] << ", merged "
+                << merged_stats[i] << "\n";
+      ++ndiff;
+    }
+  }
+  return ndiff;
+}
+
+/** Compare two counters of type T, return -1 if they are not of that type */
+template <typename T>
+int compare_parameters(const std::string& aPath, const TObject* aSingle, const TObject* aMerged) {
+  const TParameter<T>* single = dynamic_cast<const TParameter<T>*>(aSingle);
+  const TParameter<T>* merged = dynamic_cast<const TParameter<T>*>(aMerged);
+  if (!single || !merged) return -1;
+  if (same(single->GetVal(), merged->GetVal())) return 0;
+  std::cerr << aPath << ": " << single->GetVal() << ", merged " << merged->GetVal() << "\n";
+  return 1;
+}
+
+/** Compare everything saved in two directories, recursively, return the differences found */
+int compare_directories(const std::string& aPath, TDirectory* aSingle, TDirectory* aMerged) {
+  int ndiff = 0;
+  if (aSingle->GetListOfKeys()->GetEntries() != aMerged->GetListOfKeys()->GetEntries()) {
+    std::cerr << aPath << ": " << aSingle->GetListOfKeys()->GetEntries() << " objects, merged "
+              << aMerged->GetListOfKeys()->GetEntries() << "\n";
+    ++ndiff;
+  }
+  TIter next(aSingle->GetListOfKeys());
+  while (TKey* key = static_cast<TKey*>(next())) {
+    std::string name = key->GetName();
+    std::string path = aPath + "/" + name;
+    TDirectory* single_dir = aSingle->GetDirectory(name.c_str());
+    if (single_dir) {
+      TDirectory* merged_dir = aMerged->GetDirectory(name.c_str());
+      if (!merged_dir) {
+        std::cerr << path << ": missing from the merged results\n";
+        ++ndiff;
+      } else {
+        ndiff += compare_directories(path, single_dir, merged_dir);
+      }
+      continue;
+    }
+    std::unique_ptr<TObject> single(key->ReadObj());
+    std::unique_ptr<TObject> merged(aMerged->Get(name.c_str()));
+    if (!merged) {
+      std::cerr << path << ": missing from the merged results\n";
+      ++ndiff;
+      continue;
+    }
+    const TH1* single_hist = dynamic_cast<const TH1*>(single.get());
+    const TH1* merged_hist = dynamic_cast<const TH1*>(merged.get());
+    if (single_hist && merged_hist) {
+      ndiff += compare_histograms(path, single_hist, merged_hist);
+      continue;
+    }
+    int result = compare_parameters<double>(path, single.get(), merged.get());
+    if (result < 0) result = compare_parameters<int>(path, single.get(), merged.get());
+    if (result < 0) result = compare_parameters<Long64_t>(path, single.get(), merged.get());
+    if (result < 0) {
+      std::cerr << path << ": cannot compare a " << single->ClassName() << "\n";
+      result = 1;
+    }
+    ndiff += result;
+  }
+  return ndiff;
+}
+
+/** The test app function */
+int main(int argc, char *argv[]) {
+  std::vector<std::string> infiles;
+  for (int i = 1; i < argc; ++i) infiles.push_back(argv[i]);
+  if (infiles.size() == 0) {
+    std::cerr << "Usage: merge-test input.root [input2.root ...]\n";
+    return -1;
+  }
+
+  // Histogram names repeat between the instances
+  TH1::AddDirectory(kFALSE);
+
+  TChain chain("Spill");
+  for (const auto& fname : infiles) {
+    if (chain.Add(fname.c_str(), 0) < 1) {
+      std::cerr << "Failed to find Spill tree in file: " << fname << "\n";
+      return -1;
+    }
+  }
+  MAUS::Data* data = nullptr;  // Don't forget = nullptr or you get a seg fault
+  chain.SetBranchAddress("data", &data); // Yes, this is the *address* of a *pointer*
+
+  // One instance sees every spill, the two replicas see alternate spills
+  mica::AnalyserGroup single = mica::AnalyserFactory::CreateAnalyserGroup(kAnalyserNames);
+  mica::AnalyserGroup replicas[2] = {mica::AnalyserFactory::CreateAnalyserGroup(kAnalyserNames),
+                                     mica::AnalyserFactory::CreateAnalyserGroup(kAnalyserNames)};
+  Long64_t nspills = chain.GetEntries();
+  long nevents = 0;
+  for (Long64_t i = 0; i < nspills; ++i) {
+    chain.GetEntry(i);
+    MAUS::Spill* spill = data ? data->GetSpill() : nullptr;
+    if (!spill || spill->GetDaqEventType() != "physics_event") continue;
+    auto revts = spill->GetReconEvents();
+    auto mevts = spill->GetMCEvents();
+    std::vector<mica::EventContext> contexts;
+    contexts.reserve(revts->size());
+    for (size_t j = 0; j < revts->size(); ++j) {
+      MAUS::MCEvent* mevt = nullptr;
+      if (mevts && j < mevts->size()) mevt = mevts->at(j);
+      contexts.emplace_back(revts->at(j), mevt, i, static_cast<int>(j));
+    }
+    std::vector<const mica::EventContext*> pointers;
+    for (const auto& context : contexts) pointers.push_back(&context);
+    single.AnalyseSpill(pointers);
+    replicas[i % 2].AnalyseSpill(pointers);
+    nevents += static_cast<long>(contexts.size());
+  }
+  chain.ResetBranchAddresses();
+  std::cout << "Analysed " << nevents << " events from " << nspills << " spills\n";
+
+  mica::AnalyserGroup merged = mica::AnalyserFactory::CreateAnalyserGroup(kAnalyserNames);
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass > 0 && !merged.Reset()) {
+      std::cerr << "Not all analysers support being reset\n";
+      return 1;
+    }
+    for (auto& replica : replicas) {
+      if (!merged.Merge(&replica)) {
+        std::cerr << "Not all analysers support merging\n";
+        return 1;
+      }
+    }
+  }
+
+  // Compare all that each analyser saves of its results
+  TMemFile single_file("merge-test-single.root", "RECREATE");
+  TMemFile merged_file("merge-test-merged.root", "RECREATE");
+  if (!single.Save(&single_file) || !merged.Save(&merged_file)) {
+    std::cerr << "Not all analysers support saving, so their results cannot be compared\n";
+    return 1;
+  }
+  int ndiff = compare_directories("", &single_file, &merged_file);
+  if (ndiff > 0) {
+    std::cerr << ndiff << " differences between the merged and single pass results\n";
+    return 1;
+  }
+  std::cout << "Merged results of " << kAnalyserNames.size()
+            << " analysers match the single pass\n";
+  return 0;
+}
@@ -0,0 +1,105 @@
+/** Batch driver for the Muon Ionization Cooling Analysis (MICA) framework. Analyses a list of
+ *  runs in one process, producing plots for each run and for all the runs combined.
+ */
+
+// std library headers
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+// ROOT headers
+#include "TH1.h"
+
+// MICA headers
+#include "mica/AnalyserFactory.hh"
+#include "mica/AnalyserGroup.hh"
+#include "mica/BatchRunner.hh"
+#include "mica/Log.hh"
+#include "mica/ResultsFile.hh"
+
+/** Replace each '#' in a file name pattern with the run label */
+std::string substitute_label(const std::string& aPattern, const std::string& aLabel);
+
+/** Write the results to a ROOT file if the name ends in .root, otherwise plot them to a pdf */
+bool write_output(const std::string& aFileName, mica::AnalyserGroup& aAnalysers);
+
+/** The batch app function - read the run list, analyse every file, plot each run and the total */
+int main(int argc, char *argv[]) {
+  int nworkers = 1;
+  std::string run_output = "analysis_#.pdf";
+  std::string combined_output = "analysis_combined.pdf";
+  std::vector<std::string> run_lists;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-n" || arg == "--nworkers") && (i + 1) < argc) {
+      nworkers = std::atoi(argv[++i]);
+    } else if ((arg == "-o" || arg == "--output") && (i + 1) < argc) {
+      run_output = argv[++i];
+    } else if ((arg == "-c" || arg == "--combined") && (i + 1) < argc) {
+      combined_output = argv[++i];
+    } else if (arg == "--log-level" && (i + 1) < argc) {
+      if (!mica::Log::SetLevel(argv[++i])) {
+        std::cerr << "Unknown log level " << argv[i]
+                  << ", use trace, debug, info, warning or error\n";
+        return -1;
+      }
+    } else {
+      run_lists.push_back(arg);
+    }
+  }
+
+  if (run_lists.size() == 0) {
+    std::cerr << "Usage: mica-batch [--nworkers N] [--output analysis_#.pdf] "
+              << "[--combined analysis_combined.pdf] [--log-level info] "
+              << "runs.txt [runs2.txt ...]\n";
+    std::cerr << "Each line of a run list holds a run label followed by the files of that run\n";
+    std::cerr << "Outputs ending in .root hold the histograms, for mica-render, instead of plots\n";
+    return -1;
+  }
+
+  // Histograms are owned by the analysers, and names repeat between jobs, so keep them out of
+  // the ROOT directory structure
+  TH1::AddDirectory(kFALSE);
+
+  mica::BatchRunner runner(mica::AnalyserFactory::CreateDefaultAnalyserGroup);
+  runner.SetNWorkers(nworkers);
+  for (const auto& list : run_lists) {
+    if (!runner.ReadRunList(list)) return -1;
+  }
+  std::cout << "Running on " << nworkers << " workers" << std::endl;
+  bool success = runner.Run();
+
+  // Output each run, then the combination of all the runs
+  for (size_t i = 0; i < runner.GetNRuns(); ++i) {
+    std::string ofname = substitute_label(run_output, runner.GetRunLabel(i));
+    std::cout << "Run " << runner.GetRunLabel(i) << " output file " << ofname << std::endl;
+    if (!write_output(ofname, runner.GetRunResult(i))) success = false;
+  }
+  if (runner.GetNRuns() > 1) {
+    std::cout << "Combined output file " << combined_output << std::endl;
+    if (!write_output(combined_output, runner.GetCombinedResult())) success = false;
+  }
+
+  return success ? 0 : -1;
+}
+
+std::string substitute_label(const std::string& aPattern, const std::string& aLabel) {
+  std::string result;
+  for (auto c : aPattern) {
+    if (c == '#') {
+      result += aLabel;
+    } else {
+      result += c;
+    }
+  }
+  return result;
+}
+
+bool write_output(const std::string& aFileName, mica::AnalyserGroup& aAnalysers) {
+  if (aFileName.size() > 5 && aFileName.substr(aFileName.size() - 5) == ".root") {
+    return mica::ResultsFile::Write(aFileName, aAnalysers);
+  }
+  aAnalysers.MakePlots(aFileName);
+  return true;
+}
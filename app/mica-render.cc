@@ -0,0 +1,55 @@
+/** Render the results files written by mica and mica-batch (see mica::ResultsFile) to a pdf,
+ *  merging several files on the way.
+ */
+
+// std library headers
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ROOT headers
+#include "TH1.h"
+
+// MICA headers
+#include "mica/AnalyserGroup.hh"
+#include "mica/ResultsFile.hh"
+
+/** The render app function - read and merge the results files, plot, save to pdf */
+int main(int argc, char *argv[]) {
+  std::vector<std::string> infiles;
+  std::string outfile = "analysis.pdf";
+  std::string merged = "";
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-m" || arg == "--merged") && (i + 1) < argc) {
+      merged = argv[++i];
+    } else if (arg.size() > 4 && arg.substr(arg.size() - 4) == ".pdf") {
+      outfile = arg;
+    } else {
+      infiles.push_back(arg);
+    }
+  }
+
+  if (infiles.size() == 0) {
+    std::cerr << "Usage: mica-render [--merged merged.root] results.root [results2.root ...] "
+              << "[output.pdf]\n";
+    return -1;
+  }
+
+  TH1::AddDirectory(kFALSE);
+
+  mica::AnalyserGroup analysers;
+  bool success = mica::ResultsFile::Read(infiles, analysers);
+  if (analysers.size() == 0) return -1;
+  if (!success) std::cerr << "WARNING: Not all the results could be read and merged\n";
+
+  // Optionally keep the merged results, so they can be merged again without re-reading
+  if (merged != "" && !mica::ResultsFile::Write(merged, analysers)) success = false;
+
+  if (analysers.HasCuts()) analysers.PrintCutFlow(std::cout);
+
+  std::cout << "Output file " << outfile << std::endl;
+  analysers.MakePlots(outfile);
+
+  return success ? 0 : -1;
+}
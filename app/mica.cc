@@ -6,156 +6,242 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdlib>
 
 // ROOT headers
-#include "TStyle.h"
-#include "TFile.h"
-#include "TTree.h"
-#include "TVirtualPad.h"
-
-// MAUS headers
-#include "src/common_cpp/DataStructure/Spill.hh"
-#include "src/common_cpp/DataStructure/Data.hh"
-#include "src/common_cpp/DataStructure/ReconEvent.hh"
-#include "src/common_cpp/DataStructure/MCEvent.hh"
+#include "TH1.h"
 
 // MICA headers
 #include "mica/AnalyserBase.hh"
 #include "mica/AnalyserFactory.hh"
-#include "mica/AnalyserTrackerPRSeedResidual.hh"
-#include "mica/AnalyserTrackerPREfficiency.hh"
-
-/** Analyse one ROOT file, using a given set of MICE analysers */
-void analyse_file(TFile& aFile, std::vector<mica::AnalyserBase*>& analysers);
-
-/** Draw and save to pdf the data contained in a given set of MICA analysers */
-void make_plots(const std::string& ofname, std::vector<mica::AnalyserBase*>& analysers);
+#include "mica/AnalyserGroup.hh"
+#include "mica/CutFlow.hh"
+#include "mica/CutsTOFTime.hh"
+#include "mica/EventLoop.hh"
+#include "mica/Log.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/ResultsFile.hh"
+#include "mica/SelectionIndex.hh"
+#include "mica/SlimTree.hh"
+#include "mica/TimingStats.hh"
+
+/** Create the set of analysers used by the app, with any non-default options applied. Called once
+ *  for the main set, and again for each replica when running on more than one thread.
+ *  With aTOFCut every analyser subscribes to one group-level TOF1 to TOF2 time cut, evaluated
+ *  once per event.
+ */
+mica::AnalyserGroup create_analysers(bool aTOFCut);
+
+/** Append the input file names listed in a text file, one per line, to a vector */
+bool read_file_list(const std::string& aListName, std::vector<std::string>& aFileNames);
 
 /** The main MICA app function - prepare the input file, analyse, plot, save to pdf */
 int main(int argc, char *argv[]) {
-  // Instantiate the analysers required
-  std::vector<std::string> analyser_names {"AnalyserTrackerChannelHits",
-                                           "AnalyserTrackerSpacePoints",
-                                           "AnalyserTrackerPRSeedResidual",
-                                           "AnalyserTrackerPRSeedNPEResidual",
-                                           "AnalyserTrackerPRStats",
-                                           "AnalyserTrackerAngularMomentum",
-                                           "AnalyserTrackerMCPRResiduals",
-                                           "AnalyserTrackerPREfficiency",
-                                           "AnalyserTrackerKFStats",
-                                           "AnalyserTrackerKFMomentum",
-                                           "AnalyserTofTracker"};
-  std::vector<mica::AnalyserBase*> analysers
-      = mica::AnalyserFactory::CreateAnalysers(analyser_names);
-
-  // Customise a few specific analyser options
-  // Use a log scale for patrec seed residual plots
-  dynamic_cast<mica::AnalyserTrackerPRSeedResidual*>(analysers[2])->setLogScale(true);
-  // Don't restrict efficiency calc to ideal events (false = ideal events only, true = non-ideal ok)
-  dynamic_cast<mica::AnalyserTrackerPREfficiency*>(analysers[7])->SetAllowMultiHitStations(false);
-  // Only use the TOFs to define an expected good event, not tracker spacepoints
-  dynamic_cast<mica::AnalyserTrackerPREfficiency*>(analysers[7])->SetCheckTkU(false);
-  dynamic_cast<mica::AnalyserTrackerPREfficiency*>(analysers[7])->SetCheckTkD(false);
-
-  // Set up the input and output files using the programme arguments
-  std::string infile = "";
+  // Parse the programme arguments, options first, then the input file names (or patterns),
+  // then optionally the output pdf name
+  int nthreads = 1;
+  int prefetch = 0;
+  int split = -1;
+  std::string checkpoint = "";
+  double checkpoint_interval = 300.0;
+  Long64_t begin = 0;
+  Long64_t end = -1;
+  bool timing = false;
+  bool memory = false;
+  bool adaptive_cuts = false;
+  bool tof_cut = false;
+  std::string timing_json = "";
+  std::vector<std::string> infiles;
   std::string outfile = "analysis.pdf";
-  if (argc > 1) {
-    infile = std::string(argv[1]); // 1st arg to code should be input ROOT file name
-  } else {
-    std::cerr << "Please enter the input file name as the first argument and try again\n";
+  std::string histfile = "";
+  std::string selection_name = "";
+  std::string selection_out = "";
+  std::string selection_in = "";
+  std::string slim_out = "";
+  bool slim_in = false;
+  bool pdf_requested = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-t" || arg == "--threads") && (i + 1) < argc) {
+      nthreads = std::atoi(argv[++i]);
+    } else if ((arg == "-p" || arg == "--prefetch") && (i + 1) < argc) {
+      prefetch = std::atoi(argv[++i]);
+    } else if ((arg == "-s" || arg == "--split") && (i + 1) < argc) {
+      split = std::atoi(argv[++i]);
+    } else if ((arg == "-c" || arg == "--checkpoint") && (i + 1) < argc) {
+      checkpoint = argv[++i];
+    } else if (arg == "--checkpoint-interval" && (i + 1) < argc) {
+      checkpoint_interval = std::atof(argv[++i]);
+    } else if ((arg == "-b" || arg == "--begin") && (i + 1) < argc) {
+      begin = std::atoll(argv[++i]);
+    } else if ((arg == "-e" || arg == "--end") && (i + 1) < argc) {
+      end = std::atoll(argv[++i]);
+    } else if (arg == "--adaptive-cuts") {
+      adaptive_cuts = true;
+    } else if (arg == "--tof-cut") {
+      tof_cut = true;
+    } else if (arg == "--timing") {
+      timing = true;
+    } else if (arg == "--memory") {
+      memory = true;
+    } else if (arg == "--log-level" && (i + 1) < argc) {
+      if (!mica::Log::SetLevel(argv[++i])) {
+        std::cerr << "Unknown log level " << argv[i]
+                  << ", use trace, debug, info, warning or error\n";
+        return -1;
+      }
+    } else if (arg == "--timing-json" && (i + 1) < argc) {
+      timing = true;
+      timing_json = argv[++i];
+    } else if ((arg == "-l" || arg == "--list") && (i + 1) < argc) {
+      if (!read_file_list(argv[++i], infiles)) return -1;
+    } else if (arg == "--histograms" && (i + 1) < argc) {
+      histfile = argv[++i];
+    } else if (arg == "--write-selection" && (i + 2) < argc) {
+      selection_name = argv[++i];
+      selection_out = argv[++i];
+    } else if (arg == "--selection" && (i + 1) < argc) {
+      selection_in = argv[++i];
+    } else if (arg == "--write-slim" && (i + 1) < argc) {
+      slim_out = argv[++i];
+    } else if (arg == "--slim") {
+      slim_in = true;
+    } else if (arg.size() > 4 && arg.substr(arg.size() - 4) == ".pdf") {
+      outfile = arg;
+      pdf_requested = true;
+    } else {
+      infiles.push_back(arg);
+    }
+  }
+
+  // Check we have some input
+  if (infiles.size() == 0) {
+    std::cerr << "Usage: mica [--threads N] [--prefetch N] [--split N] [--begin N] [--end N] "
+              << "[--checkpoint file.root [--checkpoint-interval seconds]] "
+              << "[--timing] [--timing-json timing.json] [--memory] [--histograms results.root] "
+              << "[--tof-cut] [--adaptive-cuts] [--write-selection name index.txt] "
+              << "[--selection index.txt] [--write-slim slim.root] [--slim] [--log-level info] "
+              << "[--list files.txt] input.root [input2.root ...] [output.pdf]\n";
+    std::cerr << "Please enter the input file name(s) and try again\n";
     return -1;
   }
-  TFile f1(infile.c_str());
-  if (!f1.IsOpen()) {
-      std::cerr << "Failed to find file: " << infile <<std::endl;
-      return -1;
+  for (const auto& infile : infiles) {
+    std::cout << "Input file " << infile << std::endl;
   }
-  std::cout << "Input file " << infile << std::endl;
+  // With a histogram file the plots are only drawn if a pdf is also asked for
+  bool draw = (histfile == "" || pdf_requested);
+  if (draw) std::cout << "Output file " << outfile << std::endl;
+  if (histfile != "") std::cout << "Histogram file " << histfile << std::endl;
 
-  if (argc > 2) outfile = std::string(argv[2]);
-  std::cout << "Output file " << outfile << std::endl;
+  // Histograms are owned by the analysers, and names repeat between thread replicas, so keep
+  // them out of the ROOT directory structure
+  TH1::AddDirectory(kFALSE);
 
-  // Analyse the input ROOT file using the analysers
-  analyse_file(f1, analysers);
+  // Instantiate the analysers required
+  auto make_analysers = [tof_cut]() { return create_analysers(tof_cut); };
+  mica::AnalyserGroup analysers = make_analysers();
+
+  // Per-analyser timing is collected only on request, as it adds two clock reads per call
+  mica::TimingStats::SetEnabled(timing);
+  // Likewise the per-event allocation tracking, which adds a flag check to every allocation
+  mica::MemoryUsage::SetEnabled(memory);
+  mica::CutFlow::SetAdaptive(adaptive_cuts);
+
+  // Slim ntuples hold only a few tracker and TOF numbers per event, so are analysed serially
+  if (slim_in) {
+    if (!mica::SlimTreeReader::Run(infiles, analysers)) return -1;
+    if (analysers.HasCuts()) analysers.PrintCutFlow(std::cout);
+    if (memory) analysers.GetMemoryReport().Print(std::cout);
+    int status = 0;
+    if (histfile != "" && !mica::ResultsFile::Write(histfile, analysers)) status = -1;
+    if (draw) analysers.MakePlots(outfile);
+    return status;
+  }
 
-  // Plot the results contained in the analysers
-  make_plots(outfile, analysers);
+  // Analyse the input ROOT file using the analysers
+  mica::EventLoop loop(make_analysers);
+  loop.SetNThreads(nthreads);
+  loop.SetPrefetchDepth(prefetch);
+  loop.SetEntryRange(begin, end);
+  if (split >= 0) loop.SetEventsPerTask(split);
+  if (checkpoint != "") loop.SetCheckpoint(checkpoint, checkpoint_interval);
+
+  // Record the events passing a selection, and/or analyse only those listed by an earlier run
+  if (selection_out != "") {
+    mica::SelectionIndex::Selection selection =
+        mica::SelectionIndex::MakeSelection(selection_name, analysers);
+    if (!selection) {
+      std::cerr << "Unknown selection: " << selection_name << ", use CutsTOFTime or "
+                << "AnalyserTrackerPREfficiency" << std::endl;
+      return -1;
+    }
+    loop.SetSelection(selection_name, selection);
+  }
+  if (selection_in != "") {
+    std::shared_ptr<mica::SelectionIndex> index = std::make_shared<mica::SelectionIndex>();
+    if (!index->Read(selection_in)) return -1;
+    loop.SetSelectionInput(index);
+  }
+  std::shared_ptr<mica::SlimTreeWriter> slim;
+  if (slim_out != "") {
+    slim = std::make_shared<mica::SlimTreeWriter>();
+    if (!slim->Open(slim_out)) return -1;
+    loop.SetSlimOutput(slim);
+  }
+  if (nthreads > 1) std::cout << "Running on " << nthreads << " threads" << std::endl;
+  if (!loop.Run(infiles, analysers)) {
+    return -1;
+  }
 
-  // Wrap up
-  for (auto an : analysers) {
-    delete an;
+  if (selection_out != "" && !loop.GetSelected().Write(selection_out)) {
+    std::cerr << "Failed to write selection index: " << selection_out << std::endl;
+  }
+  if (slim && !slim->Close()) {
+    std::cerr << "Failed to write slim ntuple: " << slim_out << std::endl;
   }
-  return 0;
-}
 
-void analyse_file(TFile& aFile, std::vector<mica::AnalyserBase*>& analysers) {
-  // Set up access to ROOT data from input file
-  TTree* T = static_cast<TTree*>(aFile.Get("Spill"));
-  MAUS::Data* data = nullptr;  // Don't forget = nullptr or you get a seg fault
-  T->SetBranchAddress("data", &data); // Yes, this is the *address* of a *pointer*
-  int nentries = T->GetEntries();
-  std::cerr << "Found " << nentries << " spills\n";
-
-  // Loop over all spills
-  int spills_processed = 0;
-  int events_processed = 0;
-  for (int i = 0; i < nentries; ++i) {
-    ++spills_processed;
-    T->GetEntry(i);
-    if (!data) {
-      std::cout << "Data is NULL\n";
-      continue;
-    }
-    MAUS::Spill* spill = data->GetSpill();
-    if (spill == nullptr) {
-      std::cout << "Spill is NULL\n";
-      continue;
-    }
-    if (spill->GetDaqEventType() != "physics_event") {
-      // std::cout << "Spill is of type " << spill->GetDaqEventType() << ", not a usable spill\n";
-      continue;
-    }
+  if (analysers.HasCuts()) analysers.PrintCutFlow(std::cout);
 
-    // Call the analysers
-    int event_counter = 0;
-    for (auto revt : (*(spill->GetReconEvents()))) {
-      MAUS::MCEvent* mevt = nullptr;
-      if (event_counter < static_cast<int>(spill->GetMCEvents()->size()))
-        mevt = spill->GetMCEvents()->at(event_counter);
-      for (auto an : analysers) {
-        an->Analyse(revt, mevt);
-      }
-      ++event_counter;
-      ++events_processed;
+  // Report where the time went, slowest analysers first
+  if (timing) {
+    mica::TimingReport report = analysers.GetTimingReport();
+    report.AddStage("GetEntry", loop.GetReadTiming());
+    report.Print(std::cout);
+    if (timing_json != "" && !report.WriteJson(timing_json)) {
+      std::cerr << "Failed to write timing file: " << timing_json << std::endl;
     }
-    std::cout << "Spills processed: " << spills_processed << " of " << nentries
-              << ", events processed: " << events_processed << std::endl;
-  } // ~Loop over all spills
+  }
+
+  // Report the memory held by each analyser, for one replica and for all the worker threads
+  if (memory) analysers.GetMemoryReport().Print(std::cout, nthreads);
+
+  // Save the results for later merging and rendering (see mica-render), and/or plot them
+  int status = 0;
+  if (histfile != "" && !mica::ResultsFile::Write(histfile, analysers)) status = -1;
+  if (draw) analysers.MakePlots(outfile);
+
+  return status;
 }
 
-void make_plots(const std::string& ofname, std::vector<mica::AnalyserBase*>& analysers) {
-  std::vector<std::shared_ptr<TVirtualPad>> pads;
-  std::vector<std::shared_ptr<TStyle> > styles;
-  for (auto an : analysers) {
-    an->Draw();
-    for (auto pad : an->GetPads()) {
-      if (pad) {
-        pads.push_back(pad);
-        styles.push_back(an->GetStyle());
-      }
-    }
+mica::AnalyserGroup create_analysers(bool aTOFCut) {
+  mica::AnalyserGroup analysers = mica::AnalyserFactory::CreateDefaultAnalyserGroup();
+  if (aTOFCut) {
+    int cut = analysers.AddCut(new mica::CutsTOFTime());
+    for (size_t i = 0; i < analysers.size(); ++i) analysers.SubscribeCut(i, cut);
   }
-  std::cout << "Found " << pads.size() << " canvases, saving to pdf." << std::endl;
-  for (size_t i = 0; i < pads.size(); ++i) {
-    if (styles[i]) styles[i]->cd();
-    pads[i]->Update();
-    if (i == 0) {
-      pads[i]->SaveAs((ofname + "(").c_str(), "pdf");
-    } else if (i == (pads.size() - 1)) {
-      pads[i]->SaveAs((ofname + ")").c_str(), "pdf");
-    } else {
-      pads[i]->SaveAs(ofname.c_str(), "pdf");
-    }
+  return analysers;
+}
+
+bool read_file_list(const std::string& aListName, std::vector<std::string>& aFileNames) {
+  std::ifstream list(aListName);
+  if (!list) {
+    std::cerr << "Failed to open file list: " << aListName << std::endl;
+    return false;
+  }
+  std::string line;
+  while (std::getline(list, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    aFileNames.push_back(line);
   }
+  return true;
 }
@@ -5,15 +5,23 @@
 #ifndef ANALYSERBASE_HH
 #define ANALYSERBASE_HH
 
+#include <cstdint>
 #include <vector>
 #include <memory>
+#include <string>
 
+#include "TDirectory.h"
 #include "TVirtualPad.h"
 #include "TStyle.h"
 
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
+#include "mica/CutFlow.hh"
+#include "mica/CutRegistry.hh"
 #include "mica/CutsBase.hh"
+#include "mica/EventContext.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/TimingStats.hh"
 
 namespace mica {
 
@@ -21,9 +29,17 @@ namespace mica {
  *    Base class for all analysers. Defines a public interface via the Draw and Analyse
  *    functions. These wrap the private draw and analyse respetively which must be overidden
  *    in daughter classes (an example of the Non-Virtual Interface idiom).
- *    Analyse applies any cuts selected prior to passing events to daughter routines.
+ *    Analyse applies any cuts selected prior to passing events to daughter routines. These are
+ *    the analyser's own cuts plus any group-level cuts it subscribes to (see CutRegistry), which
+ *    are evaluated once per event however many analysers use them.
+ *    Events arrive wrapped in an EventContext holding the quantities several analysers need,
+ *    daughter classes override whichever of the two analyse methods suits them. The event loop
+ *    hands over whole spills through AnalyseSpill; daughter classes which can batch their work
+ *    across the events of a spill may also override analyse_spill.
  *    An optional Merge function is also provided. Daughter classes which wish to implement this
  *    should inherit from IAnalyser (a CRTP class), rather than AnalyserBase directly.
+ *    Daughter classes should also override data_requirements to declare which parts of the
+ *    spill they read, so that the event loop can skip reading the rest.
  *    All new daughter classes should be registered with AnalyserFactory::CreateAnalyser.
  *  @author A. Dobbs
  */
@@ -39,6 +55,20 @@ class AnalyserBase {
      */
     bool Analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent);
 
+    /** @brief Check the cuts, then if they are passed calls the daughter class analyse method
+     *  @param aContext The event, with the quantities shared between analysers
+     *  @return Boolean indicating if the cuts passed and the analysis happened
+     */
+    bool Analyse(const EventContext& aContext);
+
+    /** @brief Check the cuts for each event of a spill, then pass those which pass to the
+     *         daughter class analyse_spill method, or if it does not handle spills to the
+     *         analyse method one event at a time
+     *  @param aEvents The events of the spill (or part of it), in order
+     *  @return The number of events analysed
+     */
+    int AnalyseSpill(const std::vector<const EventContext*>& aEvents);
+
     /** @brief Create a new instance of the actual daughter class, returning a base pointer */
     // virtual AnalyserBase* Clone() = 0;
 
@@ -58,6 +88,26 @@ class AnalyserBase {
       */
     virtual bool Merge(AnalyserBase* aAnalyser) { return false; };
 
+    /** @brief Empty the accumulated results, timing and cut flow, keeping the histogram
+      *        binning and settings, so the analyser can be reused as a merge target
+      * @return Boolean, does the analyser support being reset
+      */
+    bool Reset();
+
+    /** @brief Save the accumulated results and settings of the analyser, and its cuts, to a
+     *         ROOT directory, so that an interrupted job can be resumed (see EventLoop)
+     *  @param aDir The directory to write to, normally one per analyser
+     *  @return Boolean indicating if the analyser and its cuts support saving
+     */
+    bool Save(TDirectory* aDir);
+
+    /** @brief Restore the state written by Save into this analyser, replacing its current
+     *         results. The analyser must be configured as the one which was saved.
+     *  @param aDir The directory to read from
+     *  @return Boolean indicating if the state was restored
+     */
+    bool Load(TDirectory* aDir);
+
     /** @brief Update the plots, with adding or altering the existing canvases */
     void Update() { update(); }
 
@@ -72,11 +122,41 @@ class AnalyserBase {
      */
     void AddCut(CutsBase* aCut) { mCuts.push_back(aCut); }
 
+    /** @brief Add a cut as AddCut, the analyser taking ownership of it
+     *  @param aCut The cut to add
+     */
+    void AdoptCut(CutsBase* aCut) {
+      mOwnedCuts.emplace_back(aCut);
+      AddCut(aCut);
+    }
+
     /** @brief Return the cuts enter for the analyser */
-    std::vector<CutsBase*> GetCuts() { return mCuts; }
+    const std::vector<CutsBase*>& GetCuts() const { return mCuts; }
 
     /** @brief Set the cuts, only events which pass all the cuts will be processed */
-    void SetCuts(std::vector<CutsBase*>& aCuts) { mCuts = aCuts; }
+    void SetCuts(const std::vector<CutsBase*>& aCuts) { mCuts = aCuts; }
+
+    /** @brief Return true if the analyser has cuts of its own or subscribes to group cuts */
+    bool HasCuts() const { return !mCuts.empty() || mCutMask != 0; }
+
+    /** @brief Set the group-level cut registry, done by AnalyserGroup::AddAnalyser */
+    void SetCutRegistry(std::shared_ptr<CutRegistry> aRegistry) { mCutRegistry = aRegistry; }
+
+    /** @brief Subscribe to a cut of the group-level registry, only events which pass it will be
+     *         processed
+     *  @param aIndex The index of the cut in the registry
+     */
+    void SubscribeCut(int aIndex) {
+      if (aIndex >= 0 && aIndex < CutRegistry::kMaxCuts) mCutMask |= (std::uint64_t(1) << aIndex);
+    }
+
+    /** @brief Return the group-level cuts subscribed to, one bit per registry index */
+    std::uint64_t GetCutMask() const { return mCutMask; }
+
+    /** @brief Return the parts of the spill read by the analyser and its cuts
+     *  @return Bitwise OR of DataRequirement flags
+     */
+    unsigned int GetDataRequirements() const;
 
     /** @brief Return a pointer to the ROOT TStyle used
       * to set the plotting style for this analyser
@@ -84,21 +164,85 @@ class AnalyserBase {
       */
     std::shared_ptr<TStyle> GetStyle() { return mStyle; }
 
+    /** @brief Return the analyser name, used when reporting (set by AnalyserFactory) */
+    std::string GetName() const { return mName; }
+
+    /** @brief Set the analyser name */
+    void SetName(const std::string& aName) { mName = aName; }
+
+    /** @brief Return the timing of the analyse calls, filled when TimingStats is enabled.
+     *         Passed counts the events for which analyse returned true.
+     */
+    const TimingStats& GetAnalyseTiming() const { return mAnalyseTiming; }
+
+    /** @brief Return the timing of the cuts, filled when TimingStats is enabled and the
+     *         analyser has cuts. Passed counts the events which passed all the cuts.
+     */
+    const TimingStats& GetCutTiming() const { return mCutTiming; }
+
+    /** @brief Return the bytes held by the analyser's histograms and containers (see
+     *         MemoryUsage), 0 if the daughter class does not report them
+     */
+    size_t GetMemoryUsage() const { return memory_usage(); }
+
+    /** @brief Return the largest heap growth seen during one analyse (or analyse_spill) call
+     *         (bytes), measured when MemoryUsage tracking is enabled
+     */
+    long GetPeakTransient() const { return mPeakTransient; }
+
+    /** @brief Return the cut-flow counters of the analyser's own cuts, by cut index */
+    const CutFlow& GetCutFlow() const { return mCutFlow; }
+
+    /** @brief Add the timing and cut-flow counters collected by another analyser (e.g. a
+     *         replica on another thread), and take the larger peak transient allocation
+     */
+    void MergeStats(const AnalyserBase& aAnalyser);
+
   private:
-    /** @brief Analyse the given event, to be overidden by concrete daughter classes
+    /** @brief Analyse the given event, to be overidden by concrete daughter classes which do
+     *         not override the EventContext version
      *  @param aReconEvent The recon event
      *  @param aMCEvent The corresponding MC event
      *  @return Boolean indicating if the cuts passed and the analysis happened
      */
-    virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) = 0;
+    virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) {
+      return false;
+    }
+
+    /** @brief Analyse the given event, using the quantities already worked out in the event
+     *         context. Defaults to the raw event version.
+     *  @param aContext The event, with the quantities shared between analysers
+     *  @return Boolean indicating if the analysis happened
+     */
+    virtual bool analyse(const EventContext& aContext) {
+      return analyse(aContext.GetReconEvent(), aContext.GetMCEvent());
+    }
+
+    /** @brief Analyse the events of a spill which passed the cuts all at once, to be overidden
+     *         by daughter classes which can batch their work. With timing enabled each event
+     *         is given an equal share of the time of the call.
+     *  @param aEvents The events, in order
+     *  @return The number of events analysed, or -1 (the default) if the daughter class does
+     *          not handle spills, in which case the events are passed to analyse one by one
+     */
+    virtual int analyse_spill(const std::vector<const EventContext*>& aEvents) { return -1; }
 
     /** @brief Apply the cuts held by the mCuts members to the event given as arguments, if they
      *         pass return true, otherwise false - no cuts just causes return true.
-     *  @param aReconEvent The recon event
-     *  @param aMCEvent The corresponding MC event
+     *  @param aContext The event
      *  @return Boolean indicating if the cuts passed
      */
-    bool ApplyCuts(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent);
+    bool ApplyCuts(const EventContext& aContext);
+
+    /** @brief Call analyse, recording the peak heap growth during the call if MemoryUsage
+     *         tracking is enabled
+     */
+    bool tracked_analyse(const EventContext& aContext);
+
+    /** @brief Call analyse_spill, recording the peak heap growth during the call as for
+     *         tracked_analyse
+     */
+    int tracked_analyse_spill(const std::vector<const EventContext*>& aEvents);
 
     /** @brief After analysing all the events, draw the results,
      *         to be overidden by concrete daughter classes
@@ -109,9 +253,41 @@ class AnalyserBase {
     /** @brief Update the plots, with adding or altering the existing canvases */
     virtual void update() {};
 
+    /** @brief Empty the accumulated results, to be overidden by daughter classes which
+     *         implement merge (usually by calling Reset on each histogram member)
+     */
+    virtual bool reset() { return false; }
+
+    /** @brief Save the analyser state to a directory, to be overidden by daughter classes which
+     *         support checkpointing (usually with the StateIO helpers)
+     */
+    virtual bool save(TDirectory* aDir) { return false; }
+
+    /** @brief Restore the analyser state written by save, to be overidden with save */
+    virtual bool load(TDirectory* aDir) { return false; }
+
+    /** @brief The parts of the spill read by the analyse method, as DataRequirement flags.
+     *         Defaults to everything, daughter classes should override with what they use.
+     */
+    virtual unsigned int data_requirements() const { return kAllData; }
+
+    /** @brief The bytes held by the histograms and containers of the analyser, to be overidden
+     *         by daughter classes (usually with the MemoryUsage helpers). Defaults to 0.
+     */
+    virtual size_t memory_usage() const { return 0; }
+
     std::vector<std::shared_ptr<TVirtualPad>> mPads; ///< The canvas upon which the plots are drawn
     std::vector<CutsBase*> mCuts; ///< The cuts to apply before admitting an event for analysis
+    std::vector<std::shared_ptr<CutsBase>> mOwnedCuts; ///< The cuts added with AdoptCut
+    std::shared_ptr<CutRegistry> mCutRegistry; ///< The group-level cuts
+    std::uint64_t mCutMask; ///< The group-level cuts subscribed to
     std::shared_ptr<TStyle> mStyle; ///< The ROOT TStyle to be applied to the canvases
+    std::string mName; ///< The analyser name, used when reporting
+    TimingStats mAnalyseTiming; ///< Timing of the analyse calls
+    TimingStats mCutTiming; ///< Timing of the cuts
+    long mPeakTransient; ///< Largest heap growth seen during one analyse call (bytes)
+    std::vector<const EventContext*> mSpillPassed; ///< The events of a spill passing the cuts
+    CutFlow mCutFlow; ///< Cut-flow counters and evaluation order of the analyser's own cuts
 };
 } // ~namespace mica
 
@@ -12,6 +12,7 @@
 
 #include "mica/AnalyserBase.hh"
 #include "mica/AnalyserGroup.hh"
+#include "mica/CutsBase.hh"
 
 namespace mica {
 
@@ -22,10 +23,21 @@ namespace mica {
  */
 class AnalyserFactory {
   public:
-    /** Create a new instance of the analyser type represented by the string arg */
+    /** Create a new instance of the analyser type represented by the string arg, named after it */
     static AnalyserBase* CreateAnalyser(const std::string& aName);
 
-    AnalyserGroup CreateAnalyserGroup(const std::vector<std::string>& aNames);
+    /** Create a group of analysers, with the specific types defined the vector of strings arg */
+    static AnalyserGroup CreateAnalyserGroup(const std::vector<std::string>& aNames);
+
+    /** Create the standard set of analysers run by the MICA apps, with their usual options and
+     *  any cuts shared between them (see AnalyserGroup::ShareCuts)
+     */
+    static AnalyserGroup CreateDefaultAnalyserGroup();
+
+    /** Create a new instance of the cut type named by the string arg (see CutsBase::GetName),
+     *  e.g. to restore saved cuts. Returns nullptr for an unknown name.
+     */
+    static CutsBase* CreateCut(const std::string& aName);
 
     /** Create a vector of analysers, with the specific types defined the vector of strings arg */
     static std::vector<AnalyserBase*> CreateAnalysers(const std::vector<std::string>& aNames);
@@ -43,6 +55,10 @@ class AnalyserFactory {
     /** Create a vector of analysers, with the specific types defined the vector of strings arg */
     static std::vector<std::unique_ptr<AnalyserBase>>
       CreateUniqueAnalysers(const std::vector<std::string>& aNames);
+
+  private:
+    /** The registry of analyser types, returns nullptr for an unknown name */
+    static AnalyserBase* create(const std::string& aName);
 };
 } // ~namespace mica
 
@@ -1,31 +1,75 @@
 #ifndef ANALYSERGROUP_HH
 #define ANALYSERGROUP_HH
 
+#include <ostream>
 #include <vector>
 #include <memory>
 
 #include "mica/AnalyserBase.hh"
+#include "mica/CutRegistry.hh"
 
 namespace mica {
 
 /** @class AnalyserGroup
  *         Store a group of MICA analysers in a vector, plus convenience functions.
+ *         The group takes ownership of the analysers added to it. Copies of a group share
+ *         the same analysers. Cuts used by several analysers should be registered with the
+ *         group, which then evaluates each at most once per event (see CutRegistry).
  *  @author A. Dobbs
  */
 class AnalyserGroup {
   public:
-    AnalyserGroup() {};
+    AnalyserGroup() : mCutRegistry{std::make_shared<CutRegistry>()} {};
     virtual ~AnalyserGroup() {}
 
     /** Return an analyser at a given position of the storage vector */
-    AnalyserBase* operator [](int i) const { return mAnalysers[i]; }
+    AnalyserBase* operator [](int i) const { return mAnalysers[i].get(); }
 
-    /** Add an analyser to the group */
-    void AddAnalyser(AnalyserBase* aAnalyser) { mAnalysers.push_back(aAnalyser); }
+    /** Add an analyser to the group, the group takes ownership of the memory */
+    void AddAnalyser(AnalyserBase* aAnalyser) {
+      aAnalyser->SetCutRegistry(mCutRegistry);
+      mAnalysers.emplace_back(aAnalyser);
+    }
+
+    /** Register a cut with the group, which takes ownership. Returns the cut index to subscribe
+     *  analysers to, or -1 if the group already has the maximum number of cuts.
+     */
+    int AddCut(CutsBase* aCut) { return mCutRegistry->AddCut(aCut); }
+
+    /** Subscribe the analyser at position aAnalyser to the group cut aCut */
+    void SubscribeCut(size_t aAnalyser, int aCut) { mAnalysers[aAnalyser]->SubscribeCut(aCut); }
+
+    /** Move the analysers' own cuts to the group registry, so that a cut shared by several
+     *  analysers, or equivalent cuts given to each, is evaluated once per event. Ownership of the
+     *  cuts is unchanged. AnalyserFactory::CreateDefaultAnalyserGroup calls this; other code
+     *  adding cuts to a group should call it once the group is configured, before Run or Load,
+     *  and build every replica of the group the same way.
+     */
+    void ShareCuts();
+
+    /** Return true if the group or any of its analysers has cuts */
+    bool HasCuts() const;
+
+    /** Print the cut-flow table of the group-level cuts and of each analyser's own cuts */
+    void PrintCutFlow(std::ostream& aOut) const;
+
+    /** Return the group-level cuts */
+    const CutRegistry& GetCutRegistry() const { return *mCutRegistry; }
+    CutRegistry& GetCutRegistry() { return *mCutRegistry; }
 
     /** Call Analyse on each analyser */
     bool Analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent);
 
+    /** Call Analyse on each analyser, sharing one event context between them */
+    bool Analyse(const EventContext& aContext);
+
+    /** Call AnalyseSpill on each analyser in turn with all the events of a spill (or part of
+     *  one), returning true if every analyser analysed every event. Events with MC are handed
+     *  over MCTruth::kPoolSize at a time, and their MC truths released after each batch, so a
+     *  thread never holds more truths than its pool recycles.
+     */
+    bool AnalyseSpill(const std::vector<const EventContext*>& aEvents);
+
     // AnalyserGroup* Clone();
 
     /** Call Draw on each analyser */
@@ -34,13 +78,36 @@ class AnalyserGroup {
     /** Draw and save the plots to a pdf, ofname specifies the output pdf file name */
     void MakePlots(const std::string& ofname);
 
-    /** Merge the data from another set of identical analysers into this AnalyserGroup */
+    /** Save the state of each analyser to its own sub-directory of aDir */
+    bool Save(TDirectory* aDir);
+
+    /** Restore the state of each analyser from a directory written by Save */
+    bool Load(TDirectory* aDir);
+
+    /** Return the parts of the spill read by any analyser in the group (DataRequirement flags) */
+    unsigned int GetDataRequirements() const;
+
+    /** Return the timing of each analyser (see TimingStats), to which stages can be added */
+    TimingReport GetTimingReport() const;
+
+    /** Return the memory held by each analyser, and its peak allocation per event */
+    MemoryReport GetMemoryReport() const;
+
+    /** Merge the data, timing and cut flow of another set of identical analysers into this group */
     bool Merge(AnalyserGroup* aAnalyserGroup);
 
-    size_t size() { return mAnalysers.size(); }
+    /** Empty the data, timing and cut flow of every analyser, so the group can be reused as
+     *  a merge target. Returns false if any analyser does not support being reset. */
+    bool Reset();
+
+    size_t size() const { return mAnalysers.size(); }
 
   private:
-    std::vector<AnalyserBase*> mAnalysers;
+    /** Call AnalyseSpill on each analyser in turn with a batch of events */
+    bool analyse_batch(const std::vector<const EventContext*>& aEvents);
+
+    std::vector<std::shared_ptr<AnalyserBase>> mAnalysers;
+    std::shared_ptr<CutRegistry> mCutRegistry; ///< The cuts shared between the analysers
 };
 } // ~namespace mice
 
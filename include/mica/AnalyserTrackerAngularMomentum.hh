@@ -45,6 +45,13 @@ class AnalyserTrackerAngularMomentum : public IAnalyser<AnalyserTrackerAngularMo
                          MAUS::MCEvent* const aMCEvent) override;
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override;
     virtual void merge(AnalyserTrackerAngularMomentum* aAnalyser) override;
+    virtual bool reset() override;
+    virtual size_t memory_usage() const override;
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
+    virtual unsigned int data_requirements() const override {
+      return kSciFiTracks | kSciFiSeeds | kSciFiPRTracks;
+    }
 
     int mAnalysisStation; ///< The tracker station to calculate all values at (default 1)
     int mAnalysisPlane; ///< The tracker plane to calculate all values at (default 0)
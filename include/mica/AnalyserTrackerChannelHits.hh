@@ -12,7 +12,8 @@
 #include "TH1.h"
 #include "TH2D.h"
 
-#include "mica/AnalyserBase.hh"
+#include "mica/HistogramBank.hh"
+#include "mica/IAnalyser.hh"
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
 
@@ -22,7 +23,7 @@ namespace mica {
  *         Anayser class which produces histos of tracker channel occupancy
  *  @author A. Dobbs
  */
-class AnalyserTrackerChannelHits : public AnalyserBase {
+class AnalyserTrackerChannelHits : public IAnalyser<AnalyserTrackerChannelHits> {
   public:
     AnalyserTrackerChannelHits();
     virtual ~AnalyserTrackerChannelHits() {}
@@ -30,11 +31,17 @@ class AnalyserTrackerChannelHits : public AnalyserBase {
   private:
     virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) override;
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override;
+    virtual void merge(AnalyserTrackerChannelHits* aAnalyser) override;
+    virtual bool reset() override;
+    virtual size_t memory_usage() const override;
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
 
-    std::vector<std::unique_ptr<TH1I> > mTkU; ///< Plots for TkU, order by station then by plane
-    std::vector<std::unique_ptr<TH1I> > mTkD; ///< Plots for TkD, order by station then by plane
-    std::vector<std::unique_ptr<TH2D> > mNPETkU; ///< Plots for TkU, order by station then by plane
-    std::vector<std::unique_ptr<TH2D> > mNPETkD; ///< Plots for TkD, order by station then by plane
+    virtual unsigned int data_requirements() const override { return kSciFiDigits; }
+
+    HistogramBank<Int_t, TH1I> mOccupancy; ///< Channel occupancy per tracker, station and plane
+    HistogramBank<Int_t, TH2D> mNPE; ///< NPE vs channel per tracker, station and plane
+    std::vector<std::unique_ptr<TH1> > mDrawn; ///< The ROOT histograms made for drawing
 };
 } // ~namespace mica
 
@@ -11,7 +11,7 @@
 #include "TVirtualPad.h"
 #include "TH2.h"
 
-#include "mica/AnalyserBase.hh"
+#include "mica/IAnalyser.hh"
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
 #include "src/common_cpp/DataStructure/SciFiSeed.hh"
@@ -23,7 +23,7 @@ namespace mica {
  *         Anayser class which produces plots of the kalman fit momentum
  *  @author A. Dobbs
  */
-class AnalyserTrackerKFMomentum : public AnalyserBase {
+class AnalyserTrackerKFMomentum : public IAnalyser<AnalyserTrackerKFMomentum> {
   public:
     AnalyserTrackerKFMomentum();
     virtual ~AnalyserTrackerKFMomentum() {}
@@ -41,16 +41,24 @@ class AnalyserTrackerKFMomentum : public AnalyserBase {
     void SetAnalysisPlane(int aAnalysisPlane) { mAnalysisPlane = aAnalysisPlane; }
 
   private:
-    virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) override;
+    virtual bool analyse(const EventContext& aContext) override;
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override;
+    virtual void merge(AnalyserTrackerKFMomentum* aAnalyser) override;
+    virtual bool reset() override;
+    virtual size_t memory_usage() const override;
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
+    virtual unsigned int data_requirements() const override { return kSciFiTracks; }
     virtual void update() override;
 
     /** @brief Extract the momentum at the specified surface
+     *  @param[in] aContext The event context, which holds the trackpoint lookup
      *  @param[in] trk The SciFiTrack
      *  @param[out] mom The momentum
      *  @return Bool representing success of fail
      */
-    bool GetMomentum(const MAUS::SciFiTrack* const trk, MAUS::ThreeVector& mom);
+    bool GetMomentum(const EventContext& aContext, const MAUS::SciFiTrack* const trk,
+                     MAUS::ThreeVector& mom);
 
     int mAnalysisStation; ///< The tracker station to calculate all values at (default 1)
     int mAnalysisPlane; ///< The tracker plane to calculate all values at (default 0)
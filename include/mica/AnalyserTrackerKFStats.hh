@@ -12,7 +12,7 @@
 
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
-#include "mica/AnalyserBase.hh"
+#include "mica/IAnalyser.hh"
 
 namespace mica {
 
@@ -20,7 +20,7 @@ namespace mica {
  *    Calculate the chisq per dof and p-value for kalman fit tracks and plot them
  *  @author A. Dobbs
  */
-class AnalyserTrackerKFStats : public AnalyserBase {
+class AnalyserTrackerKFStats : public IAnalyser<AnalyserTrackerKFStats> {
   public:
     AnalyserTrackerKFStats();
     ~AnalyserTrackerKFStats() {}
@@ -28,6 +28,12 @@ class AnalyserTrackerKFStats : public AnalyserBase {
   private:
     virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent);
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad);
+    virtual void merge(AnalyserTrackerKFStats* aAnalyser) override;
+    virtual bool reset() override;
+    virtual size_t memory_usage() const override;
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
+    virtual unsigned int data_requirements() const override { return kSciFiTracks; }
 
     TH1D* mHChiSqTKU; ///< mHChiSqTKU Histogram for TkU circle chisq per dof
     TH1D* mHChiSqTKD; ///< mHCircleChiSqTKD Histogram for TkD circle chisq per dof
@@ -14,55 +14,50 @@
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
 #include "mica/AnalyserBase.hh"
+#include "mica/EventContext.hh"
+#include "mica/MCTruth.hh"
 #include "src/common_cpp/Recon/SciFi/SciFiLookup.hh"
 
 namespace mica {
 
-/** @struct MCTrackData
- *          Simple data container to hold tracker track info deduced from MC
- *  @author A. Dobbs
- */
-struct MCTrackData {
-  int tracker; ///< The tracker number, 0 = TkU, 1 = TkD
-  int track_id; ///< The track id number
-  int pid; ///< The PGD particle id
-  double energy; ///< The track energy at the analysis plane
-  MAUS::ThreeVector pos; ///< The track position at the analysis plane
-  MAUS::ThreeVector mom; ///< The track momentum at the analysis plane
-  std::vector<int> stations_hit; ///< The tracker stations the track created hits in
-};
-
 /** @class AnalyserTrackerMC
  *         Analyser class which calculates tracker data using MC info.
- *         Daughter classes then use that data for actual analysis. The data produced is held in
- *         MCTrackData members for TkU and TkD separately.
+ *         Daughter classes then use that data for actual analysis. The data, a lookup table
+ *         and MCTrackData for TkU and TkD separately, is the MCTruth of the event, built once by
+ *         the EventContext and shared by all the MC analysers, and only available within
+ *         analyse_recon.
  *  @author A. Dobbs
  */
 class AnalyserTrackerMC : public AnalyserBase {
   public:
     AnalyserTrackerMC();
-    ~AnalyserTrackerMC();
+    ~AnalyserTrackerMC() {}
 
-    /** @brief Delete the lookup table and set the member pointer to nullptr */
-    virtual void clear_lookup();
+    /** @brief Return the MC truth of the event being analysed, nullptr outside analyse_recon */
+    const MCTruth* GetMCTruth() const { return mTruth; }
 
-    /** @brief Cycle through data vectors, delete every object, set vectors to zero size */
-    virtual void clear_mc_data();
+    /** @brief Return the scifi MC lookup table of the event being analysed */
+    MAUS::SciFiLookup* GetLookup() const { return mTruth ? mTruth->GetLookup() : nullptr; }
 
-    /** @brief Return the scifi MC lookup table */
-    MAUS::SciFiLookup* GetLookup() const { return mLookup; }
-
-    /** @brief Return the calculated mc data for TkU */
-    std::vector<MCTrackData*> GetMCDataTkU() const { return mMCDataTkU; }
+    /** @brief Return the calculated mc data for TkU of the event being analysed, owned by its
+     *         MC truth
+     */
+    const std::vector<const MCTrackData*>& GetMCDataTkU() const {
+      return mTruth ? mTruth->GetMCDataTkU() : kNoMCData;
+    }
 
-    /** @brief Return the calculated mc data for TkD */
-    std::vector<MCTrackData*> GetMCDataTkD() const { return mMCDataTkD; }
+    /** @brief Return the calculated mc data for TkD of the event being analysed, owned by its
+     *         MC truth
+     */
+    const std::vector<const MCTrackData*>& GetMCDataTkD() const {
+      return mTruth ? mTruth->GetMCDataTkD() : kNoMCData;
+    }
 
     /** Create a map from mc track ids to vectors containing the station numbers for which
      *  that track generated hits in mNPlanes or more planes (usually = 3) i.e. a spacepoint
      *  from the track is expected in each of the stations listed in the vector.
      *  To be used with one tracker at a time.
-     *  @param[in] hit_map A map from mc track ids to the the SciFiHits produced by that tracker
+     *  @param[in] hit_map A map from station numbers to the SciFiHits in that station,
      *             for a single tracker.
      *  @param[in] aNPlanes The number planes per station which need to be hit for the station
      *             to count as one hit by the track
@@ -70,16 +65,17 @@ class AnalyserTrackerMC : public AnalyserBase {
      *          that track generated hits in mNPlanes or more planes, for a single tracker
      */
     std::map<int, std::vector<int> > calc_stations_hit_by_track( \
-        std::map<int, std::vector<MAUS::SciFiHit*> >& hit_map, int aNPlanes);
+        std::map<int, std::vector<MAUS::SciFiHit*> >& hit_map, int aNPlanes) {
+      return MCTruth::calc_stations_hit_by_track(hit_map, aNPlanes);
+    }
 
   private:
-    virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) override;
+    static const std::vector<const MCTrackData*> kNoMCData; ///< Returned outside analyse_recon
 
-    /** @brief Analyse MC data, calls fill_mc_track_data and make_lookup
-     *  @param[in] aMCEvent MCEvent to analyse
-     *  @return Did the analysis succeed
+    /** @brief Fetch the MC truth of the event from the context, then call analyse_recon if it
+     *         is valid
      */
-    virtual bool analyse_mc(MAUS::MCEvent* const aMCEvent);
+    virtual bool analyse(const EventContext& aContext) override;
 
     /** @brief Analyse the recon data, to be implemented in daughter classes
      *  @param[in] aReconEvent MAUS::ReconEvent to analyse, corresponding to aMCEvent
@@ -87,25 +83,16 @@ class AnalyserTrackerMC : public AnalyserBase {
      */
     virtual bool analyse_recon(MAUS::ReconEvent* const aReconEvent) = 0;
 
+    /** @brief The MC data the truth is built from. Daughter classes overriding this should add the
+     *         recon data they use to kMCSciFiHits.
+     */
+    virtual unsigned int data_requirements() const override { return kMCSciFiHits; }
+
     int mRefStation; ///< Reference surface to use
     int mRefPlane;   ///< Reference plane to use
     int mNStations;  ///< # of stations hit for event to be classed as reconstructible
     int mNPlanes;    ///< # of planes hit per station hit for event to be classed as reconstructible
-    std::vector<MCTrackData*> mMCDataTkU; ///< MC data for TkU, AnalyserTrackerMC owns the memory
-    std::vector<MCTrackData*> mMCDataTkD; ///< MC data for TkD, AnalyserTrackerMC owns the memory
-    MAUS::SciFiLookup* mLookup;           ///< The Lookup table, AnalyserTrackerMC owns the memory
-
-    /** @brief Populate the mMCData members
-     *  @param[in] aMCEvent MAUS::MCEvent to analyse
-     *  @return Did the data members get populated successfully
-     */
-    bool fill_mc_track_data(MAUS::MCEvent* const aMCEvent);
-
-    /** @brief Populate the lookup table member
-     *  @param[in] aMCEvent MCEvent to analyse
-     *  @return Was the lookup successfully created
-     */
-    bool make_lookup(MAUS::MCEvent* const aMCEvent);
+    const MCTruth* mTruth; ///< The MC truth of the event being analysed, owned by its context
 };
 } // ~namespace mica
 
@@ -32,6 +32,16 @@ class AnalyserTrackerMCPRResiduals : public IAnalyser<AnalyserTrackerMCPRResidua
                          MAUS::MCEvent* const aMCEvent) override;
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override;
     virtual void merge(AnalyserTrackerMCPRResiduals* aAnalyser) override;
+    virtual bool reset() override;
+    virtual size_t memory_usage() const override;
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
+
+    /** @brief Return all the histograms, for saving and loading */
+    std::vector<TH1*> histograms() const;
+    virtual unsigned int data_requirements() const override {
+      return kSciFiPRTracks | kSciFiSpacePoints | kMCSciFiHits;
+    }
 
     const double mBfield = 3.0;
 
@@ -11,6 +11,8 @@
 #include "TH1.h"
 
 #include "mica/AnalyserTrackerMC.hh"
+#include "mica/IAnalyser.hh"
+#include "mica/TrackHitMasks.hh"
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
 #include "src/common_cpp/DataStructure/SciFiSeed.hh"
@@ -23,7 +25,7 @@ namespace mica {
  *         Analyser class which calculates pattern recognition purity.
  *  @author A. Dobbs
  */
-class AnalyserTrackerMCPurity : public AnalyserTrackerMC {
+class AnalyserTrackerMCPurity : public IAnalyser<AnalyserTrackerMCPurity, AnalyserTrackerMC> {
   public:
     AnalyserTrackerMCPurity();
     virtual ~AnalyserTrackerMCPurity() {}
@@ -31,9 +33,25 @@ class AnalyserTrackerMCPurity : public AnalyserTrackerMC {
   private:
     virtual bool analyse_recon(MAUS::ReconEvent* const aReconEvent) override;
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override;
-
+    virtual void merge(AnalyserTrackerMCPurity* aAnalyser) override;
+    virtual bool reset() override;
+    virtual size_t memory_usage() const override;
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
+    virtual unsigned int data_requirements() const override {
+      return kSciFiPRTracks | kSciFiSpacePoints | kSciFiClusters | kSciFiDigits |
+             kMCSciFiHits;
+    }
+
+    /** @brief Find the MC track which made a recon track, from the digits of its seed
+     *         spacepoints through the digit index of the MC truth
+     *  @return The MC track id, or -1 if no digit had MC hits, -2 if no MC track left hits in
+     *          2 planes of 3 stations, and -3 if several did
+     */
     int find_mc_track_id(MAUS::SciFiBasePRTrack* trk);
+
     TH1I* mHTracksMatched;
+    TrackHitMasks mTrackPlanes; ///< Working space, the planes hit by each MC track of a track
 };
 } // ~namespace mica
 
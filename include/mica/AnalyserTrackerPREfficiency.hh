@@ -15,7 +15,7 @@
 #include "src/common_cpp/DataStructure/MCEvent.hh"
 #include "src/common_cpp/DataStructure/SciFiEvent.hh"
 #include "src/common_cpp/DataStructure/TOFEvent.hh"
-#include "mica/AnalyserBase.hh"
+#include "mica/IAnalyser.hh"
 
 namespace mica {
 
@@ -24,7 +24,7 @@ namespace mica {
  *         efficiency results, uses reconstrcuted data only (no MC)
  *  @author A. Dobbs
  */
-class AnalyserTrackerPREfficiency : public AnalyserBase {
+class AnalyserTrackerPREfficiency : public IAnalyser<AnalyserTrackerPREfficiency> {
   public:
     AnalyserTrackerPREfficiency();
     virtual ~AnalyserTrackerPREfficiency();
@@ -62,9 +62,22 @@ class AnalyserTrackerPREfficiency : public AnalyserBase {
     /** Set if we are checking TkD criteria at all */
     void SetCheckTkD(bool aBool) { mCheckTkD = aBool; }
 
+    /** @brief Does the event pass the good event criteria, for the TOFs and for either tracker,
+     *         with the current settings. Used to select events for later re-analysis (see
+     *         SelectionIndex). Only reads the settings, so may be called from several threads.
+     */
+    bool IsGoodEvent(const EventContext& aContext) const;
+
   private:
-    virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) override;
+    virtual bool analyse(const EventContext& aContext) override;
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override;
+    virtual void merge(AnalyserTrackerPREfficiency* aAnalyser) override;
+    virtual bool reset() override;
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
+    virtual unsigned int data_requirements() const override {
+      return kSciFiPRTracks | kSciFiSpacePoints | kTOFSpacePoints;
+    }
 
     bool mCheckTOF; ///< Should we check time-of-flight between TOF1 and TOF2. Requires 1 and only 1
                     ///< spacepoint in both TOF1 and TOF2, so if set to true it will override
@@ -98,17 +111,19 @@ class AnalyserTrackerPREfficiency : public AnalyserBase {
 
     /** @brief Check a tracker to see if a single track is expected. Set the input bools to
      *         say whether a 4pt track or a 5pt track are expected.
-     *  @param[in] evt SciFiEvent containing the spacepoints
+     *  @param[in] aContext The event context, holding the spacepoints by station
      *  @param[in] trker_num Which tracker to analyse
      *  @param[out] good4pt Do we expect a 4pt track to be reconstructed, but NOT a 5pt track
      *  @param[out] good5pt Do we expect a 5pt track to be reconstructed
      */
-    void check_good_tk_event(MAUS::SciFiEvent* evt, int trker_num, bool& good4pt, bool& good5pt);
+    void check_good_tk_event(const EventContext& aContext, int trker_num, bool& good4pt,
+                             bool& good5pt) const;
 
     /** @brief Check the TOFs to see if the event passes the choosen criteria for a good event
+     *  @param[in] aContext The event context, holding the TOF spacepoints and tof12
      *  @return Bool indicating if this is a good event
      */
-    bool check_good_tof_event(MAUS::TOFEvent* evt);
+    bool check_good_tof_event(const EventContext& aContext) const;
 };
 } // ~namespace mica
 
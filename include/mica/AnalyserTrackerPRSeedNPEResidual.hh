@@ -12,11 +12,11 @@
 
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
-#include "mica/AnalyserBase.hh"
+#include "mica/IAnalyser.hh"
 
 namespace mica {
 
-class AnalyserTrackerPRSeedNPEResidual : public AnalyserBase {
+class AnalyserTrackerPRSeedNPEResidual : public IAnalyser<AnalyserTrackerPRSeedNPEResidual> {
   public:
     AnalyserTrackerPRSeedNPEResidual();
     ~AnalyserTrackerPRSeedNPEResidual() {}
@@ -24,6 +24,17 @@ class AnalyserTrackerPRSeedNPEResidual : public AnalyserBase {
   private:
     virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) override;
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override;
+    virtual void merge(AnalyserTrackerPRSeedNPEResidual* aAnalyser) override;
+    virtual bool reset() override;
+    virtual size_t memory_usage() const override;
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
+
+    /** @brief Return all the histograms, for saving and loading */
+    std::vector<TH1*> histograms() const;
+    virtual unsigned int data_requirements() const override {
+      return kSciFiPRTracks | kSciFiSpacePoints;
+    }
 
     std::vector<TH2D*> mHResidualsTkU;
     std::vector<TH2D*> mHResidualsTkD;
@@ -12,7 +12,7 @@
 
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
-#include "mica/AnalyserBase.hh"
+#include "mica/IAnalyser.hh"
 
 namespace mica {
 
@@ -20,7 +20,7 @@ namespace mica {
  *    Calculate the chisq per dof for patrec tracks and plot them
  *  @author A. Dobbs
  */
-class AnalyserTrackerPRStats : public AnalyserBase {
+class AnalyserTrackerPRStats : public IAnalyser<AnalyserTrackerPRStats> {
   public:
     AnalyserTrackerPRStats();
     ~AnalyserTrackerPRStats() {}
@@ -28,6 +28,12 @@ class AnalyserTrackerPRStats : public AnalyserBase {
   private:
     virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) override;
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override;
+    virtual void merge(AnalyserTrackerPRStats* aAnalyser) override;
+    virtual bool reset() override;
+    virtual size_t memory_usage() const override;
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
+    virtual unsigned int data_requirements() const override { return kSciFiPRTracks; }
 
     TH1D* mHCircleChiSqTKU; ///< mHCircleChiSqTKU Histogram for TkU circle chisq per dof
     TH1D* mHCircleChiSqTKD; ///< mHCircleChiSqTKD Histogram for TkD circle chisq per dof
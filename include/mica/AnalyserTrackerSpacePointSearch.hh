@@ -12,11 +12,11 @@
 
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
-#include "mica/AnalyserBase.hh"
+#include "mica/IAnalyser.hh"
 
 namespace mica {
 
-class AnalyserTrackerSpacePointSearch : public AnalyserBase {
+class AnalyserTrackerSpacePointSearch : public IAnalyser<AnalyserTrackerSpacePointSearch> {
   public:
     AnalyserTrackerSpacePointSearch();
     ~AnalyserTrackerSpacePointSearch() {}
@@ -24,6 +24,14 @@ class AnalyserTrackerSpacePointSearch : public AnalyserBase {
   private:
     virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) override;
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override;
+    virtual void merge(AnalyserTrackerSpacePointSearch* aAnalyser) override;
+    virtual bool reset() override;
+    virtual size_t memory_usage() const override;
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
+    virtual unsigned int data_requirements() const override {
+      return kSciFiPRTracks | kSciFiSpacePoints;
+    }
 
     TH2D* mHSeeds;
     TH2D* mHAddOns;
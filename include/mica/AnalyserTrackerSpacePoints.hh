@@ -12,6 +12,8 @@
 
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
+#include "mica/BufferedFill.hh"
+#include "mica/HistogramBank.hh"
 #include "mica/IAnalyser.hh"
 
 namespace mica {
@@ -27,8 +29,25 @@ class AnalyserTrackerSpacePoints :  public IAnalyser<AnalyserTrackerSpacePoints>
 
   private:
     virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) override;
+    virtual int analyse_spill(const std::vector<const EventContext*>& aEvents) override;
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override;
     virtual void merge(AnalyserTrackerSpacePoints* aAnalyser) override;
+    virtual bool reset() override;
+    virtual size_t memory_usage() const override;
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
+
+    /** @brief Return the ROOT histograms (those not in a bank), for saving and loading */
+    std::vector<TH1*> histograms() const;
+
+    /** @brief Fill the plots with the spacepoints of one event */
+    void fill(const std::vector<MAUS::SciFiSpacePoint*>& aSpacePoints);
+
+    /** @brief Pass the buffered values on to the histograms, before they are used */
+    void flush_fills();
+    virtual unsigned int data_requirements() const override {
+      return kSciFiSpacePoints | kSciFiClusters;
+    }
 
     const int mNStations = 5; ///< The number of tracker stations
     std::unique_ptr<TH1D> mHNpeTKU; ///< Spacepoint NPE plot for TkU
@@ -37,12 +56,18 @@ class AnalyserTrackerSpacePoints :  public IAnalyser<AnalyserTrackerSpacePoints>
     std::unique_ptr<TH1D> mHStationNumTKD; ///< spacepoints per station plot for TkD
     std::unique_ptr<TH2D> mHXYTKU; ///< xy plot for TkU (over all stations)
     std::unique_ptr<TH2D> mHXYTKD; ///< xy plot for TkD (over all stations)
-    std::vector<std::unique_ptr<TH2D> > mXYPerStationTkU; ///< xy plots for TkU, order by station
-    std::vector<std::unique_ptr<TH2D> > mXYPerStationTkD; ///< xy plots for TkD, order by station
-    std::vector<std::unique_ptr<TH2D> > mXYPerStationTripletsTkU; ///< xy plots for TkU triplets
-    std::vector<std::unique_ptr<TH2D> > mXYPerStationTripletsTkD; ///< xy plots for TkD triplets
-    std::vector<std::unique_ptr<TH2D> > mXYPerStationDoubletsTkU; ///< xy plots for TkU triplets
-    std::vector<std::unique_ptr<TH2D> > mXYPerStationDoubletsTkD; ///< xy plots for TkD triplets
+    HistogramBank<Int_t, TH2D> mXYPerStation; ///< xy plots per tracker and station
+    HistogramBank<Int_t, TH2D> mXYPerStationTriplets; ///< xy plots of triplets per station
+    HistogramBank<Int_t, TH2D> mXYPerStationDoublets; ///< xy plots of doublets per station
+    std::vector<std::unique_ptr<TH1> > mDrawn; ///< The ROOT histograms made for drawing
+
+    // Buffered fills of the histograms above, named after them
+    BufferedFill mFillNpeTKU;
+    BufferedFill mFillNpeTKD;
+    BufferedFill mFillStationNumTKU;
+    BufferedFill mFillStationNumTKD;
+    BufferedFill2D mFillXYTKU;
+    BufferedFill2D mFillXYTKD;
 };
 } // ~namespace mica
 
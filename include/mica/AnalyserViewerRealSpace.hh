@@ -13,7 +13,7 @@
 #include "TF1.h"
 #include "TArc.h"
 
-#include "mica/AnalyserBase.hh"
+#include "mica/IAnalyser.hh"
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
 #include "src/common_cpp/DataStructure/SciFiHelicalPRTrack.hh"
@@ -24,14 +24,29 @@ namespace mica {
  *         Anayser class which produces event viewer plots of real space
  *  @author A. Dobbs
  */
-class AnalyserViewerRealSpace : public AnalyserBase {
+class AnalyserViewerRealSpace : public IAnalyser<AnalyserViewerRealSpace> {
   public:
     AnalyserViewerRealSpace();
     virtual ~AnalyserViewerRealSpace() {}
 
   private:
+    /** @brief Show the event, recording where it is in the input for merge */
+    virtual bool analyse(const EventContext& aContext) override;
     virtual bool analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) override;
     virtual bool draw(std::shared_ptr<TVirtualPad> aPad) override;
+    virtual void merge(AnalyserViewerRealSpace* aAnalyser) override;
+    virtual bool reset() override;
+    virtual size_t memory_usage() const override;
+
+    /** @brief The viewer holds only the current event, so only which event it is and how many
+     *         spacepoints and tracks it has are saved, for comparing results. Loading restores
+     *         which event it was, but not the event itself.
+     */
+    virtual bool save(TDirectory* aDir) override;
+    virtual bool load(TDirectory* aDir) override;
+    virtual unsigned int data_requirements() const override {
+      return kSciFiPRTracks | kSciFiSpacePoints;
+    }
     virtual void update() override;
 
     void clear_vectors();
@@ -49,6 +64,9 @@ class AnalyserViewerRealSpace : public AnalyserBase {
     const double mZMin = 0.0;
     const double mZMax = 1200.0;
 
+    Long64_t mSpillEntry; ///< The input entry of the spill of the event shown, -1 if not known
+    int mEvent; ///< The index in its spill of the event shown, -1 if not known
+
     std::vector<double> mXTkU;
     std::vector<double> mYTkU;
     std::vector<double> mZTkU;
@@ -0,0 +1,180 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef ATOMICHISTOGRAM_HH
+#define ATOMICHISTOGRAM_HH
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "Rtypes.h"
+#include "TH1.h"
+#include "TH2.h"
+
+#include "mica/FixedAxis.hh"
+
+namespace mica {
+
+/** @class AtomicHistogram1D
+ *         A fixed binning 1D histogram of unweighted counts which any number of threads may fill
+ *         at once without locking, each fill being one relaxed atomic increment. Lets threads
+ *         share one histogram where per-thread replicas of a large histogram would cost too much
+ *         memory. Converted to a ROOT histogram for drawing or saving, the statistics (mean,
+ *         RMS) then being worked out from the bin centres.
+ *  @author A. Dobbs
+ */
+class AtomicHistogram1D {
+  public:
+    AtomicHistogram1D(const std::string& aName, const std::string& aTitle, int aNBins, double aLow,
+                      double aUp) : mName{aName}, mTitle{aTitle}, mAxis{aNBins, aLow, aUp},
+                                    mBins{new std::atomic<Long64_t>[aNBins + 2]} {
+      Reset();
+    }
+
+    /** @brief Add one count to the bin holding aX, thread safe */
+    void Fill(double aX) { mBins[mAxis.FindBin(aX)].fetch_add(1, std::memory_order_relaxed); }
+
+    /** @brief Return the count in a bin, 0 being the underflow and n + 1 the overflow */
+    Long64_t GetBinContent(int aBin) const { return mBins[aBin].load(std::memory_order_relaxed); }
+
+    /** @brief Return the total number of fills, including the underflow and overflow */
+    Long64_t GetEntries() const {
+      Long64_t sum = 0;
+      for (int i = 0; i < GetNCells(); ++i) sum += GetBinContent(i);
+      return sum;
+    }
+
+    /** @brief Return the number of bins including the underflow and overflow */
+    int GetNCells() const { return mAxis.GetNBins() + 2; }
+
+    /** @brief Return the binning */
+    const FixedAxis& GetAxis() const { return mAxis; }
+
+    /** @brief Set every count to zero, not thread safe against concurrent fills */
+    void Reset() {
+      for (int i = 0; i < GetNCells(); ++i) mBins[i].store(0, std::memory_order_relaxed);
+    }
+
+    /** @brief Add the counts to a ROOT histogram of the same binning, its statistics are then
+     *         worked out again from the bin centres
+     */
+    void AddTo(TH1* aHist) const {
+      double entries = aHist->GetEntries() + GetEntries();
+      for (int i = 0; i < GetNCells(); ++i) {
+        Long64_t n = GetBinContent(i);
+        if (n != 0) aHist->SetBinContent(i, aHist->GetBinContent(i) + n);
+      }
+      aHist->ResetStats();
+      aHist->SetEntries(entries);
+    }
+
+    /** @brief Return a new ROOT histogram (e.g. TH1D or TH1I) holding the counts, owned by the
+     *         caller
+     */
+    template <class THist>
+    THist* Make() const {
+      THist* hist = new THist(mName.c_str(), mTitle.c_str(), mAxis.GetNBins(), mAxis.GetLow(),
+                              mAxis.GetUp());
+      for (int i = 0; i < GetNCells(); ++i) hist->SetBinContent(i, GetBinContent(i));
+      hist->ResetStats();
+      hist->SetEntries(GetEntries());
+      return hist;
+    }
+
+  private:
+    std::string mName; ///< The name given to the ROOT histogram
+    std::string mTitle; ///< The title given to the ROOT histogram
+    FixedAxis mAxis; ///< The binning
+    std::unique_ptr<std::atomic<Long64_t>[]> mBins; ///< The counts, including under/overflow
+};
+
+/** @class AtomicHistogram2D
+ *         The 2D version of AtomicHistogram1D, with cells numbered as a ROOT TH2.
+ *  @author A. Dobbs
+ */
+class AtomicHistogram2D {
+  public:
+    AtomicHistogram2D(const std::string& aName, const std::string& aTitle, int aNBinsX,
+                      double aLowX, double aUpX, int aNBinsY, double aLowY, double aUpY)
+        : mName{aName}, mTitle{aTitle}, mXAxis{aNBinsX, aLowX, aUpX},
+          mYAxis{aNBinsY, aLowY, aUpY},
+          mBins{new std::atomic<Long64_t>[(aNBinsX + 2) * (aNBinsY + 2)]} {
+      Reset();
+    }
+
+    /** @brief Add one count to the cell holding (aX, aY), thread safe */
+    void Fill(double aX, double aY) {
+      mBins[GetBin(mXAxis.FindBin(aX), mYAxis.FindBin(aY))].fetch_add(1,
+                                                                       std::memory_order_relaxed);
+    }
+
+    /** @brief Return the cell number of an x and y bin, as TH1::GetBin */
+    int GetBin(int aBinX, int aBinY) const { return aBinX + (mXAxis.GetNBins() + 2) * aBinY; }
+
+    /** @brief Return the count in a cell */
+    Long64_t GetBinContent(int aBin) const { return mBins[aBin].load(std::memory_order_relaxed); }
+
+    /** @brief Return the count in an x and y bin */
+    Long64_t GetBinContent(int aBinX, int aBinY) const {
+      return GetBinContent(GetBin(aBinX, aBinY));
+    }
+
+    /** @brief Return the total number of fills, including the underflows and overflows */
+    Long64_t GetEntries() const {
+      Long64_t sum = 0;
+      for (int i = 0; i < GetNCells(); ++i) sum += GetBinContent(i);
+      return sum;
+    }
+
+    /** @brief Return the number of cells including the underflows and overflows */
+    int GetNCells() const { return (mXAxis.GetNBins() + 2) * (mYAxis.GetNBins() + 2); }
+
+    /** @brief Return the x binning */
+    const FixedAxis& GetXAxis() const { return mXAxis; }
+
+    /** @brief Return the y binning */
+    const FixedAxis& GetYAxis() const { return mYAxis; }
+
+    /** @brief Set every count to zero, not thread safe against concurrent fills */
+    void Reset() {
+      for (int i = 0; i < GetNCells(); ++i) mBins[i].store(0, std::memory_order_relaxed);
+    }
+
+    /** @brief Add the counts to a ROOT histogram of the same binning, its statistics are then
+     *         worked out again from the bin centres
+     */
+    void AddTo(TH2* aHist) const {
+      double entries = aHist->GetEntries() + GetEntries();
+      for (int i = 0; i < GetNCells(); ++i) {
+        Long64_t n = GetBinContent(i);
+        if (n != 0) aHist->SetBinContent(i, aHist->GetBinContent(i) + n);
+      }
+      aHist->ResetStats();
+      aHist->SetEntries(entries);
+    }
+
+    /** @brief Return a new ROOT histogram (e.g. TH2D or TH2I) holding the counts, owned by the
+     *         caller
+     */
+    template <class THist>
+    THist* Make() const {
+      THist* hist = new THist(mName.c_str(), mTitle.c_str(), mXAxis.GetNBins(), mXAxis.GetLow(),
+                              mXAxis.GetUp(), mYAxis.GetNBins(), mYAxis.GetLow(), mYAxis.GetUp());
+      for (int i = 0; i < GetNCells(); ++i) hist->SetBinContent(i, GetBinContent(i));
+      hist->ResetStats();
+      hist->SetEntries(GetEntries());
+      return hist;
+    }
+
+  private:
+    std::string mName; ///< The name given to the ROOT histogram
+    std::string mTitle; ///< The title given to the ROOT histogram
+    FixedAxis mXAxis; ///< The x binning
+    FixedAxis mYAxis; ///< The y binning
+    std::unique_ptr<std::atomic<Long64_t>[]> mBins; ///< The counts, including under/overflows
+};
+} // ~namespace mica
+
+#endif
@@ -0,0 +1,112 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef BATCHRUNNER_HH
+#define BATCHRUNNER_HH
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "mica/AnalyserGroup.hh"
+#include "mica/EventLoop.hh"
+
+namespace mica {
+
+/** @class BatchRunner
+ *         Analyse many runs, each made up of one or more MAUS output files, in one process.
+ *         Every file is a separate job, and the jobs are shared out dynamically over a pool of
+ *         worker threads, largest file first, so that the workers finish together. Each job is
+ *         analysed by an EventLoop with a fresh analyser group made by the GroupMaker, which is
+ *         then merged into the results of its run. Once all the jobs are done the run results
+ *         are also merged into a combined result. The analysers must therefore implement Merge
+ *         (see IAnalyser) for runs of more than one file, and for the combined result.
+ *  @author A. Dobbs
+ */
+class BatchRunner {
+  public:
+    /** @brief Constructor
+     *  @param aMaker Function creating a new, identically configured analyser group
+     */
+    explicit BatchRunner(EventLoop::GroupMaker aMaker);
+
+    virtual ~BatchRunner() {}
+
+    /** @brief Return the number of worker threads */
+    int GetNWorkers() const { return mNWorkers; }
+
+    /** @brief Set the number of worker threads, each analysing one file at a time */
+    void SetNWorkers(int aNWorkers) { mNWorkers = aNWorkers; }
+
+    /** @brief Add files to a run, creating the run if the label is new
+     *  @param aLabel The run label, usually the run number
+     *  @param aFileNames The MAUS output files of (part of) the run
+     */
+    void AddRun(const std::string& aLabel, const std::vector<std::string>& aFileNames);
+
+    /** @brief Add the runs listed in a text file. Each line holds a run label followed by the
+     *         files of that run, separated by whitespace. Blank lines and lines starting with
+     *         '#' are ignored.
+     *  @return False if the file could not be read
+     */
+    bool ReadRunList(const std::string& aFileName);
+
+    /** @brief Analyse every file of every run
+     *  @return False if any file could not be analysed, the results of the others are kept
+     */
+    bool Run();
+
+    /** @brief Return the number of runs */
+    size_t GetNRuns() const { return mRuns.size(); }
+
+    /** @brief Return the label of a run */
+    const std::string& GetRunLabel(size_t i) const { return mRuns[i]->label; }
+
+    /** @brief Return the merged analysers of a run, valid after Run */
+    AnalyserGroup& GetRunResult(size_t i) { return mRuns[i]->analysers; }
+
+    /** @brief Return the analysers merged over all runs, valid after Run */
+    AnalyserGroup& GetCombinedResult() { return mCombined; }
+
+  private:
+    /** One run, its files and merged results */
+    struct BatchRun {
+      std::string label; ///< The run label
+      std::vector<std::string> files; ///< The MAUS output files of the run
+      AnalyserGroup analysers; ///< The merged results of the files analysed so far
+      int nmerged = 0; ///< The number of files merged into the results
+      std::mutex mutex; ///< Guards the results while workers merge into them
+    };
+
+    /** One file to analyse */
+    struct FileJob {
+      size_t run; ///< Index of the run the file belongs to
+      std::string file; ///< The file name
+      Long64_t size; ///< The file size (bytes), used to order the jobs
+    };
+
+    /** @brief Worker routine, analyse jobs until none are left */
+    void work();
+
+    /** @brief Analyse one file and merge the results into its run
+     *  @return False if the file could not be read
+     */
+    bool analyse_job(const FileJob& aJob);
+
+    EventLoop::GroupMaker mMaker; ///< Creates the analyser groups
+    int mNWorkers; ///< The number of worker threads
+    std::vector<std::unique_ptr<BatchRun>> mRuns; ///< The runs, in the order added
+    std::vector<FileJob> mJobs; ///< The files of all the runs, largest first
+    std::atomic<size_t> mNextJob; ///< The shared queue, index of the next job to take
+    std::atomic<int> mFailures; ///< The number of files which could not be analysed
+    AnalyserGroup mCombined; ///< The results merged over all runs
+    std::mutex mMakerMutex; ///< Serialises creating analysers, which copy the global gStyle
+};
+} // ~namespace mica
+
+#endif
@@ -0,0 +1,132 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef BOUNDEDQUEUE_HH
+#define BOUNDEDQUEUE_HH
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace mica {
+
+/** @struct QueueStats
+ *          Counters describing how often each side of a BoundedQueue had to wait for the other
+ *  @author A. Dobbs
+ */
+struct QueueStats {
+  long pushes = 0; ///< Number of items pushed onto the queue
+  long pops = 0; ///< Number of items taken from the queue
+  long producer_stalls = 0; ///< Number of pushes which had to wait for space
+  long consumer_stalls = 0; ///< Number of pops which had to wait for an item
+  double producer_wait = 0.0; ///< Total time the producer spent waiting for space (s)
+  double consumer_wait = 0.0; ///< Total time the consumer spent waiting for an item (s)
+
+  /** Add the counts from another queue, e.g. to sum over the workers of a job */
+  QueueStats& operator+=(const QueueStats& aOther) {
+    pushes += aOther.pushes;
+    pops += aOther.pops;
+    producer_stalls += aOther.producer_stalls;
+    consumer_stalls += aOther.consumer_stalls;
+    producer_wait += aOther.producer_wait;
+    consumer_wait += aOther.consumer_wait;
+    return *this;
+  }
+};
+
+/** @class BoundedQueue
+ *         Thread safe first-in first-out queue with a fixed capacity, connecting one producer
+ *         thread to one or more consumers. Push blocks while the queue is full and Pop blocks
+ *         while it is empty, until the queue is closed. Every wait is recorded in a QueueStats
+ *         so that the capacity can be tuned.
+ *  @tparam T The type of item held, must be movable
+ *  @author A. Dobbs
+ */
+template <typename T>
+class BoundedQueue {
+  public:
+    /** @brief Constructor
+     *  @param aCapacity The maximum number of items held at once (at least 1)
+     */
+    explicit BoundedQueue(size_t aCapacity) : mCapacity{aCapacity > 0 ? aCapacity : 1},
+                                              mClosed{false} {}
+
+    /** @brief Add an item to the back of the queue, waiting for space if the queue is full
+     *  @return False if the queue was closed, in which case the item is discarded
+     */
+    bool Push(T aItem) {
+      std::unique_lock<std::mutex> lock(mMutex);
+      if (!mClosed && mItems.size() >= mCapacity) {
+        ++mStats.producer_stalls;
+        auto start = std::chrono::steady_clock::now();
+        mNotFull.wait(lock, [this] { return mClosed || mItems.size() < mCapacity; });
+        mStats.producer_wait +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+      if (mClosed) return false;
+      mItems.push_back(std::move(aItem));
+      ++mStats.pushes;
+      lock.unlock();
+      mNotEmpty.notify_one();
+      return true;
+    }
+
+    /** @brief Take the item from the front of the queue, waiting for one if the queue is empty
+     *  @param[out] aItem The item taken
+     *  @return False if the queue is closed and empty, so no more items will arrive
+     */
+    bool Pop(T& aItem) {
+      std::unique_lock<std::mutex> lock(mMutex);
+      if (!mClosed && mItems.empty()) {
+        ++mStats.consumer_stalls;
+        auto start = std::chrono::steady_clock::now();
+        mNotEmpty.wait(lock, [this] { return mClosed || !mItems.empty(); });
+        mStats.consumer_wait +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      }
+      if (mItems.empty()) return false;
+      aItem = std::move(mItems.front());
+      mItems.pop_front();
+      ++mStats.pops;
+      lock.unlock();
+      mNotFull.notify_one();
+      return true;
+    }
+
+    /** @brief Close the queue, no more items may be pushed. Items already queued may still be
+     *         popped. Wakes up any waiting threads.
+     */
+    void Close() {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mClosed = true;
+      }
+      mNotEmpty.notify_all();
+      mNotFull.notify_all();
+    }
+
+    /** @brief Return the maximum number of items held at once */
+    size_t GetCapacity() const { return mCapacity; }
+
+    /** @brief Return a copy of the wait counters */
+    QueueStats GetStats() const {
+      std::lock_guard<std::mutex> lock(mMutex);
+      return mStats;
+    }
+
+  private:
+    std::deque<T> mItems; ///< The queued items
+    size_t mCapacity; ///< The maximum number of items held at once
+    bool mClosed; ///< Has the queue been closed
+    QueueStats mStats; ///< Wait counters for both sides of the queue
+    mutable std::mutex mMutex; ///< Guards all the members above
+    std::condition_variable mNotEmpty; ///< Signalled when an item is pushed or the queue closed
+    std::condition_variable mNotFull; ///< Signalled when an item is popped or the queue closed
+};
+} // ~namespace mica
+
+#endif
@@ -0,0 +1,117 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef BUFFEREDFILL_HH
+#define BUFFEREDFILL_HH
+
+#include <cstddef>
+#include <vector>
+
+#include "TH1.h"
+#include "TH2.h"
+
+namespace mica {
+
+/** @class BufferedFill
+ *         Fills a 1D ROOT histogram in blocks rather than one value at a time. Values are
+ *         collected in a contiguous array, and once kBlockSize have been collected (or on Flush)
+ *         the bin numbers of the whole block are worked out in one vectorisable loop, for
+ *         uniform binning, and the contents, errors, statistics and entries updated in the same
+ *         order as TH1::Fill would. The histogram ends up exactly as if filled directly,
+ *         including the underflow and overflow. Histograms with variable bins, extendable axes,
+ *         their own ROOT buffer or a display range set are filled value by value on Flush, as
+ *         are those whose sum of weights is zero with entries present (see buffered-fill-test).
+ *
+ *         The histogram only holds the buffered values after Flush, which analysers should call
+ *         before drawing, merging, saving or loading the histogram.
+ *  @author A. Dobbs
+ */
+class BufferedFill {
+  public:
+    static const size_t kBlockSize = 256; ///< The number of values collected before a flush
+
+    BufferedFill() : mHist{nullptr} {}
+
+    /** @brief Constructor
+     *  @param aHist The histogram to fill, not owned, which must outlive the buffer's use
+     */
+    explicit BufferedFill(TH1* aHist);
+
+    /** @brief Add a value, as TH1::Fill(x) */
+    void Fill(double aX) { Fill(aX, 1.0); }
+
+    /** @brief Add a weighted value, as TH1::Fill(x, w) */
+    void Fill(double aX, double aW) {
+      mX.push_back(aX);
+      mW.push_back(aW);
+      if (mX.size() == kBlockSize) Flush();
+    }
+
+    /** @brief Pass the collected values on to the histogram */
+    void Flush();
+
+    /** @brief Return the histogram filled */
+    TH1* GetHistogram() const { return mHist; }
+
+    /** @brief Return the bytes held by the buffers, not counting the histogram */
+    size_t GetMemoryUsage() const {
+      return (mX.capacity() + mW.capacity()) * sizeof(double) + mBins.capacity() * sizeof(int);
+    }
+
+  private:
+    TH1* mHist; ///< The histogram filled
+    std::vector<double> mX; ///< The collected values
+    std::vector<double> mW; ///< The collected weights
+    std::vector<int> mBins; ///< Scratch space for the bin numbers of a block
+};
+
+/** @class BufferedFill2D
+ *         The 2D version of BufferedFill, filling a TH2 exactly as TH2::Fill(x, y) would.
+ *  @author A. Dobbs
+ */
+class BufferedFill2D {
+  public:
+    static const size_t kBlockSize = 256; ///< The number of values collected before a flush
+
+    BufferedFill2D() : mHist{nullptr} {}
+
+    /** @brief Constructor
+     *  @param aHist The histogram to fill, not owned, which must outlive the buffer's use
+     */
+    explicit BufferedFill2D(TH2* aHist);
+
+    /** @brief Add a point, as TH2::Fill(x, y) */
+    void Fill(double aX, double aY) { Fill(aX, aY, 1.0); }
+
+    /** @brief Add a weighted point, as TH2::Fill(x, y, w) */
+    void Fill(double aX, double aY, double aW) {
+      mX.push_back(aX);
+      mY.push_back(aY);
+      mW.push_back(aW);
+      if (mX.size() == kBlockSize) Flush();
+    }
+
+    /** @brief Pass the collected points on to the histogram */
+    void Flush();
+
+    /** @brief Return the histogram filled */
+    TH2* GetHistogram() const { return mHist; }
+
+    /** @brief Return the bytes held by the buffers, not counting the histogram */
+    size_t GetMemoryUsage() const {
+      return (mX.capacity() + mY.capacity() + mW.capacity()) * sizeof(double) +
+             (mBinsX.capacity() + mBinsY.capacity()) * sizeof(int);
+    }
+
+  private:
+    TH2* mHist; ///< The histogram filled
+    std::vector<double> mX; ///< The collected x values
+    std::vector<double> mY; ///< The collected y values
+    std::vector<double> mW; ///< The collected weights
+    std::vector<int> mBinsX; ///< Scratch space for the x bin numbers of a block
+    std::vector<int> mBinsY; ///< Scratch space for the y bin numbers of a block
+};
+} // ~namespace mica
+
+#endif
@@ -0,0 +1,114 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef CUTFLOW_HH
+#define CUTFLOW_HH
+
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "TDirectory.h"
+
+namespace mica {
+
+/** Cut-flow counters for one cut */
+struct CutFlowEntry {
+  long seen = 0; ///< Number of events the cut was applied to
+  long passed = 0; ///< Number of those events which passed
+  double time = 0.0; ///< Time spent in the cut (s), only when timed (see CutFlow::IsTimed)
+  long timed = 0; ///< Number of the applications which were timed
+
+  /** @brief Return the cost of the cut per event rejected, used to order the cuts */
+  double GetRank() const;
+};
+
+/** @class CutFlow
+ *         Cut-flow accounting for a chain of cuts: the events seen and passed and the time spent
+ *         by each cut, indexed by the position the cut was added in. Also holds the order the
+ *         cuts are evaluated in, which is the order they were added unless adaptive ordering is
+ *         switched on. The chain is then re-sorted every kReorderInterval evaluations by the
+ *         measured cost per event divided by the fraction of events rejected, so cheap cuts
+ *         that reject most events run first. The counts of a cut are conditional on the events
+ *         reaching it, so the ordering is a heuristic, but a stable one.
+ *  @author A. Dobbs
+ */
+class CutFlow {
+  public:
+    static const long kReorderInterval = 1000; ///< Chain evaluations between re-sorts
+
+    CutFlow() : mNEvaluations{0} {}
+
+    /** @brief Set the number of cuts in the chain, new cuts go to the end of the order */
+    void Resize(size_t aNCuts);
+
+    /** @brief Return the number of cuts */
+    size_t size() const { return mEntries.size(); }
+
+    /** @brief Return the cut indices in the order they should be evaluated */
+    const std::vector<size_t>& GetOrder() const { return mOrder; }
+
+    /** @brief Return the counters of a cut */
+    const CutFlowEntry& GetEntry(size_t aCut) const { return mEntries[aCut]; }
+
+    /** @brief Should the cuts be timed (adaptive ordering or TimingStats is enabled) */
+    static bool IsTimed();
+
+    /** @brief Record one application of a cut
+     *  @param aCut The index of the cut
+     *  @param aPassed Did the event pass
+     *  @param aTime The time taken (s), ignored unless IsTimed
+     */
+    void Record(size_t aCut, bool aPassed, double aTime) {
+      CutFlowEntry& entry = mEntries[aCut];
+      ++entry.seen;
+      if (aPassed) ++entry.passed;
+      if (IsTimed()) {
+        entry.time += aTime;
+        ++entry.timed;
+      }
+    }
+
+    /** @brief Record the end of one evaluation of the chain, re-sorting the order if due */
+    void EndEvaluation();
+
+    /** @brief Add the counters of another chain of the same cuts */
+    CutFlow& operator+=(const CutFlow& aOther);
+
+    /** @brief Zero the counters, keeping the cuts and their evaluation order */
+    void Reset();
+
+    /** @brief Save the counters of one cut to a directory (usually that of the cut) */
+    bool Save(TDirectory* aDir, size_t aCut) const;
+
+    /** @brief Restore the counters of one cut written by Save, replacing the current ones */
+    bool Load(TDirectory* aDir, size_t aCut);
+
+    /** @brief Print a cut-flow table
+     *  @param aOut The stream to print to
+     *  @param aNames The name of each cut
+     *  @param aIndent Prefix for each line
+     */
+    void Print(std::ostream& aOut, const std::vector<std::string>& aNames,
+               const std::string& aIndent) const;
+
+    /** @brief Is adaptive ordering on */
+    static bool GetAdaptive() { return mAdaptive.load(std::memory_order_relaxed); }
+
+    /** @brief Switch adaptive ordering on or off for all cut chains */
+    static void SetAdaptive(bool aAdaptive) { mAdaptive = aAdaptive; }
+
+  private:
+    /** @brief Sort the order by rank, cheapest per rejected event first */
+    void reorder();
+
+    std::vector<CutFlowEntry> mEntries; ///< The counters, by cut index
+    std::vector<size_t> mOrder; ///< The evaluation order
+    long mNEvaluations; ///< Chain evaluations since the last re-sort
+    static std::atomic<bool> mAdaptive; ///< Global adaptive ordering switch
+};
+} // ~namespace mica
+
+#endif
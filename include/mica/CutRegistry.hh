@@ -0,0 +1,90 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef CUTREGISTRY_HH
+#define CUTREGISTRY_HH
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "TDirectory.h"
+
+#include "mica/CutFlow.hh"
+#include "mica/CutsBase.hh"
+#include "mica/EventContext.hh"
+
+namespace mica {
+
+/** @class CutRegistry
+ *         The cuts shared by the analysers of an AnalyserGroup. Each cut is registered once and
+ *         given a bit; analysers subscribe to the bits they need. A cut is evaluated at most
+ *         once per event, the first time a subscribed analyser asks for it, with the results
+ *         remembered in the EventContext (see EventContext::GetCutMemo), so the later analysers
+ *         only test bits. Evaluation is lazy: only the cuts asked for are run, stopping at the
+ *         first failure, in the order kept by the CutFlow (adaptive if switched on). A context
+ *         should only be used with one registry.
+ *  @author A. Dobbs
+ */
+class CutRegistry {
+  public:
+    static const int kMaxCuts = 64; ///< The number of bits in the cut masks
+
+    CutRegistry() {}
+    virtual ~CutRegistry() {}
+
+    /** @brief Register a cut, the registry takes ownership
+     *  @return The index of the cut's bit, or -1 if the registry is full
+     */
+    int AddCut(CutsBase* aCut);
+
+    /** @brief Register a cut owned elsewhere, returning the index of the cut already present
+     *         if it or an equivalent cut (see CutsBase::IsEquivalent) has been registered
+     *  @return The index of the cut's bit, or -1 if the registry is full
+     */
+    int ShareCut(CutsBase* aCut);
+
+    /** @brief Return a registered cut */
+    CutsBase* GetCut(int aIndex) const { return mCuts[aIndex]; }
+
+    /** @brief Return the number of registered cuts */
+    size_t size() const { return mCuts.size(); }
+
+    /** @brief Check whether an event passes all the cuts in a mask, evaluating those not
+     *         already evaluated for this event
+     *  @param aMask The cut bits to test
+     *  @param aContext The event, which holds the evaluated and passed bits
+     *  @return True if every cut in the mask passed
+     */
+    bool Passes(std::uint64_t aMask, const EventContext& aContext);
+
+    /** @brief Return the cut-flow counters of the registered cuts, by cut index */
+    const CutFlow& GetCutFlow() const { return mCutFlow; }
+
+    /** @brief Add the cut-flow counters of another registry of the same cuts */
+    void MergeCutFlow(const CutRegistry& aRegistry) { mCutFlow += aRegistry.mCutFlow; }
+
+    /** @brief Zero the cut-flow counters */
+    void ResetCutFlow() { mCutFlow.Reset(); }
+
+    /** @brief Return the parts of the spill read by the cuts in a mask (DataRequirement flags) */
+    unsigned int GetDataRequirements(std::uint64_t aMask) const;
+
+    /** @brief Save the settings of each cut to its own sub-directory of aDir */
+    bool Save(TDirectory* aDir) const;
+
+    /** @brief Restore the cut settings written by Save */
+    bool Load(TDirectory* aDir);
+
+  private:
+    CutRegistry(const CutRegistry&) = delete;
+    CutRegistry& operator=(const CutRegistry&) = delete;
+
+    std::vector<CutsBase*> mCuts; ///< The registered cuts, the index is the bit
+    std::vector<std::unique_ptr<CutsBase>> mOwnedCuts; ///< The cuts added with AddCut
+    CutFlow mCutFlow; ///< Cut-flow counters and evaluation order
+};
+} // ~namespace mica
+
+#endif
@@ -5,8 +5,14 @@
 #ifndef CUTSBASE_HH
 #define CUTSBASE_HH
 
+#include <string>
+
+#include "TDirectory.h"
+
 #include "src/common_cpp/DataStructure/ReconEvent.hh"
 #include "src/common_cpp/DataStructure/MCEvent.hh"
+#include "mica/DataRequirements.hh"
+#include "mica/EventContext.hh"
 
 namespace mica {
 
@@ -21,6 +27,34 @@ class CutsBase {
 
     /** @brief Apply the cut to the event, return true if passed, false if not */
     virtual bool Cut(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) = 0;
+
+    /** @brief Apply the cut to an event using the quantities already worked out in the event
+     *         context. This is what the analysers call. Defaults to the raw event version,
+     *         cuts should override it where the context holds what they need.
+     */
+    virtual bool Cut(const EventContext& aContext) {
+      return Cut(aContext.GetReconEvent(), aContext.GetMCEvent());
+    }
+
+    /** @brief Return the parts of the spill read by the cut, as DataRequirement flags. Defaults
+     *         to everything, cuts should override this to allow unused data to be skipped.
+     */
+    virtual unsigned int GetDataRequirements() const { return kAllData; }
+
+    /** @brief Return true if another cut always gives the same result as this one, so that
+     *         the two may be evaluated once for both (see CutRegistry::ShareCut). Defaults to
+     *         false, cuts should override it to compare their type and settings.
+     */
+    virtual bool IsEquivalent(const CutsBase& aCut) const { return false; }
+
+    /** @brief Return the name of the cut, used in the cut-flow table */
+    virtual std::string GetName() const { return "Cut"; }
+
+    /** @brief Save the cut settings to a ROOT directory (see StateIO), default is nothing to save */
+    virtual bool Save(TDirectory* aDir) const { return true; }
+
+    /** @brief Restore the cut settings saved by Save, default is nothing to restore */
+    virtual bool Load(TDirectory* aDir) { return true; }
 };
 } // ~namespace mica
 
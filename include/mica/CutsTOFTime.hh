@@ -18,6 +18,17 @@ class CutsTOFTime : public CutsBase {
 
     virtual bool Cut(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent);
 
+    virtual bool Cut(const EventContext& aContext);
+
+    virtual unsigned int GetDataRequirements() const { return kTOFSpacePoints; }
+
+    virtual std::string GetName() const { return "CutsTOFTime"; }
+
+    virtual bool IsEquivalent(const CutsBase& aCut) const;
+
+    virtual bool Save(TDirectory* aDir) const;
+    virtual bool Load(TDirectory* aDir);
+
   private:
     double mLowerTimeCut;
     double mUpperTimeCut;
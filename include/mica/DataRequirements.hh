@@ -0,0 +1,87 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef DATAREQUIREMENTS_HH
+#define DATAREQUIREMENTS_HH
+
+#include <string>
+#include <vector>
+
+#include "TTree.h"
+
+namespace mica {
+
+/** Bit flags naming the parts of a MAUS spill read by an analyser or cut. Analysers declare the
+ *  union of the flags they need (including any data reached through references, e.g. pattern
+ *  recognition tracks reach their spacepoints, and spacepoints their clusters), so that the event
+ *  loop may skip reading the rest of the spill.
+ */
+enum DataRequirement : unsigned int {
+  kNoData             = 0,
+  kSciFiDigits        = 1u << 0,  ///< Tracker digits
+  kSciFiClusters      = 1u << 1,  ///< Tracker clusters
+  kSciFiSpacePoints   = 1u << 2,  ///< Tracker spacepoints
+  kSciFiSeeds         = 1u << 3,  ///< Tracker Kalman fit seeds
+  kSciFiPRTracks      = 1u << 4,  ///< Tracker helical and straight pattern recognition tracks
+  kSciFiTracks        = 1u << 5,  ///< Tracker Kalman fit tracks (and their trackpoints)
+  kTOFDigits          = 1u << 6,  ///< TOF digits
+  kTOFSlabHits        = 1u << 7,  ///< TOF slab hits
+  kTOFSpacePoints     = 1u << 8,  ///< TOF spacepoints
+  kCkovData           = 1u << 9,  ///< Cherenkov recon data
+  kKLData             = 1u << 10, ///< KL recon data
+  kEMRData            = 1u << 11, ///< EMR recon and spill data
+  kGlobalData         = 1u << 12, ///< Global recon data
+  kTriggerData        = 1u << 13, ///< Trigger recon data
+  kDAQData            = 1u << 14, ///< Raw DAQ data and scalars
+  kMCPrimary          = 1u << 15, ///< MC primary particle
+  kMCTracks           = 1u << 16, ///< MC tracks
+  kMCSciFiHits        = 1u << 17, ///< MC tracker hits, including noise hits
+  kMCTOFHits          = 1u << 18, ///< MC TOF hits
+  kMCVirtualHits      = 1u << 19, ///< MC virtual plane hits
+  kMCOtherHits        = 1u << 20, ///< MC Cherenkov, KL and EMR hits
+
+  kSciFiData = kSciFiDigits | kSciFiClusters | kSciFiSpacePoints | kSciFiSeeds | kSciFiPRTracks |
+               kSciFiTracks,
+  kTOFData = kTOFDigits | kTOFSlabHits | kTOFSpacePoints,
+  kMCData = kMCPrimary | kMCTracks | kMCSciFiHits | kMCTOFHits | kMCVirtualHits | kMCOtherHits,
+  kAllData = 0xFFFFFFFFu
+};
+
+/** @class BranchSelector
+ *         Switches off the sub-branches of a MAUS Spill tree which hold data not named in a set
+ *         of DataRequirement flags, using TTree::SetBranchStatus. Branches are matched on the
+ *         MAUS data member names in the branch name, so the saving depends on the split level
+ *         the file was written with. Data members which are not split out are always read.
+ *  @author A. Dobbs
+ */
+class BranchSelector {
+  public:
+    /** @brief Disable the branches of a tree not needed for the given requirements. Should be
+     *         called before SetBranchAddress.
+     *  @param aTree The MAUS Spill tree
+     *  @param aRequirements Bitwise OR of DataRequirement flags
+     *  @return The number of branches disabled
+     */
+    static int Apply(TTree* aTree, unsigned int aRequirements);
+
+    /** @brief Return the names of the flags set in a requirement mask, separated by spaces */
+    static std::string Describe(unsigned int aRequirements);
+
+  private:
+    /** @brief Recursively disable a list of branches and their daughters where not required
+     *  @param aTree The tree owning the branches
+     *  @param aBranches The branches to check
+     *  @param aRequirements Bitwise OR of DataRequirement flags
+     *  @param aDisable Disable every branch regardless (set when a parent branch is not required)
+     *  @return The number of branches disabled
+     */
+    static int apply(TTree* aTree, TObjArray* aBranches, unsigned int aRequirements,
+                     bool aDisable);
+
+    /** @brief Return the flags needed to justify reading a branch, from its name */
+    static unsigned int branch_requirements(const std::string& aBranchName);
+};
+} // ~namespace mica
+
+#endif
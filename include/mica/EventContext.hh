@@ -0,0 +1,176 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef EVENTCONTEXT_HH
+#define EVENTCONTEXT_HH
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Rtypes.h"
+
+
+#include "src/common_cpp/DataStructure/ReconEvent.hh"
+#include "src/common_cpp/DataStructure/MCEvent.hh"
+#include "src/common_cpp/DataStructure/SciFiBasePRTrack.hh"
+#include "src/common_cpp/DataStructure/SciFiEvent.hh"
+#include "src/common_cpp/DataStructure/SciFiSpacePoint.hh"
+#include "src/common_cpp/DataStructure/SciFiTrack.hh"
+#include "src/common_cpp/DataStructure/SciFiTrackPoint.hh"
+#include "src/common_cpp/DataStructure/TOFEvent.hh"
+#include "src/common_cpp/DataStructure/TOFSpacePoint.hh"
+#include "mica/MCTruth.hh"
+
+namespace mica {
+
+/** @class EventContext
+ *         The per-event quantities used by several analysers and cuts, worked out once when the
+ *         event is handed to the analysers rather than by each one in turn. Holds the recon and
+ *         MC events, the TOF spacepoints and tof12, and the tracker spacepoints, pattern
+ *         recognition tracks and Kalman tracks sorted by tracker (and station), with a table
+ *         of the trackpoints of each track by station and plane. The context only refers to the
+ *         MAUS data, which must outlive it. Trackers are numbered 0 (TkU) and 1 (TkD),
+ *         stations 1 to 5 and planes 0 to 2, as in MAUS. The tracker MC truth is only built
+ *         when first asked for, being expensive, and then shared.
+ *  @author A. Dobbs
+ */
+class EventContext {
+  public:
+    static const int kNTrackers = 2; ///< The number of trackers
+    static const int kNStations = 5; ///< The number of stations per tracker
+    static const int kNPlanes = 3; ///< The number of planes per station
+
+    /** The group-level cuts evaluated for this event, and which of them passed (see CutRegistry) */
+    struct CutMemo {
+      std::uint64_t evaluated = 0; ///< Bit set for each cut evaluated
+      std::uint64_t passed = 0; ///< Bit set for each cut evaluated and passed
+    };
+
+    /** @brief Constructor, extracts everything from the events given
+     *  @param aReconEvent The recon event, may be nullptr
+     *  @param aMCEvent The corresponding MC event, may be nullptr
+     *  @param aSpillEntry The entry of the spill in the input, -1 if not known
+     *  @param aEvent The index of the event in its spill, -1 if not known
+     */
+    EventContext(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent,
+                 Long64_t aSpillEntry = -1, int aEvent = -1);
+
+    /** @brief Return the recon event */
+    MAUS::ReconEvent* GetReconEvent() const { return mReconEvent; }
+
+    /** @brief Return the MC event, nullptr for real data */
+    MAUS::MCEvent* GetMCEvent() const { return mMCEvent; }
+
+    /** @brief Return the entry of the spill in the input, -1 if not known */
+    Long64_t GetSpillEntry() const { return mSpillEntry; }
+
+    /** @brief Return the index of the event in its spill, -1 if not known */
+    int GetEvent() const { return mEvent; }
+
+    /** @brief Return the tracker event, nullptr if missing */
+    MAUS::SciFiEvent* GetSciFiEvent() const { return mSciFiEvent; }
+
+    /** @brief Return the TOF event, nullptr if missing */
+    MAUS::TOFEvent* GetTOFEvent() const { return mTOFEvent; }
+
+    /** @brief Return the spacepoints of a TOF station (0, 1 or 2), nullptr if missing */
+    std::vector<MAUS::TOFSpacePoint>* GetTOFSpacePoints(int aStation) const {
+      return mTOFSpacePoints[aStation];
+    }
+
+    /** @brief Is there exactly one spacepoint in each of TOF1 and TOF2, so tof12 is defined */
+    bool HasTOF12() const { return mHasTOF12; }
+
+    /** @brief Return the TOF2 minus TOF1 spacepoint time (ns), only valid if HasTOF12 */
+    double GetTOF12() const { return mTOF12; }
+
+    /** @brief Return all the Kalman tracks */
+    const std::vector<MAUS::SciFiTrack*>& GetTracks() const { return mTracks; }
+
+    /** @brief Return the Kalman tracks of one tracker */
+    const std::vector<MAUS::SciFiTrack*>& GetTracks(int aTracker) const {
+      return mTrackerTracks[aTracker];
+    }
+
+    /** @brief Return the pattern recognition tracks (helical then straight) of one tracker */
+    const std::vector<MAUS::SciFiBasePRTrack*>& GetPRTracks(int aTracker) const {
+      return mPRTracks[aTracker];
+    }
+
+    /** @brief Return all the tracker spacepoints */
+    const std::vector<MAUS::SciFiSpacePoint*>& GetSpacePoints() const { return mSpacePoints; }
+
+    /** @brief Return the spacepoints of one tracker station */
+    const std::vector<MAUS::SciFiSpacePoint*>& GetSpacePoints(int aTracker, int aStation) const {
+      return mStationSpacePoints[aTracker][aStation - 1];
+    }
+
+    /** @brief Return the trackpoint of a Kalman track on a given station and plane
+     *  @param aTrack A track from this event
+     *  @param aStation The tracker station (1 - 5)
+     *  @param aPlane The station plane (0 - 2)
+     *  @return The trackpoint, or nullptr if the track has none there (or is not in the event)
+     */
+    MAUS::SciFiTrackPoint* GetTrackPoint(const MAUS::SciFiTrack* aTrack, int aStation,
+                                         int aPlane) const;
+
+    /** @brief Return the memo of the group-level cuts evaluated so far for this event. It may be
+     *         updated through a const context, since it only caches results.
+     */
+    CutMemo& GetCutMemo() const { return mCutMemo; }
+
+    /** @brief Return the tracker MC truth of the event, built on the first request for the
+     *         given settings and shared by every later request for them. It may be built through a
+     *         const context, since it only depends on the MC event.
+     *  @param aSettings The reconstructibility settings
+     *  @return The truth, owned by the context, or nullptr for real data
+     */
+    const MCTruth* GetMCTruth(const MCTruth::Settings& aSettings = MCTruth::Settings()) const;
+
+    /** @brief Let go of the MC truths built so far, returning them to the pool of the calling
+     *         thread, once every analyser is done with the event. A later request builds the
+     *         truth again.
+     */
+    void ReleaseMCTruths() const {
+      mMCTruth.reset();
+      mOtherMCTruths.clear();
+    }
+
+  private:
+    /** Trackpoints of one track, indexed by (station - 1) * kNPlanes + plane */
+    typedef std::array<MAUS::SciFiTrackPoint*, kNStations * kNPlanes> TrackPointTable;
+
+    /** @brief Fill the TOF members */
+    void extract_tof();
+
+    /** @brief Fill the tracker members */
+    void extract_scifi();
+
+    MAUS::ReconEvent* mReconEvent; ///< The recon event
+    MAUS::MCEvent* mMCEvent; ///< The MC event
+    Long64_t mSpillEntry; ///< The entry of the spill in the input
+    int mEvent; ///< The index of the event in its spill
+    MAUS::SciFiEvent* mSciFiEvent; ///< The tracker event
+    MAUS::TOFEvent* mTOFEvent; ///< The TOF event
+    std::array<std::vector<MAUS::TOFSpacePoint>*, 3> mTOFSpacePoints; ///< Spacepoints by station
+    bool mHasTOF12; ///< Is tof12 defined
+    double mTOF12; ///< TOF2 - TOF1 spacepoint time (ns)
+    std::vector<MAUS::SciFiTrack*> mTracks; ///< All the Kalman tracks
+    std::array<std::vector<MAUS::SciFiTrack*>, kNTrackers> mTrackerTracks; ///< Tracks by tracker
+    std::vector<TrackPointTable> mTrackPoints; ///< Trackpoint table of each track in mTracks
+    std::array<std::vector<MAUS::SciFiBasePRTrack*>, kNTrackers> mPRTracks; ///< PR tracks
+    std::vector<MAUS::SciFiSpacePoint*> mSpacePoints; ///< All the tracker spacepoints
+    /** Tracker spacepoints by tracker and station */
+    std::array<std::array<std::vector<MAUS::SciFiSpacePoint*>, kNStations>, kNTrackers>
+        mStationSpacePoints;
+    mutable CutMemo mCutMemo; ///< The group-level cut results for this event
+    mutable MCTruth::Handle mMCTruth; ///< The tracker MC truth for the first settings asked for
+    /** The tracker MC truths for any other settings asked for, rarely used */
+    mutable std::vector<MCTruth::Handle> mOtherMCTruths;
+};
+} // ~namespace mica
+
+#endif
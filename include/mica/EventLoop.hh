@@ -0,0 +1,283 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef EVENTLOOP_HH
+#define EVENTLOOP_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "src/common_cpp/DataStructure/Data.hh"
+#include "src/common_cpp/DataStructure/Spill.hh"
+#include "mica/AnalyserGroup.hh"
+#include "mica/BoundedQueue.hh"
+#include "mica/SelectionIndex.hh"
+#include "mica/SlimTree.hh"
+#include "mica/SpillReader.hh"
+#include "mica/SpillScheduler.hh"
+#include "mica/TimingStats.hh"
+
+namespace mica {
+
+/** @class EventLoop
+ *         Loop over the spills in one or more MAUS output files, passing each recon event (and
+ *         corresponding MC event) to a group of analysers. Multiple files are chained together
+ *         and treated as one sequence of spills, of which a [begin, end) range of entries may be
+ *         selected, so that a large job can be split into equal sized shards.
+ *
+ *         The loop may be run on several threads. Each worker thread then owns its own replica
+ *         of the analyser group, created with the GroupMaker supplied to the constructor, and
+ *         reads spills one at a time from a shared queue of tree entries. The recon events of
+ *         each spill are split into tasks of a few events which are scheduled with a
+ *         SpillScheduler, so that a worker which runs out of input can steal part of a large
+ *         spill from a busy worker. When every spill has
+ *         been analysed the replicas are merged back into the group passed to Run, using
+ *         AnalyserGroup::Merge. Analysers should therefore implement Merge (see IAnalyser) if
+ *         they are to be used with more than one thread. ROOT histogram names are duplicated
+ *         between replicas, so callers should disable TH1::AddDirectory before creating them.
+ *
+ *         Reading may also be pipelined: with a non-zero prefetch depth each worker hands the
+ *         file reading to a SpillReader running on its own thread, which keeps up to that many
+ *         deserialised spills queued ahead of the analysis.
+ *
+ *         Long jobs may be checkpointed. The workers are then periodically paused once every
+ *         spill they have started is finished, and the summed state of the analysers (see
+ *         AnalyserBase::Save) is written to a file along with the entries done. If the file
+ *         exists when Run starts, the analysers are restored from it and only the remaining
+ *         entries are read.
+ *
+ *         The events passing a selection may be recorded in a SelectionIndex, and a later Run
+ *         given that index reads only the spills holding those events, and analyses only them.
+ *  @author A. Dobbs
+ */
+class EventLoop {
+  public:
+    /** Function returning a new analyser group, configured identically to the one passed to Run */
+    typedef std::function<AnalyserGroup()> GroupMaker;
+
+    /** Time accounting for one worker thread over a Run */
+    struct WorkerStats {
+      double busy = 0.0; ///< Time spent in the analysers (s)
+      double read = 0.0; ///< Time spent reading spills, or waiting for the prefetch reader (s)
+      double wall = 0.0; ///< Lifetime of the worker (s)
+      long events = 0; ///< Number of recon events analysed
+      long tasks = 0; ///< Number of tasks analysed
+      long stolen = 0; ///< Number of those tasks stolen from other workers
+      TimingStats get_entry; ///< Timing of the tree reads (when TimingStats is enabled)
+    };
+
+    EventLoop();
+
+    /** @brief Constructor
+     *  @param aMaker Function used to create the per-thread analyser replicas
+     */
+    explicit EventLoop(GroupMaker aMaker);
+
+    virtual ~EventLoop() {}
+
+    /** @brief Return the number of worker threads used by Run */
+    int GetNThreads() const { return mNThreads; }
+
+    /** @brief Set the number of worker threads used by Run (values < 2 give a serial loop) */
+    void SetNThreads(int aNThreads) { mNThreads = aNThreads; }
+
+    /** @brief Return the maximum number of recon events in one scheduled task */
+    int GetEventsPerTask() const { return mEventsPerTask; }
+
+    /** @brief Set the maximum number of recon events in one scheduled task, spills with more
+     *         events are split so they can be shared between workers. 0 never splits spills.
+     */
+    void SetEventsPerTask(int aNEvents) { mEventsPerTask = aNEvents; }
+
+    /** @brief Return the time accounting for each worker in the last Run */
+    const std::vector<WorkerStats>& GetWorkerStats() const { return mWorkerStats; }
+
+    /** @brief Return the timing of the tree GetEntry calls in the last Run, summed over workers
+     *         (filled when TimingStats is enabled). Passed counts the reads returning data.
+     */
+    TimingStats GetReadTiming() const;
+
+    /** @brief Return the number of spills each worker reads ahead, 0 means no background reader */
+    int GetPrefetchDepth() const { return mPrefetchDepth; }
+
+    /** @brief Set the number of spills each worker reads ahead on a background reader thread.
+     *         0 (the default) reads each spill inline in the worker.
+     */
+    void SetPrefetchDepth(int aDepth) { mPrefetchDepth = aDepth; }
+
+    /** @brief Return whether parts of the spill not used by the analysers are skipped */
+    bool GetSkipUnusedData() const { return mSkipUnusedData; }
+
+    /** @brief Set whether parts of the spill not used by the analysers are skipped (the default),
+     *         based on AnalyserGroup::GetDataRequirements
+     */
+    void SetSkipUnusedData(bool aSkip) { mSkipUnusedData = aSkip; }
+
+    /** @brief Enable checkpointing, resuming from the checkpoint file if it already exists
+     *  @param aFileName The checkpoint ROOT file, an empty name disables checkpointing
+     *  @param aInterval The time between checkpoints (s)
+     */
+    void SetCheckpoint(const std::string& aFileName, double aInterval = 300.0) {
+      mCheckpointFile = aFileName;
+      mCheckpointInterval = aInterval;
+    }
+
+    /** @brief Return the prefetch queue wait counters from the last Run, summed over workers */
+    QueueStats GetPrefetchStats() const { return mPrefetchStats; }
+
+    /** @brief Set the range of chain entries analysed by Run, [aBegin, aEnd). The range is
+     *         clamped to the entries available. A negative end means up to the last entry.
+     */
+    void SetEntryRange(Long64_t aBegin, Long64_t aEnd) { mFirstEntry = aBegin; mLastEntry = aEnd; }
+
+    /** @brief Record the events passing a selection during Run, see GetSelected. The selection
+     *         is called by every worker thread, so must not change any shared state.
+     *  @param aName The name of the selection, saved with the index
+     *  @param aSelection The selection, an empty function records nothing
+     */
+    void SetSelection(const std::string& aName, SelectionIndex::Selection aSelection) {
+      mSelectionName = aName;
+      mSelection = aSelection;
+    }
+
+    /** @brief Return the events which passed the selection in the last Run */
+    const SelectionIndex& GetSelected() const { return mSelected; }
+
+    /** @brief Only read the spills listed in a selection index, and analyse only the listed
+     *         events. The index must have been made on the same input. Null reads everything.
+     */
+    void SetSelectionInput(std::shared_ptr<const SelectionIndex> aIndex) {
+      mSelectionInput = aIndex;
+    }
+
+    /** @brief Also write a slim tracker ntuple row (see SlimEvent) for every event analysed.
+     *         The writer must be open, null writes nothing.
+     */
+    void SetSlimOutput(std::shared_ptr<SlimTreeWriter> aWriter) { mSlimOutput = aWriter; }
+
+    /** @brief Analyse the spills in the selected entry range of a MAUS output file
+     *  @param aFileName The MAUS output ROOT file to read
+     *  @param aAnalysers The analysers, which hold the merged results on return
+     *  @return Boolean indicating if the input file could be read
+     */
+    bool Run(const std::string& aFileName, AnalyserGroup& aAnalysers);
+
+    /** @brief Analyse the spills in the selected entry range of a chain of MAUS output files
+     *  @param aFileNames The MAUS output ROOT files to read, in order. Names may contain
+     *                    wildcards, as accepted by TChain::Add.
+     *  @param aAnalysers The analysers, which hold the merged results on return
+     *  @return Boolean indicating if all the input files could be read
+     */
+    bool Run(const std::vector<std::string>& aFileNames, AnalyserGroup& aAnalysers);
+
+  private:
+    /** @brief Worker routine, analyse tasks until there are none left for any worker. Each
+     *         worker reads through its own chain of the input files.
+     *  @param aWorker The index of this worker
+     *  @param aAnalysers The analysers owned by this worker
+     */
+    void work(int aWorker, AnalyserGroup& aAnalysers);
+
+    /** @brief Take the next tree entry from the shared queue
+     *  @return The entry number, or -1 if there are none left
+     */
+    Long64_t next_entry();
+
+    /** @brief Record that a chain entry has been taken and will be fully analysed before the
+     *         next checkpoint
+     */
+    void mark_done(Long64_t aEntry);
+
+    /** @brief Return the position of a chain entry in the entry queue. This is the entry itself
+     *         unless only the entries of a selection index are being read.
+     */
+    Long64_t queue_position(Long64_t aEntry) const;
+
+    /** @brief Gather the events selected by each worker into the selection index */
+    void collect_selected();
+
+    /** @brief Called by an idle worker while a checkpoint is requested, wait until it is done */
+    void pause();
+
+    /** @brief Checkpoint coordinator, run on the main thread until the workers finish
+     *  @param aGroups The analysers of every worker
+     */
+    void checkpoint_loop(const std::vector<AnalyserGroup*>& aGroups);
+
+    /** @brief Write the summed state of the workers' analysers to the checkpoint file. The
+     *         workers must be paused or finished.
+     */
+    bool write_checkpoint(const std::vector<AnalyserGroup*>& aGroups);
+
+    /** @brief Restore the analysers and the entries done from the checkpoint file */
+    bool read_checkpoint(AnalyserGroup& aAnalysers);
+
+    /** @brief Check a spill is a usable physics event, then split it into tasks and push them
+     *         onto a worker's queue. Takes ownership of the spill data.
+     */
+    void schedule_spill(int aWorker, SpillReader::Entry& aEntry);
+
+    /** @brief Print the prefetch queue wait counters, if prefetching was used */
+    void print_prefetch_stats() const;
+
+    /** @brief Print the time accounting for each worker, if more than one was used */
+    void print_worker_stats() const;
+
+    /** @brief Pass each recon event in a task, with its MC event, to the analysers, record
+     *         the events passing the selection, if there is one, and fill the slim ntuple
+     *  @return The number of recon events analysed
+     */
+    int analyse_task(int aWorker, const SpillTask& aTask, AnalyserGroup& aAnalysers);
+
+    GroupMaker mMaker; ///< Creates the analyser replicas for the extra worker threads
+    int mNThreads; ///< The number of worker threads to use
+    int mPrefetchDepth; ///< The number of spills each worker reads ahead, 0 to read inline
+    int mEventsPerTask; ///< The maximum number of recon events per task, 0 for whole spills
+    bool mSkipUnusedData; ///< Should unused spill branches be switched off
+    unsigned int mDataRequirements; ///< The spill data read in the current Run
+    QueueStats mPrefetchStats; ///< Prefetch queue wait counters, summed over workers
+    Long64_t mFirstEntry; ///< The requested first chain entry to analyse
+    Long64_t mLastEntry; ///< The requested entry to stop before, negative for the last entry
+    std::vector<std::string> mFileNames; ///< The input files of the current Run
+    Long64_t mNEntries; ///< The number of spills in the chain being analysed
+    Long64_t mBegin; ///< The first queue position analysed in the current Run
+    Long64_t mEnd; ///< The queue position the current Run stops before
+    std::atomic<Long64_t> mNextEntry; ///< The shared queue, next position to be analysed
+    std::string mSelectionName; ///< The name of the selection recorded
+    SelectionIndex::Selection mSelection; ///< The selection recorded, may be empty
+    SelectionIndex mSelected; ///< The events passing the selection in the last Run
+    std::vector<std::vector<SelectionIndex::Entry>> mWorkerSelected; ///< Selected, per worker
+    std::shared_ptr<const SelectionIndex> mSelectionInput; ///< The events to analyse, or null
+    std::vector<Long64_t> mEntryList; ///< The queue entries when reading a selection index
+    std::shared_ptr<SlimTreeWriter> mSlimOutput; ///< Writes the slim ntuple, or null
+    std::atomic<int> mSpillsProcessed; ///< Counter, number of spills read by all workers
+    std::atomic<int> mEventsProcessed; ///< Counter, number of events analysed by all workers
+    std::atomic<int> mReading; ///< Number of workers currently reading a spill
+    std::unique_ptr<SpillScheduler> mScheduler; ///< The per-worker task queues
+    std::vector<WorkerStats> mWorkerStats; ///< Time accounting for each worker
+    std::string mCheckpointFile; ///< The checkpoint file, empty if not checkpointing
+    double mCheckpointInterval; ///< The time between checkpoints (s)
+    std::unique_ptr<AnalyserGroup> mCheckpointSum; ///< Merge target reused by each checkpoint
+    Long64_t mWatermark; ///< Every queue position before this one has been analysed
+    std::set<Long64_t> mDoneEntries; ///< Positions after the watermark which have been analysed
+    std::set<Long64_t> mSkipEntries; ///< Positions done before the checkpoint resumed from
+    std::mutex mDoneMutex; ///< Guards the watermark and done entries
+    std::atomic<bool> mPauseRequested; ///< Set while workers should pause for a checkpoint
+    int mPausedWorkers; ///< The number of workers currently paused
+    int mActiveWorkers; ///< The number of workers still running
+    std::mutex mPauseMutex; ///< Guards the worker counts
+    std::condition_variable mPauseCV; ///< Signals changes of the pause state and worker counts
+    std::mutex mOutputMutex; ///< Serialises the statistics from the workers
+};
+} // ~namespace mica
+
+#endif
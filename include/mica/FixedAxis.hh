@@ -0,0 +1,42 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef FIXEDAXIS_HH
+#define FIXEDAXIS_HH
+
+namespace mica {
+
+/** @class FixedAxis
+ *         A fixed width binning, numbered as a ROOT TAxis: bin 0 is the underflow, 1 to n the
+ *         bins and n + 1 the overflow. FindBin gives exactly the bin TAxis::FindFixBin gives.
+ *  @author A. Dobbs
+ */
+class FixedAxis {
+  public:
+    FixedAxis(int aNBins, double aLow, double aUp) : mNBins{aNBins}, mLow{aLow}, mUp{aUp} {}
+
+    /** @brief Return the bin holding a value, as TAxis::FindFixBin (NaN goes to the overflow) */
+    int FindBin(double aX) const {
+      if (aX < mLow) return 0;
+      if (!(aX < mUp)) return mNBins + 1;
+      return 1 + static_cast<int>(mNBins * (aX - mLow) / (mUp - mLow));
+    }
+
+    /** @brief Return the number of bins, not counting the underflow and overflow */
+    int GetNBins() const { return mNBins; }
+
+    /** @brief Return the lower edge of the first bin */
+    double GetLow() const { return mLow; }
+
+    /** @brief Return the upper edge of the last bin */
+    double GetUp() const { return mUp; }
+
+  private:
+    int mNBins; ///< Number of bins
+    double mLow; ///< Lower edge of the first bin
+    double mUp; ///< Upper edge of the last bin
+};
+} // ~namespace mica
+
+#endif
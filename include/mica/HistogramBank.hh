@@ -0,0 +1,273 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef HISTOGRAMBANK_HH
+#define HISTOGRAMBANK_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "TDirectory.h"
+#include "TH1.h"
+#include "TH2.h"
+
+#include "mica/FixedAxis.hh"
+#include "mica/StateIO.hh"
+
+namespace mica {
+
+/** @class HistogramBank
+ *         A family of identically binned histograms, one per tracker, station and plane, held in
+ *         one contiguous array of bin contents rather than as separate ROOT objects. The bin
+ *         type T (e.g. Int_t, Float_t or Double_t) sets the memory per bin, and Merge is a single
+ *         pass adding one array to another. ROOT histograms of type THist (e.g. TH1I or TH2D)
+ *         are only made when needed for drawing or saving, with the same bin contents,
+ *         statistics and entries as if THist had been filled directly. Fills are unweighted,
+ *         and, as ROOT does by default, the underflows and overflows are left out of the
+ *         statistics.
+ *
+ *         Trackers and planes are numbered from 0 and stations from 1, as in the MAUS data.
+ *  @author A. Dobbs
+ */
+template <typename T, class THist>
+class HistogramBank {
+  public:
+    static constexpr bool kIs2D = std::is_base_of<TH2, THist>::value; ///< True for 2D histograms
+    static const int kNStats = 7; ///< The sums kept for the statistics, as TH2::GetStats
+
+    /** @brief Constructor for a bank of 1D histograms
+     *  @param aNTrackers The number of trackers
+     *  @param aNStations The number of stations per tracker
+     *  @param aNPlanes The number of planes per station
+     *  @param aXAxis The binning of every histogram
+     */
+    HistogramBank(int aNTrackers, int aNStations, int aNPlanes, const FixedAxis& aXAxis)
+        : HistogramBank(aNTrackers, aNStations, aNPlanes, aXAxis, FixedAxis(0, 0.0, 1.0)) {
+      static_assert(!kIs2D, "A bank of 2D histograms needs a y binning");
+    }
+
+    /** @brief Constructor for a bank of 2D histograms, as above with the y binning too */
+    HistogramBank(int aNTrackers, int aNStations, int aNPlanes, const FixedAxis& aXAxis,
+                  const FixedAxis& aYAxis)
+        : mNTrackers{aNTrackers}, mNStations{aNStations}, mNPlanes{aNPlanes},
+          mNHists{aNTrackers * aNStations * aNPlanes}, mXAxis{aXAxis}, mYAxis{aYAxis},
+          mNCells{(aXAxis.GetNBins() + 2) * (kIs2D ? aYAxis.GetNBins() + 2 : 1)},
+          mCells(static_cast<size_t>(mNHists) * mNCells, T()),
+          mStats(static_cast<size_t>(mNHists) * kStride, 0.0),
+          mNames(mNHists), mTitles(mNHists) {}
+
+    /** @brief Return the position of a histogram in the bank, or -1 if out of range */
+    int GetIndex(int aTracker, int aStation, int aPlane) const {
+      if (aTracker < 0 || aTracker >= mNTrackers || aStation < 1 || aStation > mNStations ||
+          aPlane < 0 || aPlane >= mNPlanes) return -1;
+      return (aTracker * mNStations + aStation - 1) * mNPlanes + aPlane;
+    }
+
+    /** @brief Return the number of histograms in the bank */
+    int size() const { return mNHists; }
+
+    /** @brief Set the name and title given to a ROOT histogram made from the bank */
+    void SetName(int aTracker, int aStation, int aPlane, const std::string& aName,
+                 const std::string& aTitle) {
+      int index = GetIndex(aTracker, aStation, aPlane);
+      if (index < 0) return;
+      mNames[index] = aName;
+      mTitles[index] = aTitle;
+    }
+
+    /** @brief Set the axis titles given to every ROOT histogram made from the bank */
+    void SetAxisTitles(const std::string& aXTitle, const std::string& aYTitle = "") {
+      mXTitle = aXTitle;
+      mYTitle = aYTitle;
+    }
+
+    /** @brief Add one count at aX to a 1D histogram, as TH1::Fill(x). Ignored if the tracker,
+     *         station or plane is out of range.
+     */
+    void Fill(int aTracker, int aStation, int aPlane, double aX) {
+      static_assert(!kIs2D, "Fill a bank of 2D histograms with x and y");
+      int index = GetIndex(aTracker, aStation, aPlane);
+      if (index < 0) return;
+      int bin = mXAxis.FindBin(aX);
+      mCells[static_cast<size_t>(index) * mNCells + bin] += 1;
+      double* stats = &mStats[static_cast<size_t>(index) * kStride];
+      stats[0] += 1.0;
+      if (bin == 0 || bin > mXAxis.GetNBins()) return;
+      stats[1] += 1.0;
+      stats[2] += 1.0;
+      stats[3] += aX;
+      stats[4] += aX * aX;
+    }
+
+    /** @brief Add one count at (aX, aY) to a 2D histogram, as TH2::Fill(x, y). Ignored if the
+     *         tracker, station or plane is out of range.
+     */
+    void Fill(int aTracker, int aStation, int aPlane, double aX, double aY) {
+      static_assert(kIs2D, "Fill a bank of 1D histograms with x only");
+      int index = GetIndex(aTracker, aStation, aPlane);
+      if (index < 0) return;
+      int binx = mXAxis.FindBin(aX);
+      int biny = mYAxis.FindBin(aY);
+      mCells[static_cast<size_t>(index) * mNCells + binx + (mXAxis.GetNBins() + 2) * biny] += 1;
+      double* stats = &mStats[static_cast<size_t>(index) * kStride];
+      stats[0] += 1.0;
+      if (binx == 0 || binx > mXAxis.GetNBins() || biny == 0 || biny > mYAxis.GetNBins()) return;
+      stats[1] += 1.0;
+      stats[2] += 1.0;
+      stats[3] += aX;
+      stats[4] += aX * aX;
+      stats[5] += aY;
+      stats[6] += aY * aY;
+      stats[7] += aX * aY;
+    }
+
+    /** @brief Return the content of a cell of a histogram, numbered as in ROOT */
+    T GetBinContent(int aTracker, int aStation, int aPlane, int aBin) const {
+      int index = GetIndex(aTracker, aStation, aPlane);
+      if (index < 0 || aBin < 0 || aBin >= mNCells) return T();
+      return mCells[static_cast<size_t>(index) * mNCells + aBin];
+    }
+
+    /** @brief Return the number of fills of a histogram, including the underflows and
+     *         overflows
+     */
+    double GetEntries(int aTracker, int aStation, int aPlane) const {
+      int index = GetIndex(aTracker, aStation, aPlane);
+      if (index < 0) return 0.0;
+      return mStats[static_cast<size_t>(index) * kStride];
+    }
+
+    /** @brief Add the contents of another bank of the same shape and binning to this one
+     *  @return False if the banks differ in size, in which case this bank is unchanged
+     */
+    bool Merge(const HistogramBank& aOther) {
+      if (aOther.mCells.size() != mCells.size()) return false;
+      T* cells = mCells.data();
+      const T* other_cells = aOther.mCells.data();
+      const size_t ncells = mCells.size();
+      for (size_t i = 0; i < ncells; ++i) cells[i] += other_cells[i];
+      double* stats = mStats.data();
+      const double* other_stats = aOther.mStats.data();
+      const size_t nstats = mStats.size();
+      for (size_t i = 0; i < nstats; ++i) stats[i] += other_stats[i];
+      return true;
+    }
+
+    /** @brief Empty every histogram */
+    void Reset() {
+      std::fill(mCells.begin(), mCells.end(), T());
+      std::fill(mStats.begin(), mStats.end(), 0.0);
+    }
+
+    /** @brief Return the bytes held by the bank's contents, statistics and names */
+    size_t GetMemoryUsage() const {
+      size_t result = mCells.capacity() * sizeof(T) + mStats.capacity() * sizeof(double);
+      for (int i = 0; i < mNHists; ++i) result += mNames[i].capacity() + mTitles[i].capacity();
+      return result;
+    }
+
+    /** @brief Return a new ROOT histogram holding the contents of one histogram of the bank,
+     *         owned by the caller, or nullptr if the tracker, station or plane is out of range
+     */
+    THist* Make(int aTracker, int aStation, int aPlane) const {
+      int index = GetIndex(aTracker, aStation, aPlane);
+      if (index < 0) return nullptr;
+      return make(index);
+    }
+
+    /** @brief Write each histogram to a directory as a ROOT histogram, keyed by its name */
+    bool Save(TDirectory* aDir) const {
+      bool result = true;
+      for (int i = 0; i < mNHists; ++i) {
+        std::unique_ptr<THist> hist(make(i));
+        if (!StateIO::Save(aDir, hist.get())) result = false;
+      }
+      return result;
+    }
+
+    /** @brief Replace the contents of each histogram with the ROOT histogram saved under its
+     *         name, those not found being left unchanged
+     */
+    bool Load(TDirectory* aDir) {
+      bool result = true;
+      for (int i = 0; i < mNHists; ++i) {
+        std::unique_ptr<THist> hist(make(i));
+        if (StateIO::Load(aDir, hist.get())) {
+          copy_from(i, hist.get());
+        } else {
+          result = false;
+        }
+      }
+      return result;
+    }
+
+  private:
+    static const int kStride = kNStats + 1; ///< Numbers kept per histogram: entries then sums
+
+    /** @brief Return a new ROOT histogram holding the contents of the histogram at aIndex */
+    THist* make(int aIndex) const {
+      THist* hist = create(aIndex, std::integral_constant<bool, kIs2D>());
+      hist->GetXaxis()->SetTitle(mXTitle.c_str());
+      if (kIs2D) hist->GetYaxis()->SetTitle(mYTitle.c_str());
+      const T* cells = &mCells[static_cast<size_t>(aIndex) * mNCells];
+      for (int i = 0; i < mNCells; ++i) {
+        if (cells[i] != T()) hist->SetBinContent(i, cells[i]);
+      }
+      // Setting the contents resets the statistics and entries, so these go in last
+      const double* sums = &mStats[static_cast<size_t>(aIndex) * kStride];
+      double stats[TH1::kNstat] = {0};
+      for (int i = 0; i < kNStats; ++i) stats[i] = sums[i + 1];
+      hist->PutStats(stats);
+      hist->SetEntries(sums[0]);
+      return hist;
+    }
+
+    /** @brief Construct an empty 2D ROOT histogram */
+    THist* create(int aIndex, std::true_type) const {
+      return new THist(mNames[aIndex].c_str(), mTitles[aIndex].c_str(), mXAxis.GetNBins(),
+                       mXAxis.GetLow(), mXAxis.GetUp(), mYAxis.GetNBins(), mYAxis.GetLow(),
+                       mYAxis.GetUp());
+    }
+
+    /** @brief Construct an empty 1D ROOT histogram */
+    THist* create(int aIndex, std::false_type) const {
+      return new THist(mNames[aIndex].c_str(), mTitles[aIndex].c_str(), mXAxis.GetNBins(),
+                       mXAxis.GetLow(), mXAxis.GetUp());
+    }
+
+    /** @brief Replace the contents of the histogram at aIndex with those of a ROOT histogram */
+    void copy_from(int aIndex, const TH1* aHist) {
+      T* cells = &mCells[static_cast<size_t>(aIndex) * mNCells];
+      for (int i = 0; i < mNCells; ++i) cells[i] = static_cast<T>(aHist->GetBinContent(i));
+      double stats[TH1::kNstat] = {0};
+      aHist->GetStats(stats);
+      double* sums = &mStats[static_cast<size_t>(aIndex) * kStride];
+      sums[0] = aHist->GetEntries();
+      for (int i = 0; i < kNStats; ++i) sums[i + 1] = stats[i];
+    }
+
+    int mNTrackers; ///< The number of trackers
+    int mNStations; ///< The number of stations per tracker
+    int mNPlanes; ///< The number of planes per station
+    int mNHists; ///< The number of histograms
+    FixedAxis mXAxis; ///< The x binning
+    FixedAxis mYAxis; ///< The y binning, unused for 1D histograms
+    int mNCells; ///< The number of cells per histogram, including the underflows and overflows
+    std::vector<T> mCells; ///< The bin contents, histogram by histogram, cells as in ROOT
+    std::vector<double> mStats; ///< The entries and statistics sums, kStride per histogram
+    std::vector<std::string> mNames; ///< The names of the ROOT histograms made
+    std::vector<std::string> mTitles; ///< The titles of the ROOT histograms made
+    std::string mXTitle; ///< The x axis title
+    std::string mYTitle; ///< The y axis title
+};
+
+template <typename T, class THist>
+constexpr bool HistogramBank<T, THist>::kIs2D;
+} // ~namespace mica
+
+#endif
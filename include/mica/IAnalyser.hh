@@ -12,9 +12,11 @@ namespace mica {
  *  May also implement a Clone here, easier than doing it in each daughter class (another CRTP use).
  *
  *  @tparam Derived The daughter class type
+ *  @tparam Base The class IAnalyser inherits from, AnalyserBase unless the daughter class is
+ *          built on an intermediate analyser such as AnalyserTrackerMC
  */
-template <typename Derived>
-class IAnalyser : public AnalyserBase {
+template <typename Derived, typename Base = AnalyserBase>
+class IAnalyser : public Base {
   public:
     IAnalyser() {};
     virtual ~IAnalyser() {};
@@ -0,0 +1,232 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef LOG_HH
+#define LOG_HH
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+/** The log levels, as numbers for the preprocessor */
+#define MICA_LOG_LEVEL_TRACE 0
+#define MICA_LOG_LEVEL_DEBUG 1
+#define MICA_LOG_LEVEL_INFO 2
+#define MICA_LOG_LEVEL_WARNING 3
+#define MICA_LOG_LEVEL_ERROR 4
+
+/** The lowest level compiled in, messages below it being removed entirely by the preprocessor.
+ *  Set with -DMICA_LOG_MIN_LEVEL=n (the MICA_LOG_MIN_LEVEL CMake cache variable), otherwise
+ *  info for release (NDEBUG) builds and trace for the rest.
+ */
+#ifndef MICA_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define MICA_LOG_MIN_LEVEL MICA_LOG_LEVEL_INFO
+#else
+#define MICA_LOG_MIN_LEVEL MICA_LOG_LEVEL_TRACE
+#endif
+#endif
+
+namespace mica {
+
+class LogSite;
+
+/** The severity of a log message */
+enum class LogLevel {
+  kTrace = MICA_LOG_LEVEL_TRACE,
+  kDebug = MICA_LOG_LEVEL_DEBUG,
+  kInfo = MICA_LOG_LEVEL_INFO,
+  kWarning = MICA_LOG_LEVEL_WARNING,
+  kError = MICA_LOG_LEVEL_ERROR
+};
+
+/** @class Log
+ *         Leveled logging for the whole programme, written to std::cerr one line per message.
+ *         Use the MICA_LOG_* macros rather than Write: they only format the message if its level
+ *         is switched on, and limit how often each one may print (see LogSite). Trace and debug
+ *         messages are compiled out of release builds (see MICA_LOG_MIN_LEVEL); of those
+ *         compiled in, only those at or above the level set with SetLevel (by default info) are
+ *         printed.
+ *  @author A. Dobbs
+ */
+class Log {
+  public:
+    static const int kDefaultRate = 10; ///< Messages a second printed from one place by default
+
+    /** @brief Is a level printed */
+    static bool IsEnabled(LogLevel aLevel) {
+      return static_cast<int>(aLevel) >= MICA_LOG_MIN_LEVEL &&
+             static_cast<int>(aLevel) >= mLevel.load(std::memory_order_relaxed);
+    }
+
+    /** @brief Return the lowest level printed */
+    static LogLevel GetLevel() { return static_cast<LogLevel>(mLevel.load()); }
+
+    /** @brief Set the lowest level printed, levels below MICA_LOG_MIN_LEVEL being compiled out */
+    static void SetLevel(LogLevel aLevel) { mLevel = static_cast<int>(aLevel); }
+
+    /** @brief Set the lowest level printed from its name (trace, debug, info, warning or error)
+     *  @return False if the name is not known, in which case the level is unchanged
+     */
+    static bool SetLevel(const std::string& aName);
+
+    /** @brief Print a message, thread safe
+     *  @param aLevel The message level, printed as a prefix for all but info
+     *  @param aMessage The message, without a trailing new line
+     *  @param aNSuppressed The number of messages from the same place suppressed since the last
+     *                      one printed, noted after the message if non-zero
+     */
+    static void Write(LogLevel aLevel, const std::string& aMessage, long aNSuppressed = 0);
+
+    /** @brief Print the number of messages suppressed at each place since its last message
+     *         printed, which would otherwise only be reported by its next message. Called at the
+     *         end of EventLoop::Run, and at exit.
+     */
+    static void FlushSuppressed();
+
+    /** @brief Remember a place which has suppressed messages, for FlushSuppressed, done by
+     *         LogSite on its first suppressed message
+     */
+    static void Register(LogSite* aSite);
+
+    /** @brief Print the messages a place still has suppressed and forget it, done by LogSite
+     *         when it is destroyed (at exit, sites being function-local statics)
+     */
+    static void Unregister(LogSite* aSite);
+
+  private:
+    static std::atomic<int> mLevel; ///< The lowest level printed
+};
+
+/** @class LogSite
+ *         Limits the messages printed from one place in the code (one use of a MICA_LOG_* macro)
+ *         to a number a second, counting those suppressed so the next message printed can say how
+ *         many were missed, or failing that Log::FlushSuppressed. Thread safe, the limit being
+ *         approximate when several threads log from the same place at once.
+ *  @author A. Dobbs
+ */
+class LogSite {
+  public:
+    /** @brief Constructor
+     *  @param aRate The messages a second printed at most
+     */
+    explicit LogSite(int aRate = Log::kDefaultRate) : mRate{aRate}, mWindow{-1}, mCount{0},
+                                                      mNSuppressed{0}, mRegistered{false},
+                                                      mLevel{LogLevel::kInfo} {}
+
+    /** @brief Destructor, reports any messages still suppressed */
+    ~LogSite() {
+      if (mRegistered.load()) Log::Unregister(this);
+    }
+
+    /** @brief May a message be printed now, counting it as suppressed if not */
+    bool Allow() {
+      std::int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+          std::chrono::steady_clock::now().time_since_epoch()).count();
+      std::int64_t window = mWindow.load(std::memory_order_relaxed);
+      if (now != window && mWindow.compare_exchange_strong(window, now)) mCount = 0;
+      if (mCount.fetch_add(1, std::memory_order_relaxed) < mRate) return true;
+      mNSuppressed.fetch_add(1, std::memory_order_relaxed);
+      if (!mRegistered.load(std::memory_order_relaxed) && !mRegistered.exchange(true)) {
+        Log::Register(this);
+      }
+      return false;
+    }
+
+    /** @brief Print a message allowed by Allow, noting the messages suppressed before it, and
+     *         remember it for Log::FlushSuppressed
+     */
+    void Write(LogLevel aLevel, const std::string& aMessage) {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mLevel = aLevel;
+      mLastMessage = aMessage;
+      Log::Write(aLevel, aMessage, TakeSuppressed());
+    }
+
+    /** @brief Return the number of messages suppressed since the last call, and reset it */
+    long TakeSuppressed() { return mNSuppressed.exchange(0); }
+
+    /** @brief Print the number of messages suppressed since the last one printed, if any */
+    void FlushSuppressed() {
+      std::lock_guard<std::mutex> lock(mMutex);
+      long nsuppressed = TakeSuppressed();
+      if (nsuppressed == 0) return;
+      Log::Write(mLevel, std::to_string(nsuppressed) + " more messages suppressed like: " +
+                 mLastMessage);
+    }
+
+  private:
+    int mRate; ///< The messages a second printed at most
+    std::atomic<std::int64_t> mWindow; ///< The second the current count is for
+    std::atomic<int> mCount; ///< The messages seen in the current second
+    std::atomic<long> mNSuppressed; ///< The messages suppressed since the last one printed
+    std::atomic<bool> mRegistered; ///< Has the site been registered with Log::Register
+    std::mutex mMutex; ///< Guards the last message
+    LogLevel mLevel; ///< The level of the last message printed
+    std::string mLastMessage; ///< The last message printed
+};
+} // ~namespace mica
+
+/** Log a message streamed from aMessage (e.g. "Found " << n << " tracks") at a level, printing at
+ *  most aRate a second from this place
+ */
+#define MICA_LOG_AT_RATE(aLevel, aRate, aMessage)                                             \
+  do {                                                                                        \
+    if (mica::Log::IsEnabled(aLevel)) {                                                       \
+      static mica::LogSite mica_log_site(aRate);                                              \
+      if (mica_log_site.Allow()) {                                                            \
+        std::ostringstream mica_log_stream;                                                   \
+        mica_log_stream << aMessage;                                                          \
+        mica_log_site.Write(aLevel, mica_log_stream.str());                                   \
+      }                                                                                       \
+    }                                                                                         \
+  } while (false)
+
+/** Log a message at a level, at the default rate */
+#define MICA_LOG_AT(aLevel, aMessage) MICA_LOG_AT_RATE(aLevel, mica::Log::kDefaultRate, aMessage)
+
+/** A message below MICA_LOG_MIN_LEVEL: still type checked, so the variables it uses count as
+ *  used, but never run and so removed by the compiler
+ */
+#define MICA_LOG_DISCARD(aMessage)                                                            \
+  do {                                                                                        \
+    if (false) {                                                                              \
+      std::ostringstream mica_log_stream;                                                     \
+      mica_log_stream << aMessage;                                                            \
+    }                                                                                         \
+  } while (false)
+
+#if MICA_LOG_MIN_LEVEL <= MICA_LOG_LEVEL_TRACE
+#define MICA_LOG_TRACE(aMessage) MICA_LOG_AT(mica::LogLevel::kTrace, aMessage)
+#else
+#define MICA_LOG_TRACE(aMessage) MICA_LOG_DISCARD(aMessage)
+#endif
+
+#if MICA_LOG_MIN_LEVEL <= MICA_LOG_LEVEL_DEBUG
+#define MICA_LOG_DEBUG(aMessage) MICA_LOG_AT(mica::LogLevel::kDebug, aMessage)
+#else
+#define MICA_LOG_DEBUG(aMessage) MICA_LOG_DISCARD(aMessage)
+#endif
+
+#if MICA_LOG_MIN_LEVEL <= MICA_LOG_LEVEL_INFO
+#define MICA_LOG_INFO(aMessage) MICA_LOG_AT(mica::LogLevel::kInfo, aMessage)
+/** Log progress at info level, at most once a second */
+#define MICA_LOG_PROGRESS(aMessage) MICA_LOG_AT_RATE(mica::LogLevel::kInfo, 1, aMessage)
+#else
+#define MICA_LOG_INFO(aMessage) MICA_LOG_DISCARD(aMessage)
+#define MICA_LOG_PROGRESS(aMessage) MICA_LOG_DISCARD(aMessage)
+#endif
+
+#if MICA_LOG_MIN_LEVEL <= MICA_LOG_LEVEL_WARNING
+#define MICA_LOG_WARNING(aMessage) MICA_LOG_AT(mica::LogLevel::kWarning, aMessage)
+#else
+#define MICA_LOG_WARNING(aMessage) MICA_LOG_DISCARD(aMessage)
+#endif
+
+#define MICA_LOG_ERROR(aMessage) MICA_LOG_AT(mica::LogLevel::kError, aMessage)
+
+#endif
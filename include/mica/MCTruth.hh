@@ -0,0 +1,212 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef MCTRUTH_HH
+#define MCTRUTH_HH
+
+#include <array>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "src/common_cpp/DataStructure/Hit.hh"
+#include "src/common_cpp/DataStructure/MCEvent.hh"
+#include "src/common_cpp/DataStructure/ThreeVector.hh"
+#include "src/common_cpp/Recon/SciFi/SciFiLookup.hh"
+#include "mica/TrackHitMasks.hh"
+
+namespace mica {
+
+/** @struct MCTrackData
+ *          Simple data container to hold tracker track info deduced from MC
+ *  @author A. Dobbs
+ */
+struct MCTrackData {
+  int tracker; ///< The tracker number, 0 = TkU, 1 = TkD
+  int track_id; ///< The track id number
+  int pid; ///< The PGD particle id
+  double energy; ///< The track energy at the analysis plane
+  MAUS::ThreeVector pos; ///< The track position at the analysis plane
+  MAUS::ThreeVector mom; ///< The track momentum at the analysis plane
+  std::vector<int> stations_hit; ///< The tracker stations the track created hits in
+};
+
+/** @class MCTruth
+ *         The tracker MC truth of one MC event: the SciFi digit to MC hit lookup table, and the
+ *         MCTrackData of each track which left enough hits to be reconstructible. Both are built
+ *         once per event, by Build, and are then only read. The EventContext of an event makes
+ *         one on first request (see EventContext::GetMCTruth) and shares it between all the MC
+ *         analysers of the group, rather than each analyser building its own. The stations and
+ *         planes each track hit are counted with TrackHitMasks. An index from each digit to the
+ *         MC tracks which contributed to it, with the plane of their hits, lets recon objects be
+ *         matched to MC tracks in one pass over their digits.
+ *
+ *         The track data records are held in one array owned by the truth, and truths are
+ *         recycled through a per-thread pool of kPoolSize truths (see Make). AnalyserGroup lets
+ *         go of the truths of a spill kPoolSize events at a time (see
+ *         AnalyserGroup::AnalyseSpill), so no more truths are in use at once than the pool
+ *         holds, and once it is warm building the truth of an event allocates nothing but the
+ *         MAUS lookup table.
+ *
+ *         While MemoryUsage tracking is on each truth estimates the memory it holds when built,
+ *         and the largest total held at once by the truths of one thread is kept for the memory
+ *         report (see GetPeakMemoryUsage), as the truth belongs to no one analyser.
+ *  @author A. Dobbs
+ */
+class MCTruth {
+  public:
+    static const size_t kPoolSize = 8; ///< The most idle truths kept by each thread
+
+    /** What makes a track reconstructible, and where its MCTrackData is taken */
+    struct Settings {
+      int ref_station = 1; ///< Reference station for the track data
+      int ref_plane = 0; ///< Reference plane for the track data
+      int n_stations = 5; ///< # of stations hit for a track to be classed as reconstructible
+      int n_planes = 3; ///< # of planes hit per station for the station to count as hit
+
+      bool operator==(const Settings& aOther) const {
+        return ref_station == aOther.ref_station && ref_plane == aOther.ref_plane &&
+               n_stations == aOther.n_stations && n_planes == aOther.n_planes;
+      }
+    };
+
+    /** One MC track contributing to a digit, and the plane of the hits it left there */
+    struct DigitTrack {
+      int track_id; ///< The MC track id
+      TrackHitMasks::Mask plane; ///< The station and plane of the digit, as TrackHitMasks::GetBit
+    };
+
+    /** The MC tracks contributing to one digit */
+    struct DigitTracks {
+      const DigitTrack* first; ///< The first track
+      const DigitTrack* last; ///< One past the last track
+      const DigitTrack* begin() const { return first; }
+      const DigitTrack* end() const { return last; }
+      bool empty() const { return first == last; }
+    };
+
+    /** The deleter of the truths returned by Make, giving them back to the pool of the
+     *  releasing thread
+     */
+    struct Releaser {
+      void operator()(const MCTruth* aTruth) const { release(aTruth); }
+    };
+
+    /** A truth returned by Make, back in the pool once it goes out of scope. Unlike a shared
+     *  pointer it needs no control block, so handing out a pooled truth allocates nothing.
+     */
+    typedef std::unique_ptr<const MCTruth, Releaser> Handle;
+
+    /** @brief Constructor, the truth is empty until built */
+    MCTruth() : mValid{false}, mMemoryUsage{0} {}
+
+    /** @brief Destructor */
+    ~MCTruth();
+
+    MCTruth(const MCTruth&) = delete;
+    MCTruth& operator=(const MCTruth&) = delete;
+
+    /** @brief Return a truth built from an MC event, taken from a pool kept by the calling
+     *         thread and given back to it when the handle goes, so its records and working
+     *         space are reused event after event
+     *  @param aMCEvent The MC event, which must outlive the truth, may be nullptr
+     *  @param aSettings The reconstructibility settings
+     */
+    static Handle Make(MAUS::MCEvent* const aMCEvent, const Settings& aSettings);
+
+    /** @brief Build the lookup table and the track data, replacing any built before
+     *  @param aMCEvent The MC event, which must outlive the truth, may be nullptr
+     *  @param aSettings The reconstructibility settings
+     */
+    void Build(MAUS::MCEvent* const aMCEvent, const Settings& aSettings);
+
+    /** @brief Was the lookup table made, with at least one digit in it */
+    bool IsValid() const { return mValid; }
+
+    /** @brief Return the settings the truth was built with */
+    const Settings& GetSettings() const { return mSettings; }
+
+    /** @brief Return the scifi MC lookup table, owned by the truth */
+    MAUS::SciFiLookup* GetLookup() const { return mLookup.get(); }
+
+    /** @brief Return the MC data for TkU, owned by the truth */
+    const std::vector<const MCTrackData*>& GetMCDataTkU() const { return mMCDataTkU; }
+
+    /** @brief Return the MC data for TkD, owned by the truth */
+    const std::vector<const MCTrackData*>& GetMCDataTkD() const { return mMCDataTkD; }
+
+    /** @brief Return the MC tracks which left hits in a digit, each track once, from an index
+     *         built with the truth
+     *  @param aDigitId The digit id, as SciFiLookup::get_digit_id
+     *  @return The tracks, empty if the digit has no MC hits
+     */
+    DigitTracks GetDigitTracks(double aDigitId) const;
+
+    /** @brief Return the estimated bytes held by the truth, including the lookup table, as
+     *         found when it was built, 0 unless MemoryUsage tracking was on
+     */
+    size_t GetMemoryUsage() const { return mMemoryUsage; }
+
+    /** @brief Return the largest estimated bytes held at once by the truths in use by one
+     *         thread, i.e. by one replica of the analysers, while MemoryUsage tracking was on
+     */
+    static size_t GetPeakMemoryUsage();
+
+    /** Create a map from mc track ids to vectors containing the station numbers for which
+     *  that track generated hits in aNPlanes or more planes.
+     *  To be used with one tracker at a time.
+     *  @param[in] hit_map A map from station numbers to the SciFiHits in that station,
+     *             for a single tracker.
+     *  @param[in] aNPlanes The number planes per station which need to be hit for the station
+     *             to count as one hit by the track
+     *  @return A map from mc track ids to vectors containing the station numbers for which
+     *          that track generated hits in aNPlanes or more planes, for a single tracker
+     */
+    static std::map<int, std::vector<int> > calc_stations_hit_by_track( \
+        std::map<int, std::vector<MAUS::SciFiHit*> >& hit_map, int aNPlanes);
+
+  private:
+    /** @brief Give a truth no longer referenced back to the pool of the releasing thread,
+     *         called by Releaser
+     */
+    static void release(const MCTruth* aTruth);
+
+    /** @brief Estimate the bytes held by the truth once built, as MemoryUsage does for analysers
+     *  @param[in] aHitsMap A copy of the lookup table, from digit ids to the hits of each digit
+     */
+    size_t estimate_memory(const std::map<double, std::vector<MAUS::SciFiHit*> >& aHitsMap) const;
+
+    /** @brief Replace the contents of aNumbers with the station numbers set in a mask of
+     *         stations, as from TrackHitMasks::GetStationsHit
+     */
+    static void station_numbers(unsigned int aStations, std::vector<int>& aNumbers);
+
+    /** @brief Build the index of the MC tracks contributing to each digit
+     *  @param[in] aHitsMap The lookup table, from digit ids to the hits making each digit
+     */
+    void index_digits(const std::map<double, std::vector<MAUS::SciFiHit*> >& aHitsMap);
+
+    /** @brief Populate the mMCData members
+     *  @param[in] aMCEvent MAUS::MCEvent to analyse
+     */
+    void fill_mc_track_data(MAUS::MCEvent* const aMCEvent);
+
+    Settings mSettings; ///< The reconstructibility settings
+    bool mValid; ///< Was the lookup table made, with at least one digit in it
+    std::unique_ptr<MAUS::SciFiLookup> mLookup; ///< The lookup table
+    std::vector<MCTrackData> mRecords; ///< The track data records, reused from build to build
+    std::vector<const MCTrackData*> mMCDataTkU; ///< MC data for TkU, pointing into mRecords
+    std::vector<const MCTrackData*> mMCDataTkD; ///< MC data for TkD, pointing into mRecords
+    std::vector<double> mDigitIds; ///< The digit ids with MC hits, in increasing order
+    std::vector<size_t> mDigitOffsets; ///< Where each digit's tracks start in mDigitTracks
+    std::vector<DigitTrack> mDigitTracks; ///< The tracks contributing to each digit in turn
+    std::array<TrackHitMasks, 2> mMasks; ///< Working space, the planes hit by each track
+    std::array<std::vector<int>, 2> mTrackIds; ///< Working space, reconstructible track ids
+    std::array<std::vector<unsigned int>, 2> mTrackStations; ///< Working space, stations hit
+    std::vector<TrackHitMasks::Entry> mEntries; ///< Working space, tracks sorted by id
+    size_t mMemoryUsage; ///< Estimated bytes held, from the last build while tracking was on
+};
+} // ~namespace mica
+
+#endif
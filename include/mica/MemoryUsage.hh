@@ -0,0 +1,154 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef MEMORYUSAGE_HH
+#define MEMORYUSAGE_HH
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "TGraph.h"
+#include "TH1.h"
+
+namespace mica {
+
+/** @class MemoryUsage
+ *         Helpers for accounting the memory held by analysers, and for measuring the heap
+ *         allocated while analysing an event.
+ *
+ *         The Of functions estimate the bytes held by an object and what it owns: for a ROOT
+ *         histogram the object itself, its bin contents, errors, buffer and variable bin edges.
+ *
+ *         Allocation tracking counts the bytes each thread has live on the heap, and the peak
+ *         since ResetThreadPeak. The counting is done by replacements of the global operator new
+ *         and delete in src/MemoryTracking.cc, which is linked only into the programmes that
+ *         report memory (the mica app), so that the library does not take over the allocator
+ *         of everything linking it. It is then switched on for the whole programme with
+ *         SetEnabled, and costs a flag check per allocation when off. It is only available with
+ *         the GNU C library (see IsTrackingAvailable).
+ *  @author A. Dobbs
+ */
+class MemoryUsage {
+  public:
+    /** @brief Return the bytes held by a ROOT histogram, 0 for nullptr */
+    static size_t Of(const TH1* aHist);
+
+    /** @brief Return the bytes held by a ROOT graph, 0 for nullptr */
+    static size_t Of(const TGraph* aGraph);
+
+    /** @brief Return the bytes held by an owned ROOT object */
+    template <class TRoot>
+    static size_t Of(const std::unique_ptr<TRoot>& aObject) { return Of(aObject.get()); }
+
+    /** @brief Return the bytes held by a vector of ROOT objects and the objects */
+    template <class TRoot>
+    static size_t Of(const std::vector<TRoot*>& aObjects) {
+      size_t result = aObjects.capacity() * sizeof(TRoot*);
+      for (auto obj : aObjects) result += Of(obj);
+      return result;
+    }
+
+    /** @brief Return the bytes held by a vector of owned ROOT objects and the objects */
+    template <class TRoot>
+    static size_t Of(const std::vector<std::unique_ptr<TRoot> >& aObjects) {
+      size_t result = aObjects.capacity() * sizeof(std::unique_ptr<TRoot>);
+      for (const auto& obj : aObjects) result += Of(obj.get());
+      return result;
+    }
+
+    /** @brief Return the bytes held by the elements of a vector, not counting any memory the
+     *         elements themselves own
+     */
+    template <class T>
+    static size_t OfElements(const std::vector<T>& aVector) {
+      return aVector.capacity() * sizeof(T);
+    }
+
+    /** @brief Can allocations be tracked, i.e. is src/MemoryTracking.cc linked in and built
+     *         with the GNU C library
+     */
+    static bool IsTrackingAvailable() { return mTrackingAvailable.load(); }
+
+    /** @brief Record that allocation tracking is linked in, called by MemoryTracking.cc */
+    static void SetTrackingAvailable() { mTrackingAvailable = true; }
+
+    /** @brief Count bytes allocated by the calling thread, called by the tracking allocator */
+    static void RecordAllocation(size_t aBytes);
+
+    /** @brief Count bytes freed by the calling thread, called by the tracking allocator */
+    static void RecordFree(size_t aBytes);
+
+    /** @brief Is allocation tracking switched on */
+    static bool IsEnabled() { return mEnabled.load(std::memory_order_relaxed); }
+
+    /** @brief Switch allocation tracking on or off */
+    static void SetEnabled(bool aEnabled) { mEnabled = aEnabled; }
+
+    /** @brief Return the bytes allocated less those freed by the calling thread while tracking
+     *         was on (may be negative if it freed memory allocated elsewhere)
+     */
+    static long GetThreadLive();
+
+    /** @brief Return the highest value of GetThreadLive since the last ResetThreadPeak */
+    static long GetThreadPeak();
+
+    /** @brief Start a new peak measurement for the calling thread, from its current value */
+    static void ResetThreadPeak();
+
+  private:
+    static std::atomic<bool> mEnabled; ///< Global tracking switch
+    static std::atomic<bool> mTrackingAvailable; ///< Is the tracking allocator linked in
+};
+
+/** @class MemoryReport
+ *         Collects the memory held by each analyser of a group, and the largest heap allocation
+ *         seen while it analysed one event, and prints them ranked by the memory held, along with
+ *         memory the analysers share (see AddShared). Used to
+ *         judge how many analyser replicas (worker threads) fit on a node.
+ *  @author A. Dobbs
+ */
+class MemoryReport {
+  public:
+    /** @brief Add an analyser
+     *  @param aName The analyser name
+     *  @param aHeld The bytes held by the analyser's histograms and containers
+     *  @param aPeakTransient The largest heap growth seen during one analyse call (bytes)
+     */
+    void AddAnalyser(const std::string& aName, size_t aHeld, long aPeakTransient);
+
+    /** @brief Add memory held on behalf of all the analysers of a replica, such as the MC truth
+     *         shared through the event context, which is counted in the totals but belongs to
+     *         no one analyser
+     *  @param aName The name of what holds the memory
+     *  @param aHeld The bytes held
+     */
+    void AddShared(const std::string& aName, size_t aHeld);
+
+    /** @brief Return the bytes held by all the analysers, i.e. by one replica of the group */
+    size_t GetTotalHeld() const;
+
+    /** @brief Print a table of the analysers ranked by the memory held
+     *  @param aOut The stream to print to
+     *  @param aNReplicas The number of replicas of the group (e.g. worker threads) to total
+     */
+    void Print(std::ostream& aOut, int aNReplicas = 1) const;
+
+  private:
+    /** Memory use of one analyser */
+    struct AnalyserMemory {
+      std::string name; ///< The analyser name
+      size_t held; ///< Bytes held
+      long peak_transient; ///< Largest heap growth during one analyse call (bytes)
+      bool shared; ///< Is the memory shared between the analysers, with no peak transient
+    };
+
+    std::vector<AnalyserMemory> mAnalysers; ///< The analysers, in the order added
+};
+} // ~namespace mica
+
+#endif
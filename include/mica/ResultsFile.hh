@@ -0,0 +1,54 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef RESULTSFILE_HH
+#define RESULTSFILE_HH
+
+#include <string>
+#include <vector>
+
+#include "mica/AnalyserGroup.hh"
+
+namespace mica {
+
+/** @class ResultsFile
+ *         Write the results of a group of analysers to a ROOT file without drawing anything,
+ *         and read them back later, e.g. to merge the output of many jobs and plot it. The file
+ *         holds one directory per analyser, named after the analyser, containing its histograms
+ *         and counters as written by AnalyserBase::Save (which includes the analyser options),
+ *         plus the list of analyser names in a TNamed called "Analysers". The group-level cuts
+ *         are listed by name in a TNamed called "Cuts", with their settings and cut-flow counters
+ *         in the "cuts" directory (see CutRegistry::Save). Each analyser directory also holds
+ *         the group cuts it subscribes to, "CutMask", and the names of its own cuts, "Cuts".
+ *         Reading recreates the analysers and cuts from their names with AnalyserFactory, so
+ *         only factory registered analysers and cuts which support Save and Load can be read
+ *         back, and the group is then as it was when written, cut flow included.
+ *  @author A. Dobbs
+ */
+class ResultsFile {
+  public:
+    /** @brief Write the results of a group of analysers
+     *  @param aFileName The ROOT file to create, overwriting any existing file
+     *  @param aAnalysers The analysers
+     *  @return False if the file could not be written, or not all analysers support saving
+     */
+    static bool Write(const std::string& aFileName, AnalyserGroup& aAnalysers);
+
+    /** @brief Create the analysers listed in a results file, and load their results
+     *  @param aFileName The ROOT file to read
+     *  @param[out] aAnalysers Set to the new analysers
+     *  @return False if the file could not be read, or not all analysers could be restored
+     */
+    static bool Read(const std::string& aFileName, AnalyserGroup& aAnalysers);
+
+    /** @brief Read several results files of the same analysers and merge them
+     *  @param aFileNames The ROOT files to read
+     *  @param[out] aAnalysers Set to the merged analysers
+     *  @return False if any file could not be read or merged, or the analysers differ
+     */
+    static bool Read(const std::vector<std::string>& aFileNames, AnalyserGroup& aAnalysers);
+};
+} // ~namespace mica
+
+#endif
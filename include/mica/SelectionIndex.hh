@@ -0,0 +1,97 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef SELECTIONINDEX_HH
+#define SELECTIONINDEX_HH
+
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "mica/AnalyserGroup.hh"
+#include "mica/EventContext.hh"
+
+namespace mica {
+
+/** @class SelectionIndex
+ *         A list of the events which passed a named selection, as (tree entry, recon event number)
+ *         pairs, kept sorted. Written by the event loop on a first pass over a run (see
+ *         EventLoop::SetSelection) to a small text sidecar file, and read back on later passes
+ *         so that only the spills holding selected events are read (EventLoop::SetSelectionInput).
+ *         The number of spills in the input is stored too, to catch an index being used with
+ *         different input files.
+ *  @author A. Dobbs
+ */
+class SelectionIndex {
+  public:
+    /** Function deciding if an event passes the selection */
+    typedef std::function<bool(const EventContext&)> Selection;
+
+    /** One selected event, the tree entry of its spill and its recon event number */
+    typedef std::pair<Long64_t, int> Entry;
+
+    SelectionIndex() : mNSpills{0} {}
+
+    /** @brief Constructor
+     *  @param aName The name of the selection
+     *  @param aNSpills The number of spills in the input the selection was made on
+     */
+    SelectionIndex(const std::string& aName, Long64_t aNSpills) : mName{aName},
+                                                                   mNSpills{aNSpills} {}
+
+    virtual ~SelectionIndex() {}
+
+    /** @brief Return the name of the selection */
+    const std::string& GetName() const { return mName; }
+
+    /** @brief Return the number of spills in the input the selection was made on */
+    Long64_t GetNSpills() const { return mNSpills; }
+
+    /** @brief Add a selected event, duplicates are ignored */
+    void Add(Long64_t aEntry, int aEvent);
+
+    /** @brief Add a selected event, duplicates are ignored */
+    void Add(const Entry& aEntry) { Add(aEntry.first, aEntry.second); }
+
+    /** @brief Return the number of selected events */
+    size_t size() const;
+
+    /** @brief Return the tree entries holding selected events, in increasing order */
+    std::vector<Long64_t> GetEntries() const;
+
+    /** @brief Return the selected recon event numbers of a tree entry, in increasing order, or
+     *         nullptr if the entry holds none
+     */
+    const std::vector<int>* GetEvents(Long64_t aEntry) const;
+
+    /** @brief Write the index as a text file, a short header then one "entry event" per line
+     *  @return False if the file could not be written
+     */
+    bool Write(const std::string& aFileName) const;
+
+    /** @brief Replace the contents with an index read from a file written by Write
+     *  @return False if the file could not be read
+     */
+    bool Read(const std::string& aFileName);
+
+    /** @brief Make a selection by name, for the apps. Known selections are "CutsTOFTime" (the
+     *         TOF1-TOF2 time-of-flight cut) and "AnalyserTrackerPREfficiency" (the good event
+     *         criteria of that analyser in aAnalysers, with its settings).
+     *  @return The selection, or an empty function if the name is unknown or the analyser is not
+     *          in the group. An analyser selection refers to the group, which must outlive it.
+     */
+    static Selection MakeSelection(const std::string& aName, const AnalyserGroup& aAnalysers);
+
+  private:
+    std::string mName; ///< The name of the selection
+    Long64_t mNSpills; ///< The number of spills in the input the selection was made on
+    std::map<Long64_t, std::vector<int>> mEvents; ///< The selected events of each tree entry
+};
+} // ~namespace mica
+
+#endif
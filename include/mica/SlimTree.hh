@@ -0,0 +1,157 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef SLIMTREE_HH
+#define SLIMTREE_HH
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Rtypes.h"
+#include "TFile.h"
+#include "TTree.h"
+
+#include "src/common_cpp/DataStructure/ReconEvent.hh"
+#include "mica/AnalyserGroup.hh"
+#include "mica/DataRequirements.hh"
+#include "mica/EventContext.hh"
+
+namespace mica {
+
+/** @class SlimEvent
+ *         One row of a slim tracker ntuple: the few numbers per recon event used by the
+ *         tracker momentum, fit quality and time-of-flight analysers. The TOF1 and TOF2
+ *         spacepoint counts and first times, the Kalman tracks (fit quality plus the trackpoint
+ *         at one reference station and plane), and the helical pattern recognition tracks.
+ *         Stored as a flat tree of plain numbers and variable length arrays, one branch per
+ *         quantity, so a pass over it reads a tiny fraction of the full spill.
+ *  @author A. Dobbs
+ */
+struct SlimEvent {
+  static const int kMaxTracks = 16; ///< Tracks stored per event, of each kind
+  static const unsigned int kDataRequirements = kSciFiTracks | kSciFiPRTracks | kTOFSpacePoints;
+
+  /** @brief Fill the row from an event
+   *  @param aContext The event
+   *  @param aStation The tracker station of the reference trackpoint stored for each track
+   *  @param aPlane The tracker plane of the reference trackpoint stored for each track
+   *  @return False if some tracks were dropped as there were more than kMaxTracks
+   */
+  bool Fill(const EventContext& aContext, int aStation, int aPlane);
+
+  /** @brief Rebuild a MAUS recon event holding the data in the row, owned by the caller. The
+   *         TOF1 and TOF2 spacepoints carry only their time, the Kalman tracks only their
+   *         reference trackpoint, and the pattern recognition tracks no spacepoints.
+   */
+  MAUS::ReconEvent* MakeReconEvent() const;
+
+  /** @brief Create a branch for each quantity of this row in a tree */
+  void Branch(TTree* aTree);
+
+  /** @brief Read each quantity of this row from a tree made with Branch */
+  void SetBranchAddresses(TTree* aTree);
+
+  Long64_t entry; ///< The tree entry of the spill in the MAUS file
+  Int_t event; ///< The recon event number in the spill
+  Int_t ntof1; ///< Number of TOF1 spacepoints
+  Int_t ntof2; ///< Number of TOF2 spacepoints
+  Double_t tof1_t; ///< Time of the first TOF1 spacepoint (ns)
+  Double_t tof2_t; ///< Time of the first TOF2 spacepoint (ns)
+
+  Int_t ntrk; ///< Number of Kalman tracks stored
+  Int_t trk_tracker[kMaxTracks]; ///< Tracker of the track
+  Int_t trk_charge[kMaxTracks]; ///< Charge of the track
+  Int_t trk_ndf[kMaxTracks]; ///< Kalman fit degrees of freedom
+  Int_t trk_npoints[kMaxTracks]; ///< Number of trackpoints on the track
+  Double_t trk_chi2[kMaxTracks]; ///< Kalman fit chi squared
+  Double_t trk_pvalue[kMaxTracks]; ///< Kalman fit p-value
+  Int_t trk_station[kMaxTracks]; ///< Station of the reference trackpoint, 0 if there is none
+  Int_t trk_plane[kMaxTracks]; ///< Plane of the reference trackpoint
+  Double_t trk_x[kMaxTracks]; ///< Reference trackpoint position x (mm)
+  Double_t trk_y[kMaxTracks]; ///< Reference trackpoint position y (mm)
+  Double_t trk_z[kMaxTracks]; ///< Reference trackpoint position z (mm)
+  Double_t trk_px[kMaxTracks]; ///< Reference trackpoint momentum x (MeV/c)
+  Double_t trk_py[kMaxTracks]; ///< Reference trackpoint momentum y (MeV/c)
+  Double_t trk_pz[kMaxTracks]; ///< Reference trackpoint momentum z (MeV/c)
+
+  Int_t nprh; ///< Number of helical pattern recognition tracks stored
+  Int_t prh_tracker[kMaxTracks]; ///< Tracker of the track
+  Int_t prh_charge[kMaxTracks]; ///< Charge of the track
+  Int_t prh_npoints[kMaxTracks]; ///< Number of spacepoints in the track
+  Int_t prh_circle_ndf[kMaxTracks]; ///< Circle fit degrees of freedom
+  Int_t prh_sz_ndf[kMaxTracks]; ///< s-z fit degrees of freedom
+  Double_t prh_circle_chisq[kMaxTracks]; ///< Circle fit chi squared
+  Double_t prh_sz_chisq[kMaxTracks]; ///< s-z fit chi squared
+  Double_t prh_R[kMaxTracks]; ///< Circle radius (mm)
+  Double_t prh_x0[kMaxTracks]; ///< Circle centre x (mm)
+  Double_t prh_y0[kMaxTracks]; ///< Circle centre y (mm)
+  Double_t prh_dsdz[kMaxTracks]; ///< s-z fit gradient
+  Double_t prh_sz_c[kMaxTracks]; ///< s-z fit intercept (mm)
+};
+
+/** @class SlimTreeWriter
+ *         Writes a slim tracker ntuple (see SlimEvent) while the full MAUS data is analysed,
+ *         one row per recon event. Fill may be called from several worker threads at once.
+ *  @author A. Dobbs
+ */
+class SlimTreeWriter {
+  public:
+    /** @brief Constructor
+     *  @param aStation The tracker station of the reference trackpoint stored for each track
+     *  @param aPlane The tracker plane of the reference trackpoint stored for each track
+     */
+    SlimTreeWriter(int aStation = 1, int aPlane = 0);
+
+    virtual ~SlimTreeWriter() { Close(); }
+
+    /** @brief Create the output file, replacing any existing file
+     *  @return False if the file could not be created
+     */
+    bool Open(const std::string& aFileName);
+
+    /** @brief Add a row for an event, thread safe
+     *  @param aContext The event
+     *  @param aEntry The tree entry of the spill in the MAUS file
+     *  @param aEvent The recon event number in the spill
+     */
+    void Fill(const EventContext& aContext, Long64_t aEntry, int aEvent);
+
+    /** @brief Write the tree and close the file
+     *  @return False if the tree could not be written
+     */
+    bool Close();
+
+    /** @brief Return the number of rows written */
+    Long64_t GetNRows() const { return mNRows; }
+
+  private:
+    int mStation; ///< The tracker station of the reference trackpoints
+    int mPlane; ///< The tracker plane of the reference trackpoints
+    std::unique_ptr<TFile> mFile; ///< The output file
+    TTree* mTree; ///< The output tree, owned by the file
+    SlimEvent mRow; ///< The row buffer the branches point at
+    Long64_t mNRows; ///< Number of rows written
+    long mNTruncated; ///< Number of events with tracks dropped
+    std::mutex mMutex; ///< Serialises filling the tree
+};
+
+/** @class SlimTreeReader
+ *         Runs a group of analysers over slim tracker ntuples, rebuilding a MAUS recon event
+ *         from each row (see SlimEvent::MakeReconEvent). Suits analysers which use only the
+ *         Kalman tracks at the reference plane, the helical pattern recognition tracks and
+ *         the TOF1-TOF2 time-of-flight; others see events without the data they need.
+ *  @author A. Dobbs
+ */
+class SlimTreeReader {
+  public:
+    /** @brief Analyse every row of a chain of slim ntuple files
+     *  @return False if any of the files could not be read
+     */
+    static bool Run(const std::vector<std::string>& aFileNames, AnalyserGroup& aAnalysers);
+};
+} // ~namespace mica
+
+#endif
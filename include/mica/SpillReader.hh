@@ -0,0 +1,82 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef SPILLREADER_HH
+#define SPILLREADER_HH
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "src/common_cpp/DataStructure/Data.hh"
+#include "mica/BoundedQueue.hh"
+#include "mica/DataRequirements.hh"
+#include "mica/TimingStats.hh"
+
+namespace mica {
+
+/** @class SpillReader
+ *         Background reader stage for the event loop. A reader thread opens its own chain of
+ *         MAUS output files and deserialises spills ahead of the analysis into a bounded queue,
+ *         so that decompression and streaming of the next spills overlaps with the analysis of
+ *         the current one. The entries to read are requested one at a time from an EntrySource,
+ *         which may be shared with other readers.
+ *  @author A. Dobbs
+ */
+class SpillReader {
+  public:
+    /** Function returning the next tree entry to read, or a negative number when done */
+    typedef std::function<Long64_t()> EntrySource;
+
+    /** A deserialised spill, with the tree entry it was read from. Owns the MAUS data. */
+    typedef std::pair<Long64_t, std::unique_ptr<MAUS::Data>> Entry;
+
+    /** @brief Constructor, starts the reader thread
+     *  @param aFileNames The MAUS output ROOT files to read, chained in order
+     *  @param aDepth The maximum number of spills read ahead of the consumer
+     *  @param aSource Supplies the chain entries to read
+     *  @param aRequirements The parts of the spill to read, as DataRequirement flags
+     */
+    SpillReader(const std::vector<std::string>& aFileNames, size_t aDepth, EntrySource aSource,
+                unsigned int aRequirements = kAllData);
+
+    /** @brief Destructor, stops and joins the reader thread */
+    virtual ~SpillReader();
+
+    /** @brief Take the next spill from the queue, waiting for the reader if necessary
+     *  @param[out] aEntry The tree entry number and the spill data
+     *  @return False once every requested entry has been delivered
+     */
+    bool Next(Entry& aEntry) { return mQueue.Pop(aEntry); }
+
+    /** @brief Return the queue wait counters, how often the consumer stalled on the reader */
+    QueueStats GetStats() const { return mQueue.GetStats(); }
+
+    /** @brief Return the timing of the tree GetEntry calls (filled when TimingStats is enabled).
+     *         Only valid once Next has returned false.
+     */
+    const TimingStats& GetReadTiming() const { return mReadTiming; }
+
+  private:
+    SpillReader(const SpillReader&) = delete;
+    SpillReader& operator=(const SpillReader&) = delete;
+
+    /** @brief The reader thread routine, read entries until the source or queue is exhausted */
+    void read();
+
+    std::vector<std::string> mFileNames; ///< The MAUS output ROOT files to read
+    EntrySource mSource; ///< Supplies the tree entries to read
+    unsigned int mRequirements; ///< The parts of the spill to read, as DataRequirement flags
+    BoundedQueue<Entry> mQueue; ///< Spills read but not yet taken by the consumer
+    TimingStats mReadTiming; ///< Timing of the GetEntry calls, filled by the reader thread
+    std::thread mThread; ///< The reader thread
+};
+} // ~namespace mica
+
+#endif
@@ -0,0 +1,94 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef SPILLSCHEDULER_HH
+#define SPILLSCHEDULER_HH
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Rtypes.h"
+
+#include "src/common_cpp/DataStructure/Data.hh"
+
+namespace mica {
+
+/** @struct SpillTask
+ *          A unit of work for the event loop, a contiguous range of the recon events of a spill
+ *  @author A. Dobbs
+ */
+struct SpillTask {
+  std::shared_ptr<MAUS::Data> data; ///< The spill, shared by every task made from it
+  Long64_t entry = -1; ///< The chain entry the spill was read from
+  size_t first = 0; ///< The first recon event to analyse
+  size_t last = 0; ///< The recon event to stop before
+};
+
+/** @class SpillScheduler
+ *         Work-stealing task queues for the event loop workers. Each worker pushes the tasks
+ *         made from the spills it reads onto its own double ended queue and takes them back from
+ *         the same end. A worker with nothing left to do steals from the other end of another
+ *         worker's queue, so the events of a large spill are shared out rather than leaving the
+ *         other threads idle at the end of a job. A worker with nothing to steal sleeps in
+ *         Wait until a task is pushed, or Notify reports some other change of the work left.
+ *  @author A. Dobbs
+ */
+class SpillScheduler {
+  public:
+    /** @brief Constructor
+     *  @param aNWorkers The number of workers, each gets its own queue
+     */
+    explicit SpillScheduler(int aNWorkers);
+
+    virtual ~SpillScheduler() {}
+
+    /** @brief Return the number of workers */
+    int GetNWorkers() const { return static_cast<int>(mQueues.size()); }
+
+    /** @brief Add a task to a worker's own queue, waking any waiting workers */
+    void Push(int aWorker, SpillTask aTask);
+
+    /** @brief Take the most recently pushed task from a worker's own queue
+     *  @return False if the queue was empty
+     */
+    bool Pop(int aWorker, SpillTask& aTask);
+
+    /** @brief Take the oldest task from another worker's queue, trying each in turn
+     *  @return False if every other queue was empty
+     */
+    bool Steal(int aWorker, SpillTask& aTask);
+
+    /** @brief Return true if every queue is empty */
+    bool Empty() const;
+
+    /** @brief Return a counter of the changes to the work available (tasks pushed or Notify
+     *         calls), to be read before looking for work and passed to Wait if there was none
+     */
+    unsigned long GetVersion() const;
+
+    /** @brief Wait until the work available has changed since GetVersion returned aVersion */
+    void Wait(unsigned long aVersion) const;
+
+    /** @brief Wake the waiting workers, e.g. when a worker stops reading spills */
+    void Notify();
+
+  private:
+    /** Queue of tasks owned by one worker */
+    struct WorkerQueue {
+      mutable std::mutex mutex; ///< Guards the tasks
+      std::deque<SpillTask> tasks; ///< Tasks waiting to be analysed
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> mQueues; ///< One queue per worker
+    unsigned long mVersion; ///< Counter of the changes to the work available
+    mutable std::mutex mWaitMutex; ///< Guards the version
+    mutable std::condition_variable mWaitCV; ///< Signals a change of the version
+};
+} // ~namespace mica
+
+#endif
@@ -0,0 +1,64 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef STATEIO_HH
+#define STATEIO_HH
+
+#include <string>
+#include <vector>
+
+#include "Rtypes.h"
+#include "TDirectory.h"
+#include "TH1.h"
+
+namespace mica {
+
+/** @class StateIO
+ *         Helper functions used by analysers and cuts to save their state to, and restore it
+ *         from, a ROOT directory (e.g. for checkpointing). Histograms are stored under their own
+ *         names, so these must be unique within an analyser. Loading a histogram replaces the
+ *         contents of an existing one, leaving its pointer and settings untouched.
+ *  @author A. Dobbs
+ */
+class StateIO {
+  public:
+    /** @brief Write a copy of a histogram to a directory, keyed by the histogram name */
+    static bool Save(TDirectory* aDir, const TH1* aHist);
+
+    /** @brief Replace the contents of a histogram with those saved under its name
+     *  @return False if no matching histogram was found, in which case aHist is unchanged
+     */
+    static bool Load(TDirectory* aDir, TH1* aHist);
+
+    /** @brief Write copies of several histograms to a directory, keyed by their names */
+    static bool Save(TDirectory* aDir, const std::vector<TH1*>& aHists);
+
+    /** @brief Replace the contents of several histograms with those saved under their names */
+    static bool Load(TDirectory* aDir, const std::vector<TH1*>& aHists);
+
+    /** @brief Write a number to a directory under the given key */
+    static bool Save(TDirectory* aDir, const std::string& aKey, double aValue);
+    static bool Save(TDirectory* aDir, const std::string& aKey, int aValue);
+    static bool Save(TDirectory* aDir, const std::string& aKey, Long64_t aValue);
+
+    /** @brief Read a number saved under the given key
+     *  @return False if the key was not found, in which case aValue is unchanged
+     */
+    static bool Load(TDirectory* aDir, const std::string& aKey, double& aValue);
+    static bool Load(TDirectory* aDir, const std::string& aKey, int& aValue);
+    static bool Load(TDirectory* aDir, const std::string& aKey, Long64_t& aValue);
+    static bool Load(TDirectory* aDir, const std::string& aKey, bool& aValue);
+
+    /** @brief Write a list of numbers to a directory under the given key, as one binary object */
+    static bool Save(TDirectory* aDir, const std::string& aKey,
+                     const std::vector<Long64_t>& aValues);
+
+    /** @brief Read a list of numbers saved under the given key, replacing aValues
+     *  @return False if the key was not found, in which case aValues is unchanged
+     */
+    static bool Load(TDirectory* aDir, const std::string& aKey, std::vector<Long64_t>& aValues);
+};
+} // ~namespace mica
+
+#endif
@@ -0,0 +1,131 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef TIMINGSTATS_HH
+#define TIMINGSTATS_HH
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mica {
+
+/** @class TimingStats
+ *         Low overhead timing accumulator for one stage of the analysis (an analyser, its cuts,
+ *         or reading the input). Records the number of calls, how many passed, the total and
+ *         maximum wall time, and a latency histogram with one bin per power of two nanoseconds.
+ *         Collection is switched on and off for the whole programme with SetEnabled, and costs
+ *         nothing beyond a flag check when off. Each instance is meant to be filled by one
+ *         thread, per-thread instances are then summed with operator+=.
+ *  @author A. Dobbs
+ */
+class TimingStats {
+  public:
+    typedef std::chrono::steady_clock Clock;
+    static const int kNBuckets = 32; ///< Latency bins, bin i covers [2^i, 2^(i+1)) ns
+
+    TimingStats();
+
+    /** @brief Record one call
+     *  @param aSeconds The wall time taken
+     *  @param aPassed Did the call succeed (e.g. an event passing cuts)
+     */
+    void Record(double aSeconds, bool aPassed);
+
+    /** @brief Record one call which started at aStart and finished now */
+    void Record(Clock::time_point aStart, bool aPassed) {
+      Record(std::chrono::duration<double>(Clock::now() - aStart).count(), aPassed);
+    }
+
+    /** @brief Add the counts from another instance */
+    TimingStats& operator+=(const TimingStats& aOther);
+
+    /** @brief Return the number of calls recorded */
+    long GetCalls() const { return mCalls; }
+
+    /** @brief Return the number of calls recorded as passed */
+    long GetPassed() const { return mPassed; }
+
+    /** @brief Return the number of calls recorded as failed */
+    long GetFailed() const { return mCalls - mPassed; }
+
+    /** @brief Return the total wall time of all calls (s) */
+    double GetTotal() const { return mTotal; }
+
+    /** @brief Return the longest single call (s) */
+    double GetMax() const { return mMax; }
+
+    /** @brief Return the mean wall time per call (s) */
+    double GetMean() const { return mCalls > 0 ? mTotal / mCalls : 0.0; }
+
+    /** @brief Return an upper bound on a quantile of the call time from the latency bins (s)
+     *  @param aFraction The quantile, e.g. 0.99
+     */
+    double GetQuantile(double aFraction) const;
+
+    /** @brief Return the latency histogram */
+    const std::array<long, kNBuckets>& GetBuckets() const { return mBuckets; }
+
+    /** @brief Is timing collection switched on */
+    static bool IsEnabled() { return mEnabled.load(std::memory_order_relaxed); }
+
+    /** @brief Switch timing collection on or off, at any time */
+    static void SetEnabled(bool aEnabled) { mEnabled = aEnabled; }
+
+  private:
+    long mCalls; ///< Number of calls recorded
+    long mPassed; ///< Number of calls recorded as passed
+    double mTotal; ///< Total wall time (s)
+    double mMax; ///< Longest call (s)
+    std::array<long, kNBuckets> mBuckets; ///< Latency histogram, log2 of the time in ns
+    static std::atomic<bool> mEnabled; ///< Global collection switch
+};
+
+/** @class TimingReport
+ *         Collects the TimingStats of the analysers and input stages of a job, and reports them
+ *         ranked by the time taken, as a table or as JSON.
+ *  @author A. Dobbs
+ */
+class TimingReport {
+  public:
+    /** @brief Add an analyser
+     *  @param aName The analyser name
+     *  @param aAnalyse Timing of the analyse calls (events which passed the cuts)
+     *  @param aCuts Timing of the cuts (every event)
+     */
+    void AddAnalyser(const std::string& aName, const TimingStats& aAnalyse,
+                     const TimingStats& aCuts);
+
+    /** @brief Add a non-analyser stage, such as reading the input */
+    void AddStage(const std::string& aName, const TimingStats& aStats);
+
+    /** @brief Print a table of the stages then the analysers ranked by total time */
+    void Print(std::ostream& aOut) const;
+
+    /** @brief Write the report as JSON
+     *  @return False if the file could not be written
+     */
+    bool WriteJson(const std::string& aFileName) const;
+
+  private:
+    /** Timing for one analyser */
+    struct AnalyserTiming {
+      std::string name; ///< The analyser name
+      TimingStats analyse; ///< Timing of the analyse calls
+      TimingStats cuts; ///< Timing of the cuts
+    };
+
+    /** @brief Return the analysers sorted by decreasing total time */
+    std::vector<AnalyserTiming> ranked() const;
+
+    std::vector<AnalyserTiming> mAnalysers; ///< The analysers, in the order added
+    std::vector<std::pair<std::string, TimingStats>> mStages; ///< The other stages
+};
+} // ~namespace mica
+
+#endif
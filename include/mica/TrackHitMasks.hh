@@ -0,0 +1,170 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#ifndef TRACKHITMASKS_HH
+#define TRACKHITMASKS_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mica {
+
+/** @class TrackHitMasks
+ *         The tracker planes hit by each MC track of one tracker, kept as a 15 bit mask per track
+ *         id, bit (station - 1) * 3 + plane, in a flat open-addressing hash table. Replaces the
+ *         maps of maps otherwise built to count the stations and planes a track crossed: adding
+ *         a hit is one probe and an OR, and the reconstructibility query is a population count
+ *         per station. Clear keeps the table, so one object can be reused event after event.
+ *
+ *         Stations are numbered 1 to 5 and planes 0 to 2, as in MAUS; hits outside these are
+ *         ignored.
+ *  @author A. Dobbs
+ */
+class TrackHitMasks {
+  public:
+    static const int kNStations = 5; ///< The number of stations per tracker
+    static const int kNPlanes = 3; ///< The number of planes per station
+    typedef std::uint16_t Mask; ///< The planes hit by one track
+
+    /** One track and the planes it hit */
+    struct Entry {
+      int track_id; ///< The MC track id
+      Mask mask; ///< The planes hit
+    };
+
+    /** @brief Constructor
+     *  @param aNExpected The number of tracks expected, the table growing as needed beyond it
+     */
+    explicit TrackHitMasks(size_t aNExpected = 16) { reserve(aNExpected); }
+
+    /** @brief Return the bit of a station and plane, 0 if either is out of range */
+    static Mask GetBit(int aStation, int aPlane) {
+      if (aStation < 1 || aStation > kNStations || aPlane < 0 || aPlane >= kNPlanes) return 0;
+      return static_cast<Mask>(1u << ((aStation - 1) * kNPlanes + aPlane));
+    }
+
+    /** @brief Return the number of planes of a station set in a mask */
+    static int CountPlanes(Mask aMask, int aStation) {
+      return popcount((aMask >> ((aStation - 1) * kNPlanes)) & ((1u << kNPlanes) - 1));
+    }
+
+    /** @brief Return a mask with one bit per station, bit (station - 1), set for each station
+     *         with aNPlanes or more planes set in aMask
+     */
+    static unsigned int GetStationsHit(Mask aMask, int aNPlanes) {
+      if (aNPlanes < 1) aNPlanes = 1;
+      unsigned int result = 0;
+      for (int st = 1; st <= kNStations; ++st) {
+        if (CountPlanes(aMask, st) >= aNPlanes) result |= 1u << (st - 1);
+      }
+      return result;
+    }
+
+    /** @brief Return the number of stations with aNPlanes or more planes set in aMask */
+    static int CountStations(Mask aMask, int aNPlanes) {
+      return popcount(GetStationsHit(aMask, aNPlanes));
+    }
+
+    /** @brief Record a hit by a track in a station and plane */
+    void Add(int aTrackId, int aStation, int aPlane) {
+      Mask bit = GetBit(aStation, aPlane);
+      if (bit) mEntries[find_or_insert(aTrackId)].mask |= bit;
+    }
+
+    /** @brief Record hits by a track in the planes set in a mask, as from GetBit */
+    void AddBits(int aTrackId, Mask aBits) {
+      if (aBits) mEntries[find_or_insert(aTrackId)].mask |= aBits;
+    }
+
+    /** @brief Return the planes hit by a track, 0 if it hit none */
+    Mask Get(int aTrackId) const {
+      size_t slot = hash(aTrackId);
+      while (mSlots[slot] >= 0) {
+        if (mEntries[mSlots[slot]].track_id == aTrackId) return mEntries[mSlots[slot]].mask;
+        slot = (slot + 1) & (mSlots.size() - 1);
+      }
+      return 0;
+    }
+
+    /** @brief Return the tracks which hit at least one plane, in the order first seen */
+    const std::vector<Entry>& GetEntries() const { return mEntries; }
+
+    /** @brief Return the number of tracks which hit at least one plane */
+    size_t size() const { return mEntries.size(); }
+
+    /** @brief Forget every track, keeping the memory */
+    void Clear() {
+      // Empty only the slots in use, each entry being found along its probe sequence
+      for (size_t i = 0; i < mEntries.size(); ++i) {
+        size_t slot = hash(mEntries[i].track_id);
+        while (mSlots[slot] != static_cast<int>(i)) slot = (slot + 1) & (mSlots.size() - 1);
+        mSlots[slot] = -1;
+      }
+      mEntries.clear();
+    }
+
+  private:
+    /** @brief Return the number of bits set */
+    static int popcount(unsigned int aBits) {
+#ifdef __GNUC__
+      return __builtin_popcount(aBits);
+#else
+      int result = 0;
+      for (; aBits; aBits &= aBits - 1) ++result;
+      return result;
+#endif
+    }
+
+    /** @brief Size the table for aNTracks tracks, at most half full */
+    void reserve(size_t aNTracks) {
+      size_t nslots = 16;
+      while (nslots < 2 * aNTracks) nslots *= 2;
+      mSlots.assign(nslots, -1);
+      mEntries.reserve(aNTracks);
+    }
+
+    /** @brief Return the home slot of a track id (Fibonacci hashing, the high bits folded down
+     *         as the table size only keeps the low ones)
+     */
+    size_t hash(int aTrackId) const {
+      std::uint32_t h = static_cast<std::uint32_t>(aTrackId) * 2654435769u;
+      return (h ^ (h >> 16)) & (mSlots.size() - 1);
+    }
+
+    /** @brief Return the entry of a track id, adding an empty one if it is new */
+    size_t find_or_insert(int aTrackId) {
+      size_t slot = hash(aTrackId);
+      while (mSlots[slot] >= 0) {
+        if (mEntries[mSlots[slot]].track_id == aTrackId) return mSlots[slot];
+        slot = (slot + 1) & (mSlots.size() - 1);
+      }
+      if (2 * (mEntries.size() + 1) > mSlots.size()) {
+        rehash();
+        return find_or_insert(aTrackId);
+      }
+      Entry entry;
+      entry.track_id = aTrackId;
+      entry.mask = 0;
+      mSlots[slot] = static_cast<int>(mEntries.size());
+      mEntries.push_back(entry);
+      return mSlots[slot];
+    }
+
+    /** @brief Double the table and reinsert every entry */
+    void rehash() {
+      mSlots.assign(2 * mSlots.size(), -1);
+      for (size_t i = 0; i < mEntries.size(); ++i) {
+        size_t slot = hash(mEntries[i].track_id);
+        while (mSlots[slot] >= 0) slot = (slot + 1) & (mSlots.size() - 1);
+        mSlots[slot] = static_cast<int>(i);
+      }
+    }
+
+    std::vector<int> mSlots; ///< The hash table, the index of an entry or -1 if empty
+    std::vector<Entry> mEntries; ///< The tracks, in the order first seen
+};
+} // ~namespace mica
+
+#endif
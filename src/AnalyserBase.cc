@@ -2,13 +2,16 @@
  * Author: A. Dobbs
  */
 
+#include <algorithm>
+#include <string>
+
 #include "TCanvas.h"
 
 #include "mica/AnalyserBase.hh"
 
 namespace mica {
 
-AnalyserBase::AnalyserBase() {
+AnalyserBase::AnalyserBase() : mCutMask{0}, mPeakTransient{0} {
   mStyle = std::make_shared<TStyle>(*gStyle); // Make a style for this analyser
   // AddPad(std::shared_ptr<TVirtualPad>(new TCanvas())); // Have a default canvas ready
 }
@@ -17,21 +20,157 @@ AnalyserBase::~AnalyserBase() {
   // Do nothing (members are shared pointers which will take care of themselves)
 }
 
-bool AnalyserBase::ApplyCuts(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) {
-  for (auto cut : mCuts) {
-    bool result = cut->Cut(aReconEvent, aMCEvent);
+bool AnalyserBase::ApplyCuts(const EventContext& aContext) {
+  if (mCutMask != 0 && (!mCutRegistry || !mCutRegistry->Passes(mCutMask, aContext)))
+    return false;
+  if (mCuts.empty())
+    return true;
+
+  mCutFlow.Resize(mCuts.size());
+  bool timed = CutFlow::IsTimed();
+  bool result = true;
+  for (size_t i : mCutFlow.GetOrder()) {
+    TimingStats::Clock::time_point start;
+    if (timed) start = TimingStats::Clock::now();
+    result = mCuts[i]->Cut(aContext);
+    double time = timed ?
+        std::chrono::duration<double>(TimingStats::Clock::now() - start).count() : 0.0;
+    mCutFlow.Record(i, result, time);
     if (!result)
-      return false;
+      break;
   }
-  return true;
+  mCutFlow.EndEvaluation();
+  return result;
 }
 
 bool AnalyserBase::Analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) {
-  bool result = ApplyCuts(aReconEvent, aMCEvent);
+  return Analyse(EventContext(aReconEvent, aMCEvent));
+}
+
+bool AnalyserBase::Analyse(const EventContext& aContext) {
+  bool timed = TimingStats::IsEnabled();
+  bool has_cuts = HasCuts();
+
+  TimingStats::Clock::time_point start;
+  if (timed && has_cuts) start = TimingStats::Clock::now();
+  bool result = ApplyCuts(aContext);
+  if (timed && has_cuts) mCutTiming.Record(start, result);
   if (!result)
     return false;
 
-  return analyse(aReconEvent, aMCEvent);
+  if (timed) start = TimingStats::Clock::now();
+  result = tracked_analyse(aContext);
+  if (timed) mAnalyseTiming.Record(start, result);
+  return result;
+}
+
+int AnalyserBase::AnalyseSpill(const std::vector<const EventContext*>& aEvents) {
+  bool timed = TimingStats::IsEnabled();
+  bool timed_cuts = timed && HasCuts();
+
+  // Apply the cuts event by event
+  mSpillPassed.clear();
+  for (auto event : aEvents) {
+    TimingStats::Clock::time_point start;
+    if (timed_cuts) start = TimingStats::Clock::now();
+    bool result = ApplyCuts(*event);
+    if (timed_cuts) mCutTiming.Record(start, result);
+    if (result) mSpillPassed.push_back(event);
+  }
+  if (mSpillPassed.empty())
+    return 0;
+
+  // Analyse the events passing all at once, if the daughter class handles spills
+  TimingStats::Clock::time_point start;
+  if (timed) start = TimingStats::Clock::now();
+  int nanalysed = tracked_analyse_spill(mSpillPassed);
+  if (nanalysed >= 0) {
+    if (timed) {
+      double share = std::chrono::duration<double>(TimingStats::Clock::now() - start).count() /
+                     mSpillPassed.size();
+      for (size_t i = 0; i < mSpillPassed.size(); ++i) {
+        mAnalyseTiming.Record(share, static_cast<int>(i) < nanalysed);
+      }
+    }
+    return nanalysed;
+  }
+
+  // Otherwise one event at a time
+  nanalysed = 0;
+  for (auto event : mSpillPassed) {
+    if (timed) start = TimingStats::Clock::now();
+    bool result = tracked_analyse(*event);
+    if (timed) mAnalyseTiming.Record(start, result);
+    if (result) ++nanalysed;
+  }
+  return nanalysed;
+}
+
+bool AnalyserBase::tracked_analyse(const EventContext& aContext) {
+  if (!MemoryUsage::IsEnabled())
+    return analyse(aContext);
+
+  MemoryUsage::ResetThreadPeak();
+  long start = MemoryUsage::GetThreadLive();
+  bool result = analyse(aContext);
+  mPeakTransient = std::max(mPeakTransient, MemoryUsage::GetThreadPeak() - start);
+  return result;
+}
+
+int AnalyserBase::tracked_analyse_spill(const std::vector<const EventContext*>& aEvents) {
+  if (!MemoryUsage::IsEnabled())
+    return analyse_spill(aEvents);
+
+  MemoryUsage::ResetThreadPeak();
+  long start = MemoryUsage::GetThreadLive();
+  int result = analyse_spill(aEvents);
+  if (result >= 0)
+    mPeakTransient = std::max(mPeakTransient, MemoryUsage::GetThreadPeak() - start);
+  return result;
+}
+
+void AnalyserBase::MergeStats(const AnalyserBase& aAnalyser) {
+  mAnalyseTiming += aAnalyser.mAnalyseTiming;
+  mCutTiming += aAnalyser.mCutTiming;
+  mCutFlow += aAnalyser.mCutFlow;
+  mPeakTransient = std::max(mPeakTransient, aAnalyser.mPeakTransient);
+}
+
+bool AnalyserBase::Reset() {
+  mAnalyseTiming = TimingStats();
+  mCutTiming = TimingStats();
+  mCutFlow.Reset();
+  mPeakTransient = 0;
+  return reset();
+}
+
+bool AnalyserBase::Save(TDirectory* aDir) {
+  if (!aDir) return false;
+  bool result = save(aDir);
+  for (size_t i = 0; i < mCuts.size(); ++i) {
+    TDirectory* dir = aDir->mkdir(("cut" + std::to_string(i)).c_str());
+    if (!dir || !mCuts[i]->Save(dir) || !mCutFlow.Save(dir, i)) result = false;
+  }
+  return result;
+}
+
+bool AnalyserBase::Load(TDirectory* aDir) {
+  if (!aDir) return false;
+  bool result = load(aDir);
+  for (size_t i = 0; i < mCuts.size(); ++i) {
+    TDirectory* dir = aDir->GetDirectory(("cut" + std::to_string(i)).c_str());
+    if (!dir || !mCuts[i]->Load(dir) || !mCutFlow.Load(dir, i)) result = false;
+  }
+  return result;
+}
+
+unsigned int AnalyserBase::GetDataRequirements() const {
+  unsigned int result = data_requirements();
+  if (mCutMask != 0 && mCutRegistry) result |= mCutRegistry->GetDataRequirements(mCutMask);
+  for (auto cut : mCuts) {
+    result |= cut->GetDataRequirements();
+  }
+  return result;
 }
 
 std::shared_ptr<TVirtualPad> AnalyserBase::Draw() {
@@ -19,10 +19,11 @@
 #include "mica/AnalyserTrackerSpacePointSearch.hh"
 #include "mica/AnalyserTrackerSpacePointSearchStation.hh"
 #include "mica/AnalyserViewerRealSpace.hh"
+#include "mica/CutsTOFTime.hh"
 
 namespace mica {
 
-AnalyserBase* AnalyserFactory::CreateAnalyser(const std::string& aName) {
+AnalyserBase* AnalyserFactory::create(const std::string& aName) {
   if (aName == "AnalyserTofTracker") return new AnalyserTofTracker();
   if (aName == "AnalyserTrackerAngularMomentum") return new AnalyserTrackerAngularMomentum();
   if (aName == "AnalyserTrackerChannelHits") return new AnalyserTrackerChannelHits();
@@ -42,6 +43,17 @@ AnalyserBase* AnalyserFactory::CreateAnalyser(const std::string& aName) {
   return nullptr;
 }
 
+AnalyserBase* AnalyserFactory::CreateAnalyser(const std::string& aName) {
+  AnalyserBase* analyser = create(aName);
+  if (analyser) analyser->SetName(aName);
+  return analyser;
+}
+
+CutsBase* AnalyserFactory::CreateCut(const std::string& aName) {
+  if (aName == "CutsTOFTime") return new CutsTOFTime();
+  return nullptr;
+}
+
 std::vector<AnalyserBase*> AnalyserFactory::CreateAnalysers(const std::vector<std::string>& aNames) {
   std::vector<AnalyserBase*> analysers;
   for (auto s : aNames) {
@@ -58,6 +70,35 @@ AnalyserGroup AnalyserFactory::CreateAnalyserGroup(const std::vector<std::string
   return analysers;
 }
 
+AnalyserGroup AnalyserFactory::CreateDefaultAnalyserGroup() {
+  std::vector<std::string> analyser_names {"AnalyserTrackerChannelHits",
+                                           "AnalyserTrackerSpacePoints",
+                                           "AnalyserTrackerPRSeedResidual",
+                                           "AnalyserTrackerPRSeedNPEResidual",
+                                           "AnalyserTrackerPRStats",
+                                           "AnalyserTrackerAngularMomentum",
+                                           "AnalyserTrackerMCPRResiduals",
+                                           "AnalyserTrackerPREfficiency",
+                                           "AnalyserTrackerKFStats",
+                                           "AnalyserTrackerKFMomentum",
+                                           "AnalyserTofTracker"};
+  AnalyserGroup analysers = CreateAnalyserGroup(analyser_names);
+
+  // Customise a few specific analyser options
+  // Use a log scale for patrec seed residual plots
+  dynamic_cast<AnalyserTrackerPRSeedResidual*>(analysers[2])->setLogScale(true);
+  // Don't restrict efficiency calc to ideal events (false = ideal events only, true = non-ideal ok)
+  dynamic_cast<AnalyserTrackerPREfficiency*>(analysers[7])->SetAllowMultiHitStations(false);
+  // Only use the TOFs to define an expected good event, not tracker spacepoints
+  dynamic_cast<AnalyserTrackerPREfficiency*>(analysers[7])->SetCheckTkU(false);
+  dynamic_cast<AnalyserTrackerPREfficiency*>(analysers[7])->SetCheckTkD(false);
+
+  // Evaluate any cuts used by several analysers once per event
+  analysers.ShareCuts();
+
+  return analysers;
+}
+
 std::shared_ptr<AnalyserBase> AnalyserFactory::CreateSharedAnalyser(const std::string &aName) {
   return std::shared_ptr<AnalyserBase>(CreateAnalyser(aName));
 }
@@ -1,16 +1,53 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+
 #include "mica/AnalyserGroup.hh"
+#include "mica/Log.hh"
+#include "mica/MCTruth.hh"
 
 namespace mica {
 
 bool AnalyserGroup::Analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) {
+  return Analyse(EventContext(aReconEvent, aMCEvent));
+}
+
+bool AnalyserGroup::Analyse(const EventContext& aContext) {
   bool success = true;
-  for (auto an : mAnalysers) {
-    bool lSuccess = an->Analyse(aReconEvent, aMCEvent);
+  for (auto& an : mAnalysers) {
+    bool lSuccess = an->Analyse(aContext);
     if (!lSuccess) success = false;
   }
   return success;
 }
 
+bool AnalyserGroup::AnalyseSpill(const std::vector<const EventContext*>& aEvents) {
+  bool mc = std::any_of(aEvents.begin(), aEvents.end(),
+                        [](const EventContext* aEvent) { return aEvent->GetMCEvent(); });
+  if (!mc) return analyse_batch(aEvents);
+
+  // Each event holds its MC truths until released, so take a pool's worth of events at a time
+  bool success = true;
+  std::vector<const EventContext*> batch;
+  batch.reserve(MCTruth::kPoolSize);
+  for (size_t first = 0; first < aEvents.size(); first += MCTruth::kPoolSize) {
+    size_t last = std::min(aEvents.size(), first + MCTruth::kPoolSize);
+    batch.assign(aEvents.begin() + first, aEvents.begin() + last);
+    if (!analyse_batch(batch)) success = false;
+    for (auto event : batch) event->ReleaseMCTruths();
+  }
+  return success;
+}
+
+bool AnalyserGroup::analyse_batch(const std::vector<const EventContext*>& aEvents) {
+  bool success = true;
+  for (auto& an : mAnalysers) {
+    int nanalysed = an->AnalyseSpill(aEvents);
+    if (nanalysed != static_cast<int>(aEvents.size())) success = false;
+  }
+  return success;
+}
+
 // AnalyserGroup* AnalyserGroup::Clone() {
 //   AnalyserGroup* newGroup = new AnalyserGroup();
 //   for (auto an : mAnalysers) {
@@ -20,7 +57,7 @@ bool AnalyserGroup::Analyse(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent*
 
 std::vector<std::shared_ptr<TVirtualPad>> AnalyserGroup::Draw() {
   std::vector<std::shared_ptr<TVirtualPad>> pads;
-  for (auto an : mAnalysers) {
+  for (auto& an : mAnalysers) {
     an->Draw();
     auto new_pads = an->GetPads();
     pads.insert(std::end(pads), std::begin(new_pads), std::end(new_pads));
@@ -31,7 +68,7 @@ std::vector<std::shared_ptr<TVirtualPad>> AnalyserGroup::Draw() {
 void AnalyserGroup::MakePlots(const std::string& ofname) {
   std::vector<std::shared_ptr<TVirtualPad>> pads;
   std::vector<std::shared_ptr<TStyle> > styles;
-  for (auto an : mAnalysers) {
+  for (auto& an : mAnalysers) {
     an->Draw();
     for (auto pad : an->GetPads()) {
       if (pad) {
@@ -40,7 +77,7 @@ void AnalyserGroup::MakePlots(const std::string& ofname) {
       }
     }
   }
-  std::cout << "Found " << pads.size() << " canvases, saving to pdf." << std::endl;
+  MICA_LOG_INFO("Found " << pads.size() << " canvases, saving to pdf.");
   for (size_t i = 0; i < pads.size(); ++i) {
     if (styles[i]) styles[i]->cd();
     pads[i]->Update();
@@ -54,14 +91,128 @@ void AnalyserGroup::MakePlots(const std::string& ofname) {
   }
 }
 
+void AnalyserGroup::ShareCuts() {
+  for (auto& an : mAnalysers) {
+    std::vector<CutsBase*> own_cuts;
+    for (auto cut : an->GetCuts()) {
+      int index = mCutRegistry->ShareCut(cut);
+      if (index < 0) {
+        own_cuts.push_back(cut); // Registry full, keep the cut with the analyser
+      } else {
+        an->SubscribeCut(index);
+      }
+    }
+    an->SetCuts(own_cuts);
+  }
+}
+
+bool AnalyserGroup::HasCuts() const {
+  if (mCutRegistry->size() > 0) return true;
+  for (auto& an : mAnalysers) {
+    if (!an->GetCuts().empty()) return true;
+  }
+  return false;
+}
+
+void AnalyserGroup::PrintCutFlow(std::ostream& aOut) const {
+  aOut << "Cut flow (events seen, passed, efficiency, mean time per event)\n";
+  if (mCutRegistry->size() > 0) {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < mCutRegistry->size(); ++i) {
+      names.push_back(mCutRegistry->GetCut(i)->GetName());
+    }
+    aOut << "Group cuts\n";
+    mCutRegistry->GetCutFlow().Print(aOut, names, "  ");
+  }
+  for (size_t i = 0; i < mAnalysers.size(); ++i) {
+    const std::vector<CutsBase*>& cuts = mAnalysers[i]->GetCuts();
+    if (cuts.empty()) continue;
+    std::vector<std::string> names;
+    for (auto cut : cuts) names.push_back(cut->GetName());
+    std::string name = mAnalysers[i]->GetName();
+    aOut << (name.empty() ? "analyser" + std::to_string(i) : name) << "\n";
+    mAnalysers[i]->GetCutFlow().Print(aOut, names, "  ");
+  }
+}
+
+bool AnalyserGroup::Save(TDirectory* aDir) {
+  bool success = true;
+  if (mCutRegistry->size() > 0) {
+    TDirectory* dir = aDir->mkdir("cuts");
+    if (!dir || !mCutRegistry->Save(dir)) success = false;
+  }
+  for (size_t i = 0; i < mAnalysers.size(); ++i) {
+    TDirectory* dir = aDir->mkdir(("analyser" + std::to_string(i)).c_str());
+    if (!dir || !mAnalysers[i]->Save(dir)) success = false;
+  }
+  return success;
+}
+
+bool AnalyserGroup::Load(TDirectory* aDir) {
+  bool success = true;
+  if (mCutRegistry->size() > 0 && !mCutRegistry->Load(aDir->GetDirectory("cuts"))) {
+    success = false;
+  }
+  for (size_t i = 0; i < mAnalysers.size(); ++i) {
+    TDirectory* dir = aDir->GetDirectory(("analyser" + std::to_string(i)).c_str());
+    if (!dir || !mAnalysers[i]->Load(dir)) success = false;
+  }
+  return success;
+}
+
+TimingReport AnalyserGroup::GetTimingReport() const {
+  TimingReport report;
+  for (size_t i = 0; i < mAnalysers.size(); ++i) {
+    std::string name = mAnalysers[i]->GetName();
+    if (name.empty()) name = "analyser" + std::to_string(i);
+    report.AddAnalyser(name, mAnalysers[i]->GetAnalyseTiming(), mAnalysers[i]->GetCutTiming());
+  }
+  return report;
+}
+
+MemoryReport AnalyserGroup::GetMemoryReport() const {
+  MemoryReport report;
+  for (size_t i = 0; i < mAnalysers.size(); ++i) {
+    std::string name = mAnalysers[i]->GetName();
+    if (name.empty()) name = "analyser" + std::to_string(i);
+    report.AddAnalyser(name, mAnalysers[i]->GetMemoryUsage(), mAnalysers[i]->GetPeakTransient());
+  }
+  // The MC truth is built by the event context and shared by the MC analysers
+  if (MCTruth::GetPeakMemoryUsage() > 0) {
+    report.AddShared("MC truth", MCTruth::GetPeakMemoryUsage());
+  }
+  return report;
+}
+
+unsigned int AnalyserGroup::GetDataRequirements() const {
+  unsigned int result = kNoData;
+  for (auto& an : mAnalysers) {
+    result |= an->GetDataRequirements();
+  }
+  return result;
+}
+
 bool AnalyserGroup::Merge(AnalyserGroup* aAnalyserGroup) {
   if (mAnalysers.size() != aAnalyserGroup->size())
     return false;
 
+  if (aAnalyserGroup->mCutRegistry != mCutRegistry) {
+    mCutRegistry->MergeCutFlow(*aAnalyserGroup->mCutRegistry);
+  }
   bool success = true;
   for (size_t i = 0; i < mAnalysers.size(); ++i) {
     bool lSuccess = mAnalysers[i]->Merge((*aAnalyserGroup)[i]);
     if (!lSuccess) success = false;
+    mAnalysers[i]->MergeStats(*(*aAnalyserGroup)[i]);
+  }
+  return success;
+}
+
+bool AnalyserGroup::Reset() {
+  mCutRegistry->ResetCutFlow();
+  bool success = true;
+  for (auto analyser : mAnalysers) {
+    if (!analyser->Reset()) success = false;
   }
   return success;
 }
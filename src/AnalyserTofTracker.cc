@@ -3,6 +3,8 @@
  */
 
 #include "mica/AnalyserTofTracker.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 
 #include <algorithm>
 #include <cmath>
@@ -54,40 +56,24 @@ AnalyserTofTracker::AnalyserTofTracker() : mAnalysisStation{1},
   mHPzTkD->GetYaxis()->SetTitle("pz (MeV/c)");
 }
 
-bool AnalyserTofTracker::analyse(MAUS::ReconEvent* const aReconEvent,
-                                 MAUS::MCEvent* const aMCEvent) {
-  if (!aReconEvent) return false;
-  MAUS::SciFiEvent* sfevt = aReconEvent->GetSciFiEvent();
-  if (!sfevt) return false;
-  MAUS::TOFEvent* tofevt = aReconEvent->GetTOFEvent();
-  if (!tofevt) return false;
+bool AnalyserTofTracker::analyse(const EventContext& aContext) {
+  if (!aContext.GetSciFiEvent() || !aContext.GetTOFEvent()) return false;
 
   // Check and pull out the tof data
-  MAUS::TOFEventSpacePoint* tofevtsp = tofevt->GetTOFEventSpacePointPtr();
-  if (!tofevtsp) return false;
-  std::vector<MAUS::TOFSpacePoint> tof1sps = tofevtsp->GetTOF1SpacePointArray();
-  std::vector<MAUS::TOFSpacePoint> tof2sps = tofevtsp->GetTOF2SpacePointArray();
-  if (tof1sps.size() != 1 || tof2sps.size() != 1) return false;
-  double tof12 = tof2sps[0].GetTime() - tof1sps[0].GetTime();
-
-  // Check and pull out the tracker data
-  std::vector<MAUS::SciFiTrack*> trks = sfevt->scifitracks();
-  if (trks.size() != 2) return false;
-  std::vector<MAUS::SciFiTrack*> tku_trks;
-  std::vector<MAUS::SciFiTrack*> tkd_trks;
-  for (auto trk : trks) {
-    if (trk->tracker() == 0)
-      tku_trks.push_back(trk);
-    else if (trk->tracker() == 1)
-      tkd_trks.push_back(trk);
-  }
-  if (tku_trks.size() != 1 && tkd_trks.size() != 1) return false;
+  if (!aContext.HasTOF12()) return false;
+  double tof12 = aContext.GetTOF12();
+
+  // Check and pull out the tracker data, one track in each tracker
+  if (aContext.GetTracks().size() != 2) return false;
+  const std::vector<MAUS::SciFiTrack*>& tku_trks = aContext.GetTracks(0);
+  const std::vector<MAUS::SciFiTrack*>& tkd_trks = aContext.GetTracks(1);
+  if (tku_trks.size() != 1 || tkd_trks.size() != 1) return false;
 
   // Pull out the associated trackpoints, get the momentum
   MAUS::ThreeVector mom_tku;
   MAUS::ThreeVector mom_tkd;
-  bool tku_good = GetMomentum(tku_trks[0], mom_tku);
-  bool tkd_good = GetMomentum(tkd_trks[0], mom_tkd);
+  bool tku_good = GetMomentum(aContext, tku_trks[0], mom_tku);
+  bool tkd_good = GetMomentum(aContext, tkd_trks[0], mom_tkd);
 
 
   // Fill the histograms
@@ -132,17 +118,51 @@ void AnalyserTofTracker::update() {
   mHPzTkD->Draw("COLZ");
 }
 
-bool AnalyserTofTracker::GetMomentum(const MAUS::SciFiTrack* const trk, MAUS::ThreeVector& mom) {
-  MAUS::ThreeVector mom_out;
-  bool found = false;
-  for (auto tp : trk->scifitrackpoints()) {
-    if ((tp->station() == mAnalysisStation) && (tp->plane() == mAnalysisPlane)) {
-      mom_out = tp->mom();
-      found = true;
-    }
-  }
-  if (found) mom = mom_out;
-  return found;
+bool AnalyserTofTracker::GetMomentum(const EventContext& aContext,
+                                     const MAUS::SciFiTrack* const trk, MAUS::ThreeVector& mom) {
+  MAUS::SciFiTrackPoint* tp = aContext.GetTrackPoint(trk, mAnalysisStation, mAnalysisPlane);
+  if (!tp) return false;
+  mom = tp->mom();
+  return true;
+}
+
+void AnalyserTofTracker::merge(AnalyserTofTracker* aAnalyser) {
+  mHPTkU->Add(aAnalyser->mHPTkU.get());
+  mHPTkD->Add(aAnalyser->mHPTkD.get());
+  mHPtTkU->Add(aAnalyser->mHPtTkU.get());
+  mHPtTkD->Add(aAnalyser->mHPtTkD.get());
+  mHPzTkU->Add(aAnalyser->mHPzTkU.get());
+  mHPzTkD->Add(aAnalyser->mHPzTkD.get());
+}
+
+bool AnalyserTofTracker::reset() {
+  mHPTkU->Reset();
+  mHPTkD->Reset();
+  mHPtTkU->Reset();
+  mHPtTkD->Reset();
+  mHPzTkU->Reset();
+  mHPzTkD->Reset();
+  return true;
+}
+
+bool AnalyserTofTracker::save(TDirectory* aDir) {
+  bool result = StateIO::Save(aDir, {mHPTkU.get(), mHPTkD.get(), mHPtTkU.get(), mHPtTkD.get(),
+                                     mHPzTkU.get(), mHPzTkD.get()});
+  result = StateIO::Save(aDir, "AnalysisStation", mAnalysisStation) && result;
+  result = StateIO::Save(aDir, "AnalysisPlane", mAnalysisPlane) && result;
+  return result;
 }
 
+bool AnalyserTofTracker::load(TDirectory* aDir) {
+  bool result = StateIO::Load(aDir, {mHPTkU.get(), mHPTkD.get(), mHPtTkU.get(), mHPtTkD.get(),
+                                     mHPzTkU.get(), mHPzTkD.get()});
+  result = StateIO::Load(aDir, "AnalysisStation", mAnalysisStation) && result;
+  result = StateIO::Load(aDir, "AnalysisPlane", mAnalysisPlane) && result;
+  return result;
+}
+
+size_t AnalyserTofTracker::memory_usage() const {
+  return MemoryUsage::Of(mHPTkU) + MemoryUsage::Of(mHPTkD) + MemoryUsage::Of(mHPtTkU) +
+         MemoryUsage::Of(mHPtTkD) + MemoryUsage::Of(mHPzTkU) + MemoryUsage::Of(mHPzTkD);
+}
 } // ~namespace mica
@@ -5,6 +5,9 @@
 #include "TRef.h"
 
 #include "mica/AnalyserTrackerAngularMomentum.hh"
+#include "mica/Log.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 #include "src/common_cpp/DataStructure/SciFiTrackPoint.hh"
 #include "src/common_cpp/DataStructure/SciFiHelicalPRTrack.hh"
 
@@ -44,14 +47,13 @@ bool AnalyserTrackerAngularMomentum::analyse(MAUS::ReconEvent* const aReconEvent
     // Access the PR track from the SciFiSeed in order to extract the radius
     TObject* pr_track_obj = seed->getPRTrackTobject();
     if (!pr_track_obj) {
-      // std::cerr << "Empty PR track TObject pointer, skipping track" << std::endl;
+      MICA_LOG_TRACE("Empty PR track TObject pointer, skipping track");
       continue;
     }
     MAUS::SciFiHelicalPRTrack* htrk =
         dynamic_cast<MAUS::SciFiHelicalPRTrack*>(pr_track_obj); // NOLINT(runtime/rtti)
     if (!htrk) {
-      // std::cerr << "PR track dynamic cast failed, source pointer address "
-      //          << pr_track_obj << std::endl;
+      MICA_LOG_TRACE("PR track dynamic cast failed, source pointer address " << pr_track_obj);
       continue;
     }
     double radius = htrk->get_R();
@@ -92,20 +94,20 @@ bool AnalyserTrackerAngularMomentum::draw(std::shared_ptr<TVirtualPad> aPad) {
 MAUS::SciFiSeed* AnalyserTrackerAngularMomentum::ExtractSeed(MAUS::SciFiTrack* aTrack) const {
   MAUS::SciFiSeed* seed = aTrack->scifi_seed();
   if (!seed) {
-    // std::cerr << "Empty seed pointer at: " << seed << std::endl;
+    MICA_LOG_TRACE("Empty seed pointer at: " << seed);
   }
   TObject* seed_obj = aTrack->scifi_seed_tobject();
   if (!seed_obj) {
-    std::cerr << "Empty seed TObject pointer" << std::endl;
+    MICA_LOG_DEBUG("Empty seed TObject pointer");
   }
   if (!seed && !seed_obj) {
-    // std::cerr << "No seed pointer at all" << std::endl;
+    MICA_LOG_TRACE("No seed pointer at all");
     return NULL;
   }
   if (!seed && seed_obj) {
     seed = dynamic_cast<MAUS::SciFiSeed*>(seed_obj); // NOLINT(runtime/rtti)
     if (!seed) {
-      // std::cerr << "Dynamic cast from SciFiSeed TObject failed" << std::endl;
+      MICA_LOG_TRACE("Dynamic cast from SciFiSeed TObject failed");
       return NULL;
     }
   }
@@ -116,4 +118,28 @@ void AnalyserTrackerAngularMomentum::merge(AnalyserTrackerAngularMomentum* aAnal
   mHAngMomTKU->Add(aAnalyser->mHAngMomTKU);
   mHAngMomTKD->Add(aAnalyser->mHAngMomTKD);
 }
+
+bool AnalyserTrackerAngularMomentum::reset() {
+  mHAngMomTKU->Reset();
+  mHAngMomTKD->Reset();
+  return true;
+}
+
+bool AnalyserTrackerAngularMomentum::save(TDirectory* aDir) {
+  bool result = StateIO::Save(aDir, {mHAngMomTKU, mHAngMomTKD});
+  result = StateIO::Save(aDir, "AnalysisStation", mAnalysisStation) && result;
+  result = StateIO::Save(aDir, "AnalysisPlane", mAnalysisPlane) && result;
+  return result;
+}
+
+bool AnalyserTrackerAngularMomentum::load(TDirectory* aDir) {
+  bool result = StateIO::Load(aDir, {mHAngMomTKU, mHAngMomTKD});
+  result = StateIO::Load(aDir, "AnalysisStation", mAnalysisStation) && result;
+  result = StateIO::Load(aDir, "AnalysisPlane", mAnalysisPlane) && result;
+  return result;
+}
+
+size_t AnalyserTrackerAngularMomentum::memory_usage() const {
+  return MemoryUsage::Of(mHAngMomTKU) + MemoryUsage::Of(mHAngMomTKD);
+}
 } // ~namespace mica
@@ -4,6 +4,7 @@
 
 
 #include "mica/AnalyserTrackerChannelHits.hh"
+#include "mica/MemoryUsage.hh"
 
 #include "TCanvas.h"
 
@@ -12,39 +13,33 @@
 
 namespace mica {
 
-AnalyserTrackerChannelHits::AnalyserTrackerChannelHits() {
-  int nChannels = 214;
-  for (int iStation = 0; iStation < 5; ++iStation) {
-    for (int iPlane = 0; iPlane < 3; ++iPlane) {
-      std::string title = "Station " + std::to_string(iStation+1)
-                          + " Plane " + std::to_string(iPlane);
-      std::string name = "S" + std::to_string(iStation+1) + "P" + std::to_string(iPlane);
-
-      // Set up channel occupancy histograms
-      std::string tku_title_occ = "TkU Channel Occupancy " + title;
-      std::string tku_name_occ = "TkUOcc" + name;
-      std::string tkd_title_occ = "TkD Channel Occupancy " + title;
-      std::string tkd_name_occ = "TkDOcc" + name;
-      mTkU.emplace_back(new TH1I(tku_name_occ.c_str(), tku_title_occ.c_str(),
-                                 nChannels, 0, nChannels));
-      mTkD.emplace_back(new TH1I(tkd_name_occ.c_str(), tkd_title_occ.c_str(),
-                                 nChannels, 0, nChannels));
-      mTkU.back()->GetXaxis()->SetTitle("Channel Number");
-      mTkD.back()->GetXaxis()->SetTitle("Channel Number");
-
-      // Set up npe vs channel number plots
-      std::string tku_title_npe = "TkU Channel vs NPE " + title;
-      std::string tku_name_npe = "TkUNPE" + name;
-      std::string tkd_title_npe = "TkD Channel vs NPE " + title;
-      std::string tkd_name_npe = "TkDNPE" + name;
-      mNPETkU.emplace_back(new TH2D(tku_name_npe.c_str(), tku_title_npe.c_str(),
-                                    nChannels, 0, nChannels, 100, 0, 70));
-      mNPETkD.emplace_back(new TH2D(tkd_name_npe.c_str(), tkd_title_npe.c_str(),
-                                    nChannels, 0, nChannels, 100, 0, 70));
-      mNPETkU.back()->GetXaxis()->SetTitle("Channel Number");
-      mNPETkU.back()->GetYaxis()->SetTitle("NPE");
-      mNPETkD.back()->GetXaxis()->SetTitle("Channel Number");
-      mNPETkD.back()->GetYaxis()->SetTitle("NPE");
+namespace {
+const int kNTrackers = 2; ///< The number of trackers
+const int kNStations = 5; ///< The number of stations per tracker
+const int kNPlanes = 3; ///< The number of planes per station
+const int kNChannels = 214; ///< The number of channels per plane
+} // ~anonymous namespace
+
+AnalyserTrackerChannelHits::AnalyserTrackerChannelHits()
+    : mOccupancy{kNTrackers, kNStations, kNPlanes, FixedAxis(kNChannels, 0, kNChannels)},
+      mNPE{kNTrackers, kNStations, kNPlanes, FixedAxis(kNChannels, 0, kNChannels),
+           FixedAxis(100, 0, 70)} {
+  mOccupancy.SetAxisTitles("Channel Number");
+  mNPE.SetAxisTitles("Channel Number", "NPE");
+  for (int iTracker = 0; iTracker < kNTrackers; ++iTracker) {
+    std::string tracker = (iTracker == 0 ? "TkU" : "TkD");
+    for (int iStation = 1; iStation <= kNStations; ++iStation) {
+      for (int iPlane = 0; iPlane < kNPlanes; ++iPlane) {
+        std::string title = "Station " + std::to_string(iStation)
+                            + " Plane " + std::to_string(iPlane);
+        std::string name = "S" + std::to_string(iStation) + "P" + std::to_string(iPlane);
+
+        // Channel occupancy and npe vs channel number plots
+        mOccupancy.SetName(iTracker, iStation, iPlane, tracker + "Occ" + name,
+                           tracker + " Channel Occupancy " + title);
+        mNPE.SetName(iTracker, iStation, iPlane, tracker + "NPE" + name,
+                     tracker + " Channel vs NPE " + title);
+      }
     }
   }
 }
@@ -60,22 +55,19 @@ bool AnalyserTrackerChannelHits::analyse(MAUS::ReconEvent* const aReconEvent,
 
   // Populate the plots
   for (auto dig : sfevt->digits()) {
-    int index = 3*(dig->get_station()-1) + dig->get_plane();
-    if (dig->get_tracker() == 0) {
-      mTkU[index]->Fill(dig->get_channel());
-      mNPETkU[index]->Fill(dig->get_channel(), dig->get_npe());
-    } else if (dig->get_tracker() == 1) {
-      mTkD[index]->Fill(dig->get_channel());
-      mNPETkD[index]->Fill(dig->get_channel(), dig->get_npe());
-    }
+    int tracker = dig->get_tracker();
+    int station = dig->get_station();
+    int plane = dig->get_plane();
+    mOccupancy.Fill(tracker, station, plane, dig->get_channel());
+    mNPE.Fill(tracker, station, plane, dig->get_channel(), dig->get_npe());
   }
   return true;
 }
 
 bool AnalyserTrackerChannelHits::draw(std::shared_ptr<TVirtualPad> aPad) {
   GetStyle()->SetOptStat(111111);
-  int nStations = 5;
-  int nPlanes = 3;
+  int nStations = kNStations;
+  int nPlanes = kNPlanes;
 
   // Set up the pads
   std::vector<std::shared_ptr<TVirtualPad>> pads_occ;
@@ -87,20 +79,21 @@ bool AnalyserTrackerChannelHits::draw(std::shared_ptr<TVirtualPad> aPad) {
     pads_npe.push_back(std::shared_ptr<TVirtualPad>(new TCanvas()));
   }
 
-  // Draw the plots
+  // Draw the plots, TkU on the top row and TkD below, making the ROOT histograms as we go
+  mDrawn.clear();
   for (int iStation = 0; iStation < nStations; ++iStation) {
     pads_occ[iStation]->Divide(nPlanes, 2);
     pads_npe[iStation]->Divide(nPlanes, 2);
-    for (int iPlane = 0; iPlane < nPlanes; ++iPlane) {
-      pads_occ[iStation]->cd(iPlane+1);
-      int index = 3*iStation + iPlane;
-      mTkU[index]->Draw();
-      pads_npe[iStation]->cd(iPlane+1);
-      mNPETkU[index]->Draw("COLZ");
-      pads_occ[iStation]->cd(nPlanes + iPlane + 1);
-      mTkD[index]->Draw();
-      pads_npe[iStation]->cd(nPlanes + iPlane + 1);
-      mNPETkD[index]->Draw("COLZ");
+    for (int iTracker = 0; iTracker < kNTrackers; ++iTracker) {
+      for (int iPlane = 0; iPlane < nPlanes; ++iPlane) {
+        int iPad = iTracker*nPlanes + iPlane + 1;
+        pads_occ[iStation]->cd(iPad);
+        mDrawn.emplace_back(mOccupancy.Make(iTracker, iStation+1, iPlane));
+        mDrawn.back()->Draw();
+        pads_npe[iStation]->cd(iPad);
+        mDrawn.emplace_back(mNPE.Make(iTracker, iStation+1, iPlane));
+        mDrawn.back()->Draw("COLZ");
+      }
     }
   }
 
@@ -115,4 +108,28 @@ bool AnalyserTrackerChannelHits::draw(std::shared_ptr<TVirtualPad> aPad) {
   return true;
 }
 
+void AnalyserTrackerChannelHits::merge(AnalyserTrackerChannelHits* aAnalyser) {
+  mOccupancy.Merge(aAnalyser->mOccupancy);
+  mNPE.Merge(aAnalyser->mNPE);
+}
+
+bool AnalyserTrackerChannelHits::reset() {
+  mOccupancy.Reset();
+  mNPE.Reset();
+  return true;
+}
+
+bool AnalyserTrackerChannelHits::save(TDirectory* aDir) {
+  bool result = mOccupancy.Save(aDir);
+  return mNPE.Save(aDir) && result;
+}
+
+bool AnalyserTrackerChannelHits::load(TDirectory* aDir) {
+  bool result = mOccupancy.Load(aDir);
+  return mNPE.Load(aDir) && result;
+}
+
+size_t AnalyserTrackerChannelHits::memory_usage() const {
+  return mOccupancy.GetMemoryUsage() + mNPE.GetMemoryUsage() + MemoryUsage::Of(mDrawn);
+}
 } // ~namespace mica
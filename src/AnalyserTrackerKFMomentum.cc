@@ -3,6 +3,8 @@
  */
 
 #include "mica/AnalyserTrackerKFMomentum.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 
 #include <algorithm>
 #include <cmath>
@@ -39,30 +41,20 @@ AnalyserTrackerKFMomentum::AnalyserTrackerKFMomentum() : mAnalysisStation{1},
 
 }
 
-bool AnalyserTrackerKFMomentum::analyse(MAUS::ReconEvent* const aReconEvent,
-                                        MAUS::MCEvent* const aMCEvent) {
-  if (!aReconEvent) return false;
-  MAUS::SciFiEvent* sfevt = aReconEvent->GetSciFiEvent();
-  if (!sfevt) return false;
-
-  // Check and pull out the tracker data
-  std::vector<MAUS::SciFiTrack*> trks = sfevt->scifitracks();
-  if (trks.size() != 2) return false;
-  std::vector<MAUS::SciFiTrack*> tku_trks;
-  std::vector<MAUS::SciFiTrack*> tkd_trks;
-  for (auto trk : trks) {
-    if (trk->tracker() == 0)
-      tku_trks.push_back(trk);
-    else if (trk->tracker() == 1)
-      tkd_trks.push_back(trk);
-  }
-  if (tku_trks.size() != 1 && tkd_trks.size() != 1) return false;
+bool AnalyserTrackerKFMomentum::analyse(const EventContext& aContext) {
+  if (!aContext.GetSciFiEvent()) return false;
+
+  // Check and pull out the tracker data, one track in each tracker
+  if (aContext.GetTracks().size() != 2) return false;
+  const std::vector<MAUS::SciFiTrack*>& tku_trks = aContext.GetTracks(0);
+  const std::vector<MAUS::SciFiTrack*>& tkd_trks = aContext.GetTracks(1);
+  if (tku_trks.size() != 1 || tkd_trks.size() != 1) return false;
 
   // Pull out the associated trackpoints, get the momentum
   MAUS::ThreeVector mom_tku;
   MAUS::ThreeVector mom_tkd;
-  bool tku_good = GetMomentum(tku_trks[0], mom_tku);
-  bool tkd_good = GetMomentum(tkd_trks[0], mom_tkd);
+  bool tku_good = GetMomentum(aContext, tku_trks[0], mom_tku);
+  bool tkd_good = GetMomentum(aContext, tkd_trks[0], mom_tkd);
 
   // Fill the histograms
   if (tku_good && tkd_good) {
@@ -104,18 +96,42 @@ void AnalyserTrackerKFMomentum::update() {
   pads[1]->Update();
 }
 
-bool AnalyserTrackerKFMomentum::GetMomentum(const MAUS::SciFiTrack* const trk,
-                                            MAUS::ThreeVector& mom) {
-  MAUS::ThreeVector mom_out;
-  bool found = false;
-  for (auto tp : trk->scifitrackpoints()) {
-    if ((tp->station() == mAnalysisStation) && (tp->plane() == mAnalysisPlane)) {
-      mom_out = tp->mom();
-      found = true;
-    }
-  }
-  if (found) mom = mom_out;
-  return found;
+bool AnalyserTrackerKFMomentum::GetMomentum(const EventContext& aContext,
+                                            const MAUS::SciFiTrack* const trk, MAUS::ThreeVector& mom) {
+  MAUS::SciFiTrackPoint* tp = aContext.GetTrackPoint(trk, mAnalysisStation, mAnalysisPlane);
+  if (!tp) return false;
+  mom = tp->mom();
+  return true;
+}
+
+void AnalyserTrackerKFMomentum::merge(AnalyserTrackerKFMomentum* aAnalyser) {
+  mHPUSDS->Add(aAnalyser->mHPUSDS.get());
+  mHPtPzTkU->Add(aAnalyser->mHPtPzTkU.get());
+  mHPtPzTkD->Add(aAnalyser->mHPtPzTkD.get());
+}
+
+bool AnalyserTrackerKFMomentum::reset() {
+  mHPUSDS->Reset();
+  mHPtPzTkU->Reset();
+  mHPtPzTkD->Reset();
+  return true;
+}
+
+bool AnalyserTrackerKFMomentum::save(TDirectory* aDir) {
+  bool result = StateIO::Save(aDir, {mHPUSDS.get(), mHPtPzTkU.get(), mHPtPzTkD.get()});
+  result = StateIO::Save(aDir, "AnalysisStation", mAnalysisStation) && result;
+  result = StateIO::Save(aDir, "AnalysisPlane", mAnalysisPlane) && result;
+  return result;
 }
 
+bool AnalyserTrackerKFMomentum::load(TDirectory* aDir) {
+  bool result = StateIO::Load(aDir, {mHPUSDS.get(), mHPtPzTkU.get(), mHPtPzTkD.get()});
+  result = StateIO::Load(aDir, "AnalysisStation", mAnalysisStation) && result;
+  result = StateIO::Load(aDir, "AnalysisPlane", mAnalysisPlane) && result;
+  return result;
+}
+
+size_t AnalyserTrackerKFMomentum::memory_usage() const {
+  return MemoryUsage::Of(mHPUSDS) + MemoryUsage::Of(mHPtPzTkU) + MemoryUsage::Of(mHPtPzTkD);
+}
 } // ~namespace mica
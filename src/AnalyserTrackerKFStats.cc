@@ -3,6 +3,8 @@
  */
 
 #include "mica/AnalyserTrackerKFStats.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 #include "src/common_cpp/DataStructure/SciFiEvent.hh"
 #include "src/common_cpp/DataStructure/SciFiSpacePoint.hh"
 
@@ -58,4 +60,32 @@ bool AnalyserTrackerKFStats::draw(std::shared_ptr<TVirtualPad> aPad) {
 
   return true;
 }
+
+void AnalyserTrackerKFStats::merge(AnalyserTrackerKFStats* aAnalyser) {
+  mHChiSqTKU->Add(aAnalyser->mHChiSqTKU);
+  mHChiSqTKD->Add(aAnalyser->mHChiSqTKD);
+  mHPValueTKU->Add(aAnalyser->mHPValueTKU);
+  mHPValueTKD->Add(aAnalyser->mHPValueTKD);
+}
+
+bool AnalyserTrackerKFStats::reset() {
+  mHChiSqTKU->Reset();
+  mHChiSqTKD->Reset();
+  mHPValueTKU->Reset();
+  mHPValueTKD->Reset();
+  return true;
+}
+
+bool AnalyserTrackerKFStats::save(TDirectory* aDir) {
+  return StateIO::Save(aDir, {mHChiSqTKU, mHChiSqTKD, mHPValueTKU, mHPValueTKD});
+}
+
+bool AnalyserTrackerKFStats::load(TDirectory* aDir) {
+  return StateIO::Load(aDir, {mHChiSqTKU, mHChiSqTKD, mHPValueTKU, mHPValueTKD});
+}
+
+size_t AnalyserTrackerKFStats::memory_usage() const {
+  return MemoryUsage::Of(mHChiSqTKU) + MemoryUsage::Of(mHChiSqTKD) +
+         MemoryUsage::Of(mHPValueTKU) + MemoryUsage::Of(mHPValueTKD);
+}
 } // ~namespace mica
@@ -3,6 +3,8 @@
  */
 
 #include "mica/AnalyserTrackerMCPRResiduals.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 
 #include <cmath>
 
@@ -360,13 +362,98 @@ bool AnalyserTrackerMCPRResiduals::draw(std::shared_ptr<TVirtualPad> aPad) {
 }
 
 void AnalyserTrackerMCPRResiduals::merge(AnalyserTrackerMCPRResiduals* aAnalyser) {
+  mHTkUMCPositionX->Add(aAnalyser->mHTkUMCPositionX);
+  mHTkUMCPositionY->Add(aAnalyser->mHTkUMCPositionY);
+  mHTkUMCMomentumT->Add(aAnalyser->mHTkUMCMomentumT);
+  mHTkUMCMomentumZ->Add(aAnalyser->mHTkUMCMomentumZ);
+  mHTkURecPositionX->Add(aAnalyser->mHTkURecPositionX);
+  mHTkURecPositionY->Add(aAnalyser->mHTkURecPositionY);
+  mHTkURecMomentumT->Add(aAnalyser->mHTkURecMomentumT);
+  mHTkURecMomentumZ->Add(aAnalyser->mHTkURecMomentumZ);
   mHTkUPositionResidualsX->Add(aAnalyser->mHTkUPositionResidualsX);
   mHTkUPositionResidualsY->Add(aAnalyser->mHTkUPositionResidualsY);
   mHTkUMomentumResidualsT->Add(aAnalyser->mHTkUMomentumResidualsT);
   mHTkUMomentumResidualsZ->Add(aAnalyser->mHTkUMomentumResidualsZ);
+  mHTkUPtResPt->Add(aAnalyser->mHTkUPtResPt);
+  mHTkUPzResPt->Add(aAnalyser->mHTkUPzResPt);
+  mHTkUPtResPzRec->Add(aAnalyser->mHTkUPtResPzRec);
+  mHTkUPzResPzRec->Add(aAnalyser->mHTkUPzResPzRec);
+
+  mHTkDMCPositionX->Add(aAnalyser->mHTkDMCPositionX);
+  mHTkDMCPositionY->Add(aAnalyser->mHTkDMCPositionY);
+  mHTkDMCMomentumT->Add(aAnalyser->mHTkDMCMomentumT);
+  mHTkDMCMomentumZ->Add(aAnalyser->mHTkDMCMomentumZ);
+  mHTkDRecPositionX->Add(aAnalyser->mHTkDRecPositionX);
+  mHTkDRecPositionY->Add(aAnalyser->mHTkDRecPositionY);
+  mHTkDRecMomentumT->Add(aAnalyser->mHTkDRecMomentumT);
+  mHTkDRecMomentumZ->Add(aAnalyser->mHTkDRecMomentumZ);
   mHTkDPositionResidualsX->Add(aAnalyser->mHTkDPositionResidualsX);
   mHTkDPositionResidualsY->Add(aAnalyser->mHTkDPositionResidualsY);
   mHTkDMomentumResidualsT->Add(aAnalyser->mHTkDMomentumResidualsT);
   mHTkDMomentumResidualsZ->Add(aAnalyser->mHTkDMomentumResidualsZ);
+  mHTkDPtResPt->Add(aAnalyser->mHTkDPtResPt);
+  mHTkDPzResPt->Add(aAnalyser->mHTkDPzResPt);
+  mHTkDPtResPzRec->Add(aAnalyser->mHTkDPtResPzRec);
+  mHTkDPzResPzRec->Add(aAnalyser->mHTkDPzResPzRec);
+}
+
+bool AnalyserTrackerMCPRResiduals::reset() {
+  mHTkUMCPositionX->Reset();
+  mHTkUMCPositionY->Reset();
+  mHTkUMCMomentumT->Reset();
+  mHTkUMCMomentumZ->Reset();
+  mHTkURecPositionX->Reset();
+  mHTkURecPositionY->Reset();
+  mHTkURecMomentumT->Reset();
+  mHTkURecMomentumZ->Reset();
+  mHTkUPositionResidualsX->Reset();
+  mHTkUPositionResidualsY->Reset();
+  mHTkUMomentumResidualsT->Reset();
+  mHTkUMomentumResidualsZ->Reset();
+  mHTkUPtResPt->Reset();
+  mHTkUPzResPt->Reset();
+  mHTkUPtResPzRec->Reset();
+  mHTkUPzResPzRec->Reset();
+
+  mHTkDMCPositionX->Reset();
+  mHTkDMCPositionY->Reset();
+  mHTkDMCMomentumT->Reset();
+  mHTkDMCMomentumZ->Reset();
+  mHTkDRecPositionX->Reset();
+  mHTkDRecPositionY->Reset();
+  mHTkDRecMomentumT->Reset();
+  mHTkDRecMomentumZ->Reset();
+  mHTkDPositionResidualsX->Reset();
+  mHTkDPositionResidualsY->Reset();
+  mHTkDMomentumResidualsT->Reset();
+  mHTkDMomentumResidualsZ->Reset();
+  mHTkDPtResPt->Reset();
+  mHTkDPzResPt->Reset();
+  mHTkDPtResPzRec->Reset();
+  mHTkDPzResPzRec->Reset();
+  return true;
+}
+
+std::vector<TH1*> AnalyserTrackerMCPRResiduals::histograms() const {
+  return {mHTkUMCPositionX, mHTkUMCPositionY, mHTkUMCMomentumT, mHTkUMCMomentumZ, mHTkURecPositionX,
+          mHTkURecPositionY, mHTkURecMomentumT, mHTkURecMomentumZ, mHTkUPositionResidualsX,
+          mHTkUPositionResidualsY, mHTkUMomentumResidualsT, mHTkUMomentumResidualsZ, mHTkUPtResPt,
+          mHTkUPzResPt, mHTkUPtResPzRec, mHTkUPzResPzRec, mHTkDMCPositionX, mHTkDMCPositionY,
+          mHTkDMCMomentumT, mHTkDMCMomentumZ, mHTkDRecPositionX, mHTkDRecPositionY,
+          mHTkDRecMomentumT, mHTkDRecMomentumZ, mHTkDPositionResidualsX, mHTkDPositionResidualsY,
+          mHTkDMomentumResidualsT, mHTkDMomentumResidualsZ, mHTkDPtResPt, mHTkDPzResPt,
+          mHTkDPtResPzRec, mHTkDPzResPzRec};
+}
+
+bool AnalyserTrackerMCPRResiduals::save(TDirectory* aDir) {
+  return StateIO::Save(aDir, histograms());
+}
+
+bool AnalyserTrackerMCPRResiduals::load(TDirectory* aDir) {
+  return StateIO::Load(aDir, histograms());
+}
+
+size_t AnalyserTrackerMCPRResiduals::memory_usage() const {
+  return MemoryUsage::Of(histograms());
 }
 } // ~namespace mica
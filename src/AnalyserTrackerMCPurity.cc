@@ -2,9 +2,10 @@
  * Author: A. Dobbs
  */
 
-#include <map>
-
 #include "mica/AnalyserTrackerMCPurity.hh"
+#include "mica/Log.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 #include "TLatex.h"
 #include "src/common_cpp/DataStructure/SciFiEvent.hh"
 
@@ -15,19 +16,17 @@ AnalyserTrackerMCPurity::AnalyserTrackerMCPurity() : mHTracksMatched(nullptr) {
 }
 
 bool AnalyserTrackerMCPurity::analyse_recon(MAUS::ReconEvent* const aReconEvent) {
-  // std::cout << "Found " << GetMCDataTkU().size() << " TkU tracks & " << GetMCDataTkD().size() <<
-  //              " TkD tracks\n";
+  MICA_LOG_TRACE("Found " << GetMCDataTkU().size() << " TkU tracks & " << GetMCDataTkD().size()
+                 << " TkD tracks");
 
   // Loop over pattern recognition helical tracks
   MAUS::SciFiEvent* sfevt = aReconEvent->GetSciFiEvent();
   for (auto trk : sfevt->helicalprtracks()) {
     int track_id = find_mc_track_id(trk);
-    std::cout << "Found associated mc track id: " << track_id << std::endl;
+    MICA_LOG_DEBUG("Found associated mc track id: " << track_id);
     mHTracksMatched->Fill(track_id);
   }
 
-  clear_lookup();
-  clear_mc_data();
   return true;
 }
 
@@ -48,53 +47,68 @@ bool AnalyserTrackerMCPurity::draw(std::shared_ptr<TVirtualPad> aPad) {
 }
 
 int AnalyserTrackerMCPurity::find_mc_track_id(MAUS::SciFiBasePRTrack* trk) {
-  std::vector<MAUS::SciFiHit*> all_track_hits;
+  const MCTruth* truth = GetMCTruth();
+  MAUS::SciFiLookup* lookup = GetLookup();
   auto htrk = dynamic_cast<MAUS::SciFiHelicalPRTrack*>(trk); // NOLINT
-  if (htrk) std::cerr << "Tk" << htrk->get_tracker() << " ";
-  std::cerr << "Recon track at " << trk << " has " << trk->get_spacepoints_pointers().size()
-            << " seed spacepoints\n";
+  MICA_LOG_TRACE((htrk ? "Tk" + std::to_string(htrk->get_tracker()) + " " : "")
+                 << "Recon track at " << trk << " has "
+                 << trk->get_spacepoints_pointers().size() << " seed spacepoints");
+
+  // Collect the planes in which each MC track left hits, over all the digits of the track
+  mTrackPlanes.Clear();
+  int ndigits = 0;
   for (auto spnt : trk->get_spacepoints_pointers()) {
     for (auto clus : spnt->get_channels_pointers()) {
       for (auto dig : clus->get_digits_pointers()) {
-        // Perform the digits to hits lookup
-        std::vector<MAUS::SciFiHit*> hits;
-        bool lkup_result = GetLookup()->get_hits(dig, hits);
-        if (!lkup_result) {
-          std::cerr << "WARNING: AnalyserTrackerMCPurity: Lookup failed\n";
+        MCTruth::DigitTracks tracks = truth->GetDigitTracks(lookup->get_digit_id(dig));
+        if (tracks.empty()) {
+          MICA_LOG_WARNING("AnalyserTrackerMCPurity: Lookup failed");
           continue;
         }
-        std::cerr << "Adding " << hits.size() << " hits, ";
-        all_track_hits.insert(all_track_hits.end(), hits.begin(), hits.end());
-        std::cerr << "now have " << all_track_hits.size() << " in total\n";
+        ++ndigits;
+        for (const auto& track : tracks) mTrackPlanes.AddBits(track.track_id, track.plane);
       }
     }
   }
-  std::cerr << "Found " << all_track_hits.size() << " hits for this track\n";
+  MICA_LOG_TRACE("Found " << ndigits << " digits with MC hits for this track");
 
-  if (all_track_hits.size() == 0) return -1;
-
-  // Sort track's scifi hits into map from station # to a vector holding the hits for that station
-  std::map<int, std::vector<MAUS::SciFiHit*> > hit_map;
-  for (auto hit : all_track_hits) {
-    hit_map[hit->GetChannelId()->GetStationNumber()].push_back(hit);
-  }
+  if (ndigits == 0) return -1;
 
-  // Do we have 1 and only 1 mc_track_id which produced hits in >= 3 stations for this rec track
-  std::map<int, std::vector<int> > hit_stations = calc_stations_hit_by_track(hit_map, 2);
-  std::vector<int> reconstructible_mc_track_ids;
-  for (auto mctrack : hit_stations) {
-    std::cerr << " Track id " << mctrack.first << " hit " << mctrack.second.size() << " stations\n";
-    if (mctrack.second.size() >= 3) reconstructible_mc_track_ids.push_back(mctrack.first);
-  }
-  int mc_track_id = -1;
-  if (reconstructible_mc_track_ids.size() == 1) {
-    mc_track_id = reconstructible_mc_track_ids[0];
-  } else if (reconstructible_mc_track_ids.size() < 1) {
-    mc_track_id = -2;
-  } else if (reconstructible_mc_track_ids.size() > 1) {
-    mc_track_id = -3;
+  // Do we have 1 and only 1 mc_track_id which produced hits in 2 or more planes of 3 or more
+  // stations for this rec track
+  int nreconstructible = 0;
+  int mc_track_id = -2;
+  for (const auto& mctrack : mTrackPlanes.GetEntries()) {
+    int nstations = TrackHitMasks::CountStations(mctrack.mask, 2);
+    if (nstations == 0) continue;
+    MICA_LOG_TRACE(" Track id " << mctrack.track_id << " hit " << nstations << " stations");
+    if (nstations >= 3) {
+      ++nreconstructible;
+      mc_track_id = mctrack.track_id;
+    }
   }
+  if (nreconstructible > 1) mc_track_id = -3;
   return mc_track_id;
 }
 
+void AnalyserTrackerMCPurity::merge(AnalyserTrackerMCPurity* aAnalyser) {
+  mHTracksMatched->Add(aAnalyser->mHTracksMatched);
+}
+
+bool AnalyserTrackerMCPurity::reset() {
+  mHTracksMatched->Reset();
+  return true;
+}
+
+bool AnalyserTrackerMCPurity::save(TDirectory* aDir) {
+  return StateIO::Save(aDir, {mHTracksMatched});
+}
+
+bool AnalyserTrackerMCPurity::load(TDirectory* aDir) {
+  return StateIO::Load(aDir, {mHTracksMatched});
+}
+
+size_t AnalyserTrackerMCPurity::memory_usage() const {
+  return MemoryUsage::Of(mHTracksMatched);
+}
 } // ~namespace mica
@@ -9,6 +9,8 @@
 #include "TLatex.h"
 
 #include "mica/AnalyserTrackerPREfficiency.hh"
+#include "mica/Log.hh"
+#include "mica/StateIO.hh"
 #include "src/common_cpp/DataStructure/TOFEvent.hh"
 #include "src/common_cpp/DataStructure/SciFiEvent.hh"
 #include "src/common_cpp/DataStructure/SciFiBasePRTrack.hh"
@@ -39,16 +41,12 @@ AnalyserTrackerPREfficiency::~AnalyserTrackerPREfficiency() {
   // mOf1.close();
 }
 
-bool AnalyserTrackerPREfficiency::analyse(MAUS::ReconEvent* const aReconEvent,
-                                          MAUS::MCEvent* const aMCEvent) {
-  if (!aReconEvent)
+bool AnalyserTrackerPREfficiency::analyse(const EventContext& aContext) {
+  if (!aContext.GetReconEvent())
     return false;
 
   ++mNEvents;
 
-  MAUS::TOFEvent* tofevt = aReconEvent->GetTOFEvent();
-  MAUS::SciFiEvent* sfevt = aReconEvent->GetSciFiEvent();
-
   // Check if we a good expected track event in TkU and separately in TkD
   // --------------------------------------------------------------------
 
@@ -58,13 +56,13 @@ bool AnalyserTrackerPREfficiency::analyse(MAUS::ReconEvent* const aReconEvent,
   bool good_event_tkd = false;
 
   // Check TOF
-  bool good_tof = check_good_tof_event(tofevt);
+  bool good_tof = check_good_tof_event(aContext);
 
   // Check TkU, but don't don't look at recon tracks yet, only up to spacepoints
   bool good_tku_4pt = false; // Should reconstruct a 4pt, not enough sp for 5pt
   bool good_tku_5pt = false; // Should reconstrcut full 5pt
   if (mCheckTkU) {
-    check_good_tk_event(sfevt, 0, good_tku_4pt, good_tku_5pt);
+    check_good_tk_event(aContext, 0, good_tku_4pt, good_tku_5pt);
   } else {
     good_tku_4pt = true;
     good_tku_5pt = true;
@@ -80,7 +78,7 @@ bool AnalyserTrackerPREfficiency::analyse(MAUS::ReconEvent* const aReconEvent,
   bool good_tkd_4pt = false; // Should reconstruct a 4pt, not enough sp for 5pt
   bool good_tkd_5pt = false; // Should reconstrcut full 5pt
   if (mCheckTkD) {
-    check_good_tk_event(sfevt, 1, good_tkd_4pt, good_tkd_5pt);
+    check_good_tk_event(aContext, 1, good_tkd_4pt, good_tkd_5pt);
   } else {
     good_tkd_4pt = true;
     good_tkd_5pt = true;
@@ -99,26 +97,11 @@ bool AnalyserTrackerPREfficiency::analyse(MAUS::ReconEvent* const aReconEvent,
   // Check if patrec actually reconstructed the track as expected
   // ------------------------------------------------------------
 
-  // Sort by tracker
-  std::vector<MAUS::SciFiBasePRTrack*> tku;
-  std::vector<MAUS::SciFiBasePRTrack*> tkd;
-
-  std::vector<MAUS::SciFiHelicalPRTrack*> htrks = sfevt->helicalprtracks();
-  for (auto trk : htrks) {
-    if (trk->get_tracker() == 0) {
-      tku.push_back(trk);
-    } else {
-      tkd.push_back(trk);
-    }
-  }
-  std::vector<MAUS::SciFiStraightPRTrack*> strks = sfevt->straightprtracks();
-  for (auto trk : strks) {
-    if (trk->get_tracker() == 0) {
-      tku.push_back(trk);
-    } else {
-      tkd.push_back(trk);
-    }
-  }
+  // Tracks sorted by tracker
+  if (!aContext.GetSciFiEvent())
+    return true;
+  const std::vector<MAUS::SciFiBasePRTrack*>& tku = aContext.GetPRTracks(0);
+  const std::vector<MAUS::SciFiBasePRTrack*>& tkd = aContext.GetPRTracks(1);
 
   // If we have a good event and only one track, increment the counters
   if (good_event_tku && tku.size() == 1) {
@@ -136,6 +119,23 @@ bool AnalyserTrackerPREfficiency::analyse(MAUS::ReconEvent* const aReconEvent,
   return true;
 }
 
+bool AnalyserTrackerPREfficiency::IsGoodEvent(const EventContext& aContext) const {
+  if (!aContext.GetReconEvent() || !check_good_tof_event(aContext))
+    return false;
+
+  // As in analyse, a tracker is good if a full 5pt track is expected (or it is not checked)
+  bool good4pt = false;
+  bool good5pt = !mCheckTkU;
+  if (mCheckTkU)
+    check_good_tk_event(aContext, 0, good4pt, good5pt);
+  if (good5pt)
+    return true;
+  if (!mCheckTkD)
+    return true;
+  check_good_tk_event(aContext, 1, good4pt, good5pt);
+  return good5pt;
+}
+
 void AnalyserTrackerPREfficiency::clear() {
   mNEvents = 0;
   mTkUGoodEvents = 0;
@@ -146,21 +146,19 @@ void AnalyserTrackerPREfficiency::clear() {
   mTkD4to5ptTracks = 0;
 }
 
-void AnalyserTrackerPREfficiency::check_good_tk_event(MAUS::SciFiEvent* evt, int trker_num,
-                                                      bool& good4pt, bool& good5pt) {
+void AnalyserTrackerPREfficiency::check_good_tk_event(const EventContext& aContext,
+                                                      int trker_num, bool& good4pt,
+                                                      bool& good5pt) const {
   good4pt = false;
   good5pt = false;
 
-  if (!evt)
+  if (!aContext.GetSciFiEvent())
     return;
 
   // Check number of spacepoints per station meets cuts
   std::vector<int> num_spoints_per_station(5, 0); // length 5, all zeros
-
-  for (auto sp : evt->spacepoints()) {
-    if (sp->get_tracker() != trker_num)
-      continue;
-    ++(num_spoints_per_station.at(sp->get_station() - 1));
+  for (int station = 1; station <= 5; ++station) {
+    num_spoints_per_station[station - 1] = aContext.GetSpacePoints(trker_num, station).size();
   }
 
   int stations_empty = 0;  // num stations with less than 1 sp
@@ -195,29 +193,16 @@ void AnalyserTrackerPREfficiency::check_good_tk_event(MAUS::SciFiEvent* evt, int
   return;
 }
 
-bool AnalyserTrackerPREfficiency::check_good_tof_event(MAUS::TOFEvent* evt) {
+bool AnalyserTrackerPREfficiency::check_good_tof_event(const EventContext& aContext) const {
   // Do we care about TOF? If not return true
   if (!mCheckTOF && !mCheckTOFSpacePoints)
     return true;
 
-  // If we care about TOF but the data is missing, return false
-  if (!evt)
-    return false;
-  if (!evt->GetTOFEventSpacePointPtr())
-    return false;
-
-  // Check the TOF spacepoints - 1 and only 1 in TOF1 and 1 and only 1 in TOF2
+  // Check the TOF spacepoints - 1 and only 1 in TOF1 and 1 and only 1 in TOF2 (false also if
+  // the data is missing)
   // Note: If we are checking the actual time-of-flight we need this to be true, so we do not
   // need to mCheckTOFSpacePoints, as we already know one of our two flags must be true
-  std::vector<MAUS::TOFSpacePoint>*  tof1_spoints = \
-      evt->GetTOFEventSpacePointPtr()->GetTOF1SpacePointArrayPtr();
-  std::vector<MAUS::TOFSpacePoint>*  tof2_spoints = \
-      evt->GetTOFEventSpacePointPtr()->GetTOF2SpacePointArrayPtr();
-  if (!tof1_spoints || !tof2_spoints) {
-    return false;
-  }
-
-  if ((tof1_spoints->size() != 1) || (tof2_spoints->size() != 1))
+  if (!aContext.HasTOF12())
     return false;
 
   // OK, if we have reached this point, then the tof spacepoints criteria is satisfied,
@@ -226,7 +211,7 @@ bool AnalyserTrackerPREfficiency::check_good_tof_event(MAUS::TOFEvent* evt) {
     return true;
 
   // Lastly, check the time-of-flight between TOF1 and TOF2
-  double dt = tof2_spoints->at(0).GetTime() - tof1_spoints->at(0).GetTime();
+  double dt = aContext.GetTOF12();
   if (dt > mLowerTimeCut && dt < mUpperTimeCut)
     return true;
 
@@ -242,11 +227,11 @@ bool AnalyserTrackerPREfficiency::draw(std::shared_ptr<TVirtualPad> aPad) {
   double tkd_4to5pt_eff =
       static_cast<double>(mTkD4to5ptTracks) /  static_cast<double>(mTkDGoodEvents);
 
-  std::cerr << mNEvents << " "
-            << mTkU5ptTracks << " " << mTkU4to5ptTracks << " " << mTkUGoodEvents << " "
-            << mTkD5ptTracks << " " << mTkD4to5ptTracks << " " << mTkDGoodEvents << " "
-            << tku_5pt_eff << " " <<  tku_4to5pt_eff
-            <<  " " << tkd_5pt_eff <<  " " << tkd_4to5pt_eff << std::endl;
+  MICA_LOG_INFO(mNEvents << " "
+                << mTkU5ptTracks << " " << mTkU4to5ptTracks << " " << mTkUGoodEvents << " "
+                << mTkD5ptTracks << " " << mTkD4to5ptTracks << " " << mTkDGoodEvents << " "
+                << tku_5pt_eff << " " <<  tku_4to5pt_eff
+                <<  " " << tkd_5pt_eff <<  " " << tkd_4to5pt_eff);
 
   TLatex tl;
   tl.SetTextSize(0.05);
@@ -298,5 +283,58 @@ bool AnalyserTrackerPREfficiency::draw(std::shared_ptr<TVirtualPad> aPad) {
 
   return true;
 }
+
+void AnalyserTrackerPREfficiency::merge(AnalyserTrackerPREfficiency* aAnalyser) {
+  mNEvents += aAnalyser->mNEvents;
+  mTkUGoodEvents += aAnalyser->mTkUGoodEvents;
+  mTkU5ptTracks += aAnalyser->mTkU5ptTracks;
+  mTkU4to5ptTracks += aAnalyser->mTkU4to5ptTracks;
+  mTkDGoodEvents += aAnalyser->mTkDGoodEvents;
+  mTkD5ptTracks += aAnalyser->mTkD5ptTracks;
+  mTkD4to5ptTracks += aAnalyser->mTkD4to5ptTracks;
+}
+
+bool AnalyserTrackerPREfficiency::reset() {
+  clear();
+  return true;
+}
+
+bool AnalyserTrackerPREfficiency::save(TDirectory* aDir) {
+  bool result = true;
+  result = StateIO::Save(aDir, "CheckTOF", mCheckTOF) && result;
+  result = StateIO::Save(aDir, "CheckTOFSpacePoints", mCheckTOFSpacePoints) && result;
+  result = StateIO::Save(aDir, "AllowMultiHitStations", mAllowMultiHitStations) && result;
+  result = StateIO::Save(aDir, "CheckTkU", mCheckTkU) && result;
+  result = StateIO::Save(aDir, "CheckTkD", mCheckTkD) && result;
+  result = StateIO::Save(aDir, "LowerTimeCut", mLowerTimeCut) && result;
+  result = StateIO::Save(aDir, "UpperTimeCut", mUpperTimeCut) && result;
+  result = StateIO::Save(aDir, "NEvents", mNEvents) && result;
+  result = StateIO::Save(aDir, "TkUGoodEvents", mTkUGoodEvents) && result;
+  result = StateIO::Save(aDir, "TkU5ptTracks", mTkU5ptTracks) && result;
+  result = StateIO::Save(aDir, "TkU4to5ptTracks", mTkU4to5ptTracks) && result;
+  result = StateIO::Save(aDir, "TkDGoodEvents", mTkDGoodEvents) && result;
+  result = StateIO::Save(aDir, "TkD5ptTracks", mTkD5ptTracks) && result;
+  result = StateIO::Save(aDir, "TkD4to5ptTracks", mTkD4to5ptTracks) && result;
+  return result;
+}
+
+bool AnalyserTrackerPREfficiency::load(TDirectory* aDir) {
+  bool result = true;
+  result = StateIO::Load(aDir, "CheckTOF", mCheckTOF) && result;
+  result = StateIO::Load(aDir, "CheckTOFSpacePoints", mCheckTOFSpacePoints) && result;
+  result = StateIO::Load(aDir, "AllowMultiHitStations", mAllowMultiHitStations) && result;
+  result = StateIO::Load(aDir, "CheckTkU", mCheckTkU) && result;
+  result = StateIO::Load(aDir, "CheckTkD", mCheckTkD) && result;
+  result = StateIO::Load(aDir, "LowerTimeCut", mLowerTimeCut) && result;
+  result = StateIO::Load(aDir, "UpperTimeCut", mUpperTimeCut) && result;
+  result = StateIO::Load(aDir, "NEvents", mNEvents) && result;
+  result = StateIO::Load(aDir, "TkUGoodEvents", mTkUGoodEvents) && result;
+  result = StateIO::Load(aDir, "TkU5ptTracks", mTkU5ptTracks) && result;
+  result = StateIO::Load(aDir, "TkU4to5ptTracks", mTkU4to5ptTracks) && result;
+  result = StateIO::Load(aDir, "TkDGoodEvents", mTkDGoodEvents) && result;
+  result = StateIO::Load(aDir, "TkD5ptTracks", mTkD5ptTracks) && result;
+  result = StateIO::Load(aDir, "TkD4to5ptTracks", mTkD4to5ptTracks) && result;
+  return result;
+}
 } // ~namespace mica
 
@@ -3,6 +3,8 @@
  */
 
 #include "mica/AnalyserTrackerPRSeedNPEResidual.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 
 #include <string>
 
@@ -56,5 +58,38 @@ bool AnalyserTrackerPRSeedNPEResidual::draw(std::shared_ptr<TVirtualPad> aPad) {
   }
   return true;
 }
+
+void AnalyserTrackerPRSeedNPEResidual::merge(AnalyserTrackerPRSeedNPEResidual* aAnalyser) {
+  for (size_t i = 0; i < mHResidualsTkU.size(); ++i) {
+    mHResidualsTkU[i]->Add(aAnalyser->mHResidualsTkU[i]);
+    mHResidualsTkD[i]->Add(aAnalyser->mHResidualsTkD[i]);
+  }
+}
+
+bool AnalyserTrackerPRSeedNPEResidual::reset() {
+  for (size_t i = 0; i < mHResidualsTkU.size(); ++i) {
+    mHResidualsTkU[i]->Reset();
+    mHResidualsTkD[i]->Reset();
+  }
+  return true;
+}
+
+std::vector<TH1*> AnalyserTrackerPRSeedNPEResidual::histograms() const {
+  std::vector<TH1*> result(mHResidualsTkU.begin(), mHResidualsTkU.end());
+  result.insert(result.end(), mHResidualsTkD.begin(), mHResidualsTkD.end());
+  return result;
+}
+
+bool AnalyserTrackerPRSeedNPEResidual::save(TDirectory* aDir) {
+  return StateIO::Save(aDir, histograms());
+}
+
+bool AnalyserTrackerPRSeedNPEResidual::load(TDirectory* aDir) {
+  return StateIO::Load(aDir, histograms());
+}
+
+size_t AnalyserTrackerPRSeedNPEResidual::memory_usage() const {
+  return MemoryUsage::Of(mHResidualsTkU) + MemoryUsage::Of(mHResidualsTkD);
+}
 } // ~namespace mica
 
@@ -3,6 +3,8 @@
  */
 
 #include "mica/AnalyserTrackerPRSeedResidual.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 
 #include <string>
 
@@ -55,5 +57,42 @@ bool AnalyserTrackerPRSeedResidual::draw(std::shared_ptr<TVirtualPad> aPad) {
   }
   return true;
 }
+
+void AnalyserTrackerPRSeedResidual::merge(AnalyserTrackerPRSeedResidual* aAnalyser) {
+  for (size_t i = 0; i < mHResidualsTkU.size(); ++i) {
+    mHResidualsTkU[i]->Add(aAnalyser->mHResidualsTkU[i]);
+    mHResidualsTkD[i]->Add(aAnalyser->mHResidualsTkD[i]);
+  }
+}
+
+bool AnalyserTrackerPRSeedResidual::reset() {
+  for (size_t i = 0; i < mHResidualsTkU.size(); ++i) {
+    mHResidualsTkU[i]->Reset();
+    mHResidualsTkD[i]->Reset();
+  }
+  return true;
+}
+
+std::vector<TH1*> AnalyserTrackerPRSeedResidual::histograms() const {
+  std::vector<TH1*> result(mHResidualsTkU.begin(), mHResidualsTkU.end());
+  result.insert(result.end(), mHResidualsTkD.begin(), mHResidualsTkD.end());
+  return result;
+}
+
+bool AnalyserTrackerPRSeedResidual::save(TDirectory* aDir) {
+  bool result = StateIO::Save(aDir, histograms());
+  result = StateIO::Save(aDir, "LogScale", mLogScale) && result;
+  return result;
+}
+
+bool AnalyserTrackerPRSeedResidual::load(TDirectory* aDir) {
+  bool result = StateIO::Load(aDir, histograms());
+  result = StateIO::Load(aDir, "LogScale", mLogScale) && result;
+  return result;
+}
+
+size_t AnalyserTrackerPRSeedResidual::memory_usage() const {
+  return MemoryUsage::Of(mHResidualsTkU) + MemoryUsage::Of(mHResidualsTkD);
+}
 } // ~namespace mica
 
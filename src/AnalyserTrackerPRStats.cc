@@ -3,6 +3,8 @@
  */
 
 #include "mica/AnalyserTrackerPRStats.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 #include "src/common_cpp/DataStructure/SciFiEvent.hh"
 #include "src/common_cpp/DataStructure/SciFiSpacePoint.hh"
 
@@ -73,5 +75,33 @@ bool AnalyserTrackerPRStats::draw(std::shared_ptr<TVirtualPad> aPad) {
 
   return true;
 }
+
+void AnalyserTrackerPRStats::merge(AnalyserTrackerPRStats* aAnalyser) {
+  mHCircleChiSqTKU->Add(aAnalyser->mHCircleChiSqTKU);
+  mHCircleChiSqTKD->Add(aAnalyser->mHCircleChiSqTKD);
+  mHSZChiSqTKU->Add(aAnalyser->mHSZChiSqTKU);
+  mHSZChiSqTKD->Add(aAnalyser->mHSZChiSqTKD);
+}
+
+bool AnalyserTrackerPRStats::reset() {
+  mHCircleChiSqTKU->Reset();
+  mHCircleChiSqTKD->Reset();
+  mHSZChiSqTKU->Reset();
+  mHSZChiSqTKD->Reset();
+  return true;
+}
+
+bool AnalyserTrackerPRStats::save(TDirectory* aDir) {
+  return StateIO::Save(aDir, {mHCircleChiSqTKU, mHCircleChiSqTKD, mHSZChiSqTKU, mHSZChiSqTKD});
+}
+
+bool AnalyserTrackerPRStats::load(TDirectory* aDir) {
+  return StateIO::Load(aDir, {mHCircleChiSqTKU, mHCircleChiSqTKD, mHSZChiSqTKU, mHSZChiSqTKD});
+}
+
+size_t AnalyserTrackerPRStats::memory_usage() const {
+  return MemoryUsage::Of(mHCircleChiSqTKU) + MemoryUsage::Of(mHCircleChiSqTKD) +
+         MemoryUsage::Of(mHSZChiSqTKU) + MemoryUsage::Of(mHSZChiSqTKD);
+}
 } // ~namespace mica
 
@@ -3,6 +3,8 @@
  */
 
 #include "mica/AnalyserTrackerSpacePointSearch.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 
 namespace mica {
 
@@ -52,5 +54,28 @@ bool AnalyserTrackerSpacePointSearch::draw(std::shared_ptr<TVirtualPad> aPad) {
 
   return true;
 }
+
+void AnalyserTrackerSpacePointSearch::merge(AnalyserTrackerSpacePointSearch* aAnalyser) {
+  mHSeeds->Add(aAnalyser->mHSeeds);
+  mHAddOns->Add(aAnalyser->mHAddOns);
+}
+
+bool AnalyserTrackerSpacePointSearch::reset() {
+  mHSeeds->Reset();
+  mHAddOns->Reset();
+  return true;
+}
+
+bool AnalyserTrackerSpacePointSearch::save(TDirectory* aDir) {
+  return StateIO::Save(aDir, {mHSeeds, mHAddOns});
+}
+
+bool AnalyserTrackerSpacePointSearch::load(TDirectory* aDir) {
+  return StateIO::Load(aDir, {mHSeeds, mHAddOns});
+}
+
+size_t AnalyserTrackerSpacePointSearch::memory_usage() const {
+  return MemoryUsage::Of(mHSeeds) + MemoryUsage::Of(mHAddOns);
+}
 } // ~namespace mica
 
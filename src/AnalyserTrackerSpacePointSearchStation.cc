@@ -3,6 +3,8 @@
  */
 
 #include "mica/AnalyserTrackerSpacePointSearchStation.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 
 #include <string>
 
@@ -54,5 +56,39 @@ bool AnalyserTrackerSpacePointSearchStation::draw(std::shared_ptr<TVirtualPad> a
   }
   return true;
 }
+
+void AnalyserTrackerSpacePointSearchStation::merge(
+    AnalyserTrackerSpacePointSearchStation* aAnalyser) {
+  for (size_t i = 0; i < mHSeeds.size(); ++i) {
+    mHSeeds[i]->Add(aAnalyser->mHSeeds[i]);
+    mHAddOns[i]->Add(aAnalyser->mHAddOns[i]);
+  }
+}
+
+bool AnalyserTrackerSpacePointSearchStation::reset() {
+  for (size_t i = 0; i < mHSeeds.size(); ++i) {
+    mHSeeds[i]->Reset();
+    mHAddOns[i]->Reset();
+  }
+  return true;
+}
+
+std::vector<TH1*> AnalyserTrackerSpacePointSearchStation::histograms() const {
+  std::vector<TH1*> result(mHSeeds.begin(), mHSeeds.end());
+  result.insert(result.end(), mHAddOns.begin(), mHAddOns.end());
+  return result;
+}
+
+bool AnalyserTrackerSpacePointSearchStation::save(TDirectory* aDir) {
+  return StateIO::Save(aDir, histograms());
+}
+
+bool AnalyserTrackerSpacePointSearchStation::load(TDirectory* aDir) {
+  return StateIO::Load(aDir, histograms());
+}
+
+size_t AnalyserTrackerSpacePointSearchStation::memory_usage() const {
+  return MemoryUsage::Of(mHSeeds) + MemoryUsage::Of(mHAddOns);
+}
 } // ~namespace mica
 
@@ -3,6 +3,8 @@
  */
 
 #include "mica/AnalyserTrackerSpacePoints.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 
 #include "TCanvas.h"
 
@@ -11,12 +13,21 @@
 
 namespace mica {
 
+namespace {
+const FixedAxis kXYAxis(100, -200.0, 200.0); ///< The x and y binning of the per station plots
+} // ~anonymous namespace
+
 AnalyserTrackerSpacePoints::AnalyserTrackerSpacePoints() : mHNpeTKU{nullptr},
                                                            mHNpeTKD{nullptr},
                                                            mHStationNumTKU{nullptr},
                                                            mHStationNumTKD{nullptr},
                                                            mHXYTKU{nullptr},
-                                                           mHXYTKD{nullptr} {
+                                                           mHXYTKD{nullptr},
+                                                           mXYPerStation{2, 5, 1, kXYAxis, kXYAxis},
+                                                           mXYPerStationTriplets{2, 5, 1, kXYAxis,
+                                                                                 kXYAxis},
+                                                           mXYPerStationDoublets{2, 5, 1, kXYAxis,
+                                                                                 kXYAxis} {
   // Some parameters for the plots
   int nbins = 100;
   double xmax = 200.0;
@@ -50,48 +61,30 @@ AnalyserTrackerSpacePoints::AnalyserTrackerSpacePoints() : mHNpeTKU{nullptr},
   mHXYTKD->GetYaxis()->SetTitle(ylabel.c_str());
 
   // Initialise the x-y per station spacepoint plots (for all, triplets only, doublets only)
-  for (int iStation = 0; iStation < mNStations; ++iStation) {
-    std::string name = "S" + std::to_string(iStation+1);
-
-    std::string tku_title = "TkU Spacepoints XY " + name;
-    std::string tku_name = "hTkUXY" + name;
-    std::string tkd_title = "TkD Spacepoints XY " + name;
-    std::string tkd_name = "hTkDXY" + name;
-    mXYPerStationTkU.push_back(std::unique_ptr<TH2D>(new TH2D(tku_name.c_str(), tku_title.c_str(),
-        nbins, xmin, xmax, nbins, ymin, ymax)));
-    mXYPerStationTkD.push_back(std::unique_ptr<TH2D>(new TH2D(tkd_name.c_str(), tkd_title.c_str(),
-        nbins, xmin, xmax, nbins, ymin, ymax)));
-    mXYPerStationTkU[iStation]->GetXaxis()->SetTitle(xlabel.c_str());
-    mXYPerStationTkU[iStation]->GetYaxis()->SetTitle(ylabel.c_str());
-    mXYPerStationTkD[iStation]->GetXaxis()->SetTitle(xlabel.c_str());
-    mXYPerStationTkD[iStation]->GetYaxis()->SetTitle(ylabel.c_str());
-
-    std::string tku_tri_title = "TkU Triplet Spacepoints XY " + name;
-    std::string tku_tri_name = "hTkUXYTriplets" + name;
-    std::string tkd_tri_title = "TkD Triplet Spacepoints XY " + name;
-    std::string tkd_tri_name = "hTkDXYTriplets" + name;
-    mXYPerStationTripletsTkU.push_back(std::unique_ptr<TH2D>(new TH2D(tku_tri_name.c_str(),
-        tku_tri_title.c_str(), nbins, xmin, xmax, nbins, ymin, ymax)));
-    mXYPerStationTripletsTkD.push_back(std::unique_ptr<TH2D>(new TH2D(tkd_tri_name.c_str(),
-        tkd_tri_title.c_str(), nbins, xmin, xmax, nbins, ymin, ymax)));
-    mXYPerStationTripletsTkU[iStation]->GetXaxis()->SetTitle(xlabel.c_str());
-    mXYPerStationTripletsTkU[iStation]->GetYaxis()->SetTitle(ylabel.c_str());
-    mXYPerStationTripletsTkD[iStation]->GetXaxis()->SetTitle(xlabel.c_str());
-    mXYPerStationTripletsTkD[iStation]->GetYaxis()->SetTitle(ylabel.c_str());
-
-    std::string tku_dou_title = "TkU Doublet Spacepoints XY " + name;
-    std::string tku_dou_name = "hTkUXYDoublets" + name;
-    std::string tkd_dou_title = "TkD Doublets Spacepoints XY " + name;
-    std::string tkd_dou_name = "hTkDXYDoublets" + name;
-    mXYPerStationDoubletsTkU.push_back(std::unique_ptr<TH2D>(new TH2D(tku_dou_name.c_str(),
-        tku_dou_title.c_str(), nbins, xmin, xmax, nbins, ymin, ymax)));
-    mXYPerStationDoubletsTkD.push_back(std::unique_ptr<TH2D>(new TH2D(tkd_dou_name.c_str(),
-        tkd_dou_title.c_str(), nbins, xmin, xmax, nbins, ymin, ymax)));
-    mXYPerStationDoubletsTkU[iStation]->GetXaxis()->SetTitle(xlabel.c_str());
-    mXYPerStationDoubletsTkU[iStation]->GetYaxis()->SetTitle(ylabel.c_str());
-    mXYPerStationDoubletsTkD[iStation]->GetXaxis()->SetTitle(xlabel.c_str());
-    mXYPerStationDoubletsTkD[iStation]->GetYaxis()->SetTitle(ylabel.c_str());
+  mXYPerStation.SetAxisTitles(xlabel, ylabel);
+  mXYPerStationTriplets.SetAxisTitles(xlabel, ylabel);
+  mXYPerStationDoublets.SetAxisTitles(xlabel, ylabel);
+  for (int iStation = 1; iStation <= mNStations; ++iStation) {
+    std::string name = "S" + std::to_string(iStation);
+    mXYPerStation.SetName(0, iStation, 0, "hTkUXY" + name, "TkU Spacepoints XY " + name);
+    mXYPerStation.SetName(1, iStation, 0, "hTkDXY" + name, "TkD Spacepoints XY " + name);
+    mXYPerStationTriplets.SetName(0, iStation, 0, "hTkUXYTriplets" + name,
+                                  "TkU Triplet Spacepoints XY " + name);
+    mXYPerStationTriplets.SetName(1, iStation, 0, "hTkDXYTriplets" + name,
+                                  "TkD Triplet Spacepoints XY " + name);
+    mXYPerStationDoublets.SetName(0, iStation, 0, "hTkUXYDoublets" + name,
+                                  "TkU Doublet Spacepoints XY " + name);
+    mXYPerStationDoublets.SetName(1, iStation, 0, "hTkDXYDoublets" + name,
+                                  "TkD Doublets Spacepoints XY " + name);
   }
+
+  // Fill through buffers, which find the bins of many values at once
+  mFillNpeTKU = BufferedFill(mHNpeTKU.get());
+  mFillNpeTKD = BufferedFill(mHNpeTKD.get());
+  mFillStationNumTKU = BufferedFill(mHStationNumTKU.get());
+  mFillStationNumTKD = BufferedFill(mHStationNumTKD.get());
+  mFillXYTKU = BufferedFill2D(mHXYTKU.get());
+  mFillXYTKD = BufferedFill2D(mHXYTKD.get());
 }
 
 bool AnalyserTrackerSpacePoints::analyse(MAUS::ReconEvent* const aReconEvent,
@@ -103,39 +96,50 @@ bool AnalyserTrackerSpacePoints::analyse(MAUS::ReconEvent* const aReconEvent,
   if (!sfevt)
     return false;
 
-  // std::cerr << "Found " << sfevt->scifitracks().size() << " tracks" << std::endl;
-  for (auto sp : sfevt->spacepoints()) {
-    if (sp->get_tracker() == 0) {
-      mHNpeTKU->Fill(sp->get_npe());
-      mHStationNumTKU->Fill(sp->get_station());
-      mHXYTKU->Fill(sp->get_position().x(), sp->get_position().y());
-      mXYPerStationTkU[sp->get_station() - 1]->Fill(sp->get_position().x(), sp->get_position().y());
-      if (sp->get_channels_pointers().size() == 3) {
-        mXYPerStationTripletsTkU[sp->get_station() - 1]->Fill(sp->get_position().x(),
-                                                              sp->get_position().y());
-      } else if (sp->get_channels_pointers().size() == 2) {
-        mXYPerStationDoubletsTkU[sp->get_station() - 1]->Fill(sp->get_position().x(),
-                                                              sp->get_position().y());
-      }
+  fill(sfevt->spacepoints());
+  return true;
+}
+
+int AnalyserTrackerSpacePoints::analyse_spill(const std::vector<const EventContext*>& aEvents) {
+  // One call for the whole spill, using the spacepoints already gathered in each context
+  int nanalysed = 0;
+  for (auto event : aEvents) {
+    if (!event->GetSciFiEvent())
+      continue;
+    fill(event->GetSpacePoints());
+    ++nanalysed;
+  }
+  return nanalysed;
+}
+
+void AnalyserTrackerSpacePoints::fill(const std::vector<MAUS::SciFiSpacePoint*>& aSpacePoints) {
+  for (auto sp : aSpacePoints) {
+    double x = sp->get_position().x();
+    double y = sp->get_position().y();
+    int station = sp->get_station();
+    int tracker = (sp->get_tracker() == 0 ? 0 : 1);
+    size_t nchannels = sp->get_channels_pointers().size();
+    if (tracker == 0) {
+      mFillNpeTKU.Fill(sp->get_npe());
+      mFillStationNumTKU.Fill(station);
+      mFillXYTKU.Fill(x, y);
     } else {
-      mHNpeTKD->Fill(sp->get_npe());
-      mHStationNumTKD->Fill(sp->get_station());
-      mHXYTKD->Fill(sp->get_position().x(), sp->get_position().y());
-      mXYPerStationTkD[sp->get_station() - 1]->Fill(sp->get_position().x(), sp->get_position().y());
-      if (sp->get_channels_pointers().size() == 3) {
-        mXYPerStationTripletsTkD[sp->get_station() - 1]->Fill(sp->get_position().x(),
-                                                              sp->get_position().y());
-      } else if (sp->get_channels_pointers().size() == 2) {
-        mXYPerStationDoubletsTkD[sp->get_station() - 1]->Fill(sp->get_position().x(),
-                                                              sp->get_position().y());
-      }
+      mFillNpeTKD.Fill(sp->get_npe());
+      mFillStationNumTKD.Fill(station);
+      mFillXYTKD.Fill(x, y);
+    }
+    mXYPerStation.Fill(tracker, station, 0, x, y);
+    if (nchannels == 3) {
+      mXYPerStationTriplets.Fill(tracker, station, 0, x, y);
+    } else if (nchannels == 2) {
+      mXYPerStationDoublets.Fill(tracker, station, 0, x, y);
     }
   }
-
-  return true;
 }
 
 bool AnalyserTrackerSpacePoints::draw(std::shared_ptr<TVirtualPad> aPad) {
+  flush_fills();
+
   // Draw the general spacepoint information plots
   GetPads()[0]->Divide(3, 2);
   GetPads()[0]->cd(1);
@@ -159,19 +163,20 @@ bool AnalyserTrackerSpacePoints::draw(std::shared_ptr<TVirtualPad> aPad) {
   padXY->Divide(nStations, 2);
   padXYTriplets->Divide(nStations, 2);
   padXYDoublets->Divide(nStations, 2);
-  for (int iStation = 0; iStation < nStations; ++iStation) {
-    padXY->cd(iStation+1);
-    mXYPerStationTkU[iStation]->Draw("COLZ");
-    padXYTriplets->cd(iStation+1);
-    mXYPerStationTripletsTkU[iStation]->Draw("COLZ");
-    padXYDoublets->cd(iStation+1);
-    mXYPerStationDoubletsTkU[iStation]->Draw("COLZ");
-    padXY->cd(nStations+iStation+1);
-    mXYPerStationTkD[iStation]->Draw("COLZ");
-    padXYTriplets->cd(nStations+iStation+1);
-    mXYPerStationTripletsTkD[iStation]->Draw("COLZ");
-    padXYDoublets->cd(nStations+iStation+1);
-    mXYPerStationDoubletsTkD[iStation]->Draw("COLZ");
+  mDrawn.clear();
+  for (int iTracker = 0; iTracker < 2; ++iTracker) {
+    for (int iStation = 0; iStation < nStations; ++iStation) {
+      int iPad = iTracker*nStations + iStation + 1;
+      padXY->cd(iPad);
+      mDrawn.emplace_back(mXYPerStation.Make(iTracker, iStation+1, 0));
+      mDrawn.back()->Draw("COLZ");
+      padXYTriplets->cd(iPad);
+      mDrawn.emplace_back(mXYPerStationTriplets.Make(iTracker, iStation+1, 0));
+      mDrawn.back()->Draw("COLZ");
+      padXYDoublets->cd(iPad);
+      mDrawn.emplace_back(mXYPerStationDoublets.Make(iTracker, iStation+1, 0));
+      mDrawn.back()->Draw("COLZ");
+    }
   }
 
   // Add the pads
@@ -183,20 +188,73 @@ bool AnalyserTrackerSpacePoints::draw(std::shared_ptr<TVirtualPad> aPad) {
 }
 
 void AnalyserTrackerSpacePoints::merge(AnalyserTrackerSpacePoints* aAnalyser) {
+  flush_fills();
+  aAnalyser->flush_fills();
   mHNpeTKU->Add(aAnalyser->mHNpeTKU.get());
   mHNpeTKD->Add(aAnalyser->mHNpeTKD.get());
   mHStationNumTKU->Add(aAnalyser->mHStationNumTKU.get());
   mHStationNumTKD->Add(aAnalyser->mHStationNumTKD.get());
   mHXYTKU->Add(aAnalyser->mHXYTKU.get());
   mHXYTKD->Add(aAnalyser->mHXYTKD.get());
+  mXYPerStation.Merge(aAnalyser->mXYPerStation);
+  mXYPerStationTriplets.Merge(aAnalyser->mXYPerStationTriplets);
+  mXYPerStationDoublets.Merge(aAnalyser->mXYPerStationDoublets);
+}
 
-  for (int i = 0; i < mNStations; ++i) {
-    mXYPerStationTkU[i]->Add(aAnalyser->mXYPerStationTkU[i].get());
-    mXYPerStationTkD[i]->Add(aAnalyser->mXYPerStationTkD[i].get());
-    mXYPerStationTripletsTkU[i]->Add(aAnalyser->mXYPerStationTripletsTkU[i].get());
-    mXYPerStationTripletsTkD[i]->Add(aAnalyser->mXYPerStationTripletsTkD[i].get());
-    mXYPerStationDoubletsTkU[i]->Add(aAnalyser->mXYPerStationDoubletsTkU[i].get());
-    mXYPerStationDoubletsTkD[i]->Add(aAnalyser->mXYPerStationDoubletsTkD[i].get());
-  }
+bool AnalyserTrackerSpacePoints::reset() {
+  flush_fills();
+  mHNpeTKU->Reset();
+  mHNpeTKD->Reset();
+  mHStationNumTKU->Reset();
+  mHStationNumTKD->Reset();
+  mHXYTKU->Reset();
+  mHXYTKD->Reset();
+  mXYPerStation.Reset();
+  mXYPerStationTriplets.Reset();
+  mXYPerStationDoublets.Reset();
+  return true;
+}
+
+std::vector<TH1*> AnalyserTrackerSpacePoints::histograms() const {
+  std::vector<TH1*> result {mHNpeTKU.get(), mHNpeTKD.get(), mHStationNumTKU.get(),
+                            mHStationNumTKD.get(), mHXYTKU.get(), mHXYTKD.get()};
+  return result;
+}
+
+void AnalyserTrackerSpacePoints::flush_fills() {
+  mFillNpeTKU.Flush();
+  mFillNpeTKD.Flush();
+  mFillStationNumTKU.Flush();
+  mFillStationNumTKD.Flush();
+  mFillXYTKU.Flush();
+  mFillXYTKD.Flush();
+}
+
+bool AnalyserTrackerSpacePoints::save(TDirectory* aDir) {
+  flush_fills();
+  bool result = StateIO::Save(aDir, histograms());
+  result = mXYPerStation.Save(aDir) && result;
+  result = mXYPerStationTriplets.Save(aDir) && result;
+  return mXYPerStationDoublets.Save(aDir) && result;
+}
+
+bool AnalyserTrackerSpacePoints::load(TDirectory* aDir) {
+  flush_fills();
+  bool result = StateIO::Load(aDir, histograms());
+  result = mXYPerStation.Load(aDir) && result;
+  result = mXYPerStationTriplets.Load(aDir) && result;
+  return mXYPerStationDoublets.Load(aDir) && result;
+}
+
+size_t AnalyserTrackerSpacePoints::memory_usage() const {
+  size_t result = MemoryUsage::Of(histograms());
+  result += mXYPerStation.GetMemoryUsage();
+  result += mXYPerStationTriplets.GetMemoryUsage();
+  result += mXYPerStationDoublets.GetMemoryUsage();
+  result += MemoryUsage::Of(mDrawn);
+  result += mFillNpeTKU.GetMemoryUsage() + mFillNpeTKD.GetMemoryUsage();
+  result += mFillStationNumTKU.GetMemoryUsage() + mFillStationNumTKD.GetMemoryUsage();
+  result += mFillXYTKU.GetMemoryUsage() + mFillXYTKD.GetMemoryUsage();
+  return result;
 }
 } // ~namespace mica
@@ -3,10 +3,14 @@
  */
 
 #include "mica/AnalyserViewerRealSpace.hh"
+#include "mica/Log.hh"
+#include "mica/MemoryUsage.hh"
+#include "mica/StateIO.hh"
 
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
+#include <utility>
 
 #include "TRef.h"
 #include "TAxis.h"
@@ -19,10 +23,17 @@
 
 namespace mica {
 
-AnalyserViewerRealSpace::AnalyserViewerRealSpace() {
+AnalyserViewerRealSpace::AnalyserViewerRealSpace() : mSpillEntry{-1}, mEvent{-1} {
   // Do nothing
 }
 
+bool AnalyserViewerRealSpace::analyse(const EventContext& aContext) {
+  if (!analyse(aContext.GetReconEvent(), aContext.GetMCEvent())) return false;
+  mSpillEntry = aContext.GetSpillEntry();
+  mEvent = aContext.GetEvent();
+  return true;
+}
+
 bool AnalyserViewerRealSpace::analyse(MAUS::ReconEvent* const aReconEvent,
                                       MAUS::MCEvent* const aMCEvent) {
   // Populate position vectors from event spacepoints
@@ -214,18 +225,73 @@ void AnalyserViewerRealSpace::print_track_info(const MAUS::SciFiHelicalPRTrack*
   double rad = trk->get_R();
   double pt = rad * mRadToPt;
   double pz = pt / trk->get_dsdz();
-  std::cout << "Tracker " << trk->get_tracker() << + ", ";
-  std::cout << "Num points " << trk->get_num_points() << ", ";
-  std::cout << "Charge " << trk->get_charge() << ", ";
-  std::cout << "R = " << std::setprecision(4) << trk->get_R() << "mm, ";
-  std::cout << "X0 = " << std::setprecision(4) << trk->get_circle_x0() << "mm, ";
-  std::cout << "Y0 = " <<  std::setprecision(4) << trk->get_circle_y0() << "mm,\n";
-  std::cout << "dsdz " <<  std::setprecision(4) << trk->get_dsdz() << ", ";
-  std::cout << "pt = " <<  std::setprecision(4) << pt << "MeV/c, ";
-  std::cout << "pz = " <<  std::setprecision(4) << pz << "MeV/c, ";
-  std::cout << "xy_chi2 = " << std::setprecision(4) << trk->get_circle_chisq() << ", ";
-  std::cout << "sz_c = " << std::setprecision(4) << trk->get_line_sz_c() << ", ";
-  std::cout << "sz_chi2 = " << std::setprecision(4) << trk->get_line_sz_chisq() << "\n";
+  MICA_LOG_INFO("Tracker " << trk->get_tracker() << ", "
+                << "Num points " << trk->get_num_points() << ", "
+                << "Charge " << trk->get_charge() << ", " << std::setprecision(4)
+                << "R = " << trk->get_R() << "mm, "
+                << "X0 = " << trk->get_circle_x0() << "mm, "
+                << "Y0 = " << trk->get_circle_y0() << "mm,\n"
+                << "dsdz " << trk->get_dsdz() << ", "
+                << "pt = " << pt << "MeV/c, "
+                << "pz = " << pz << "MeV/c, "
+                << "xy_chi2 = " << trk->get_circle_chisq() << ", "
+                << "sz_c = " << trk->get_line_sz_c() << ", "
+                << "sz_chi2 = " << trk->get_line_sz_chisq());
 };
 
+void AnalyserViewerRealSpace::merge(AnalyserViewerRealSpace* aAnalyser) {
+  // The viewer holds only one event, so keep whichever of the two comes later in the input, as
+  // a single pass would have shown, or failing that the other's if this one has none
+  bool later = std::make_pair(aAnalyser->mSpillEntry, aAnalyser->mEvent) >
+               std::make_pair(mSpillEntry, mEvent);
+  bool empty = mXTkU.empty() && mXTkD.empty() && mHtrkXYTkU.empty() && mHtrkXYTkD.empty();
+  if (!later && !empty) return;
+  mSpillEntry = aAnalyser->mSpillEntry;
+  mEvent = aAnalyser->mEvent;
+  mXTkU = aAnalyser->mXTkU;
+  mYTkU = aAnalyser->mYTkU;
+  mZTkU = aAnalyser->mZTkU;
+  mXTkD = aAnalyser->mXTkD;
+  mYTkD = aAnalyser->mYTkD;
+  mZTkD = aAnalyser->mZTkD;
+  mHtrkXYTkU = aAnalyser->mHtrkXYTkU;
+  mHtrkZXTkU = aAnalyser->mHtrkZXTkU;
+  mHtrkZYTkU = aAnalyser->mHtrkZYTkU;
+  mHtrkXYTkD = aAnalyser->mHtrkXYTkD;
+  mHtrkZXTkD = aAnalyser->mHtrkZXTkD;
+  mHtrkZYTkD = aAnalyser->mHtrkZYTkD;
+}
+
+bool AnalyserViewerRealSpace::reset() {
+  clear_vectors();
+  mSpillEntry = -1;
+  mEvent = -1;
+  return true;
+}
+
+bool AnalyserViewerRealSpace::save(TDirectory* aDir) {
+  return StateIO::Save(aDir, "spill_entry", mSpillEntry) &&
+         StateIO::Save(aDir, "event", mEvent) &&
+         StateIO::Save(aDir, "n_spacepoints_tku", static_cast<int>(mXTkU.size())) &&
+         StateIO::Save(aDir, "n_spacepoints_tkd", static_cast<int>(mXTkD.size())) &&
+         StateIO::Save(aDir, "n_tracks_tku", static_cast<int>(mHtrkXYTkU.size())) &&
+         StateIO::Save(aDir, "n_tracks_tkd", static_cast<int>(mHtrkXYTkD.size()));
+}
+
+bool AnalyserViewerRealSpace::load(TDirectory* aDir) {
+  clear_vectors();
+  return StateIO::Load(aDir, "spill_entry", mSpillEntry) && StateIO::Load(aDir, "event", mEvent);
+}
+
+size_t AnalyserViewerRealSpace::memory_usage() const {
+  size_t result = MemoryUsage::OfElements(mXTkU) + MemoryUsage::OfElements(mYTkU) +
+                  MemoryUsage::OfElements(mZTkU) + MemoryUsage::OfElements(mXTkD) +
+                  MemoryUsage::OfElements(mYTkD) + MemoryUsage::OfElements(mZTkD);
+  result += MemoryUsage::OfElements(mHtrkXYTkU) + MemoryUsage::OfElements(mHtrkZXTkU) +
+            MemoryUsage::OfElements(mHtrkZYTkU) + MemoryUsage::OfElements(mHtrkXYTkD) +
+            MemoryUsage::OfElements(mHtrkZXTkD) + MemoryUsage::OfElements(mHtrkZYTkD);
+  result += MemoryUsage::Of(mGrXYTkU) + MemoryUsage::Of(mGrXYTkD) + MemoryUsage::Of(mGrZXTkU) +
+            MemoryUsage::Of(mGrZXTkD) + MemoryUsage::Of(mGrZYTkU) + MemoryUsage::Of(mGrZYTkD);
+  return result;
+}
 } // ~namespace mica
@@ -0,0 +1,141 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/BatchRunner.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "TROOT.h"
+#include "TSystem.h"
+
+#include "mica/Log.hh"
+
+namespace mica {
+
+BatchRunner::BatchRunner(EventLoop::GroupMaker aMaker) : mMaker{aMaker},
+                                                         mNWorkers{1},
+                                                         mNextJob{0},
+                                                         mFailures{0} {
+  // Do nothing
+}
+
+void BatchRunner::AddRun(const std::string& aLabel, const std::vector<std::string>& aFileNames) {
+  for (auto& run : mRuns) {
+    if (run->label == aLabel) {
+      run->files.insert(run->files.end(), aFileNames.begin(), aFileNames.end());
+      return;
+    }
+  }
+  std::unique_ptr<BatchRun> run(new BatchRun());
+  run->label = aLabel;
+  run->files = aFileNames;
+  mRuns.push_back(std::move(run));
+}
+
+bool BatchRunner::ReadRunList(const std::string& aFileName) {
+  std::ifstream list(aFileName);
+  if (!list) {
+    MICA_LOG_ERROR("Failed to open run list: " << aFileName);
+    return false;
+  }
+  std::string line;
+  while (std::getline(list, line)) {
+    std::istringstream tokens(line);
+    std::string label;
+    if (!(tokens >> label) || label[0] == '#') continue;
+    std::vector<std::string> files;
+    std::string file;
+    while (tokens >> file) files.push_back(file);
+    if (files.empty()) {
+      MICA_LOG_WARNING("BatchRunner: No files listed for run " << label);
+      continue;
+    }
+    AddRun(label, files);
+  }
+  return true;
+}
+
+bool BatchRunner::Run() {
+  if (mRuns.empty() || !mMaker) return false;
+
+  // One job per file, largest first, so the small files fill in the gaps at the end
+  mJobs.clear();
+  for (size_t i = 0; i < mRuns.size(); ++i) {
+    mRuns[i]->analysers = mMaker();
+    mRuns[i]->nmerged = 0;
+    for (const auto& fname : mRuns[i]->files) {
+      FileStat_t stat;
+      Long64_t size = gSystem->GetPathInfo(fname.c_str(), stat) == 0 ? stat.fSize : 0;
+      mJobs.push_back(FileJob{i, fname, size});
+    }
+  }
+  std::stable_sort(mJobs.begin(), mJobs.end(),
+                   [](const FileJob& a, const FileJob& b) { return a.size > b.size; });
+  MICA_LOG_INFO("Analysing " << mJobs.size() << " files from " << mRuns.size() << " runs");
+
+  // Share the jobs out over the workers
+  mNextJob = 0;
+  mFailures = 0;
+  int nworkers = std::max(1, std::min(mNWorkers, static_cast<int>(mJobs.size())));
+  if (nworkers > 1) {
+    ROOT::EnableThreadSafety();
+    std::vector<std::thread> workers;
+    for (int i = 0; i < nworkers; ++i) {
+      workers.emplace_back(&BatchRunner::work, this);
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  } else {
+    work();
+  }
+
+  // Combine the runs
+  mCombined = mMaker();
+  bool merged = true;
+  for (auto& run : mRuns) {
+    if (run->nmerged > 0 && !mCombined.Merge(&run->analysers)) merged = false;
+  }
+  if (!merged) {
+    MICA_LOG_WARNING("BatchRunner: Not all analysers support merging, combined and "
+                     << "multi-file run results are incomplete");
+  }
+  if (mFailures > 0) {
+    MICA_LOG_WARNING("BatchRunner: " << mFailures << " files could not be analysed");
+  }
+  return mFailures == 0;
+}
+
+void BatchRunner::work() {
+  for (size_t i = mNextJob++; i < mJobs.size(); i = mNextJob++) {
+    MICA_LOG_INFO("Analysing run " << mRuns[mJobs[i].run]->label << " file " << mJobs[i].file
+                  << ", job " << i + 1 << " of " << mJobs.size());
+    if (!analyse_job(mJobs[i])) ++mFailures;
+  }
+}
+
+bool BatchRunner::analyse_job(const FileJob& aJob) {
+  AnalyserGroup analysers;
+  {
+    std::lock_guard<std::mutex> lock(mMakerMutex);
+    analysers = mMaker();
+  }
+
+  EventLoop loop;
+  if (!loop.Run(aJob.file, analysers)) return false;
+
+  BatchRun& run = *mRuns[aJob.run];
+  std::lock_guard<std::mutex> lock(run.mutex);
+  if (!run.analysers.Merge(&analysers)) {
+    MICA_LOG_WARNING("BatchRunner: Not all analysers support merging, results for run "
+                     << run.label << " are incomplete");
+  }
+  ++run.nmerged;
+  return true;
+}
+} // ~namespace mica
@@ -0,0 +1,184 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/BufferedFill.hh"
+
+#include "TArrayD.h"
+#include "TAxis.h"
+
+namespace mica {
+
+namespace {
+
+/** Can the bins of an axis be found arithmetically, as TAxis::FindBin would without extending */
+bool is_uniform(const TAxis* aAxis) {
+  return !aAxis->IsVariableBinSize() && !aAxis->CanExtend() &&
+         !aAxis->TestBit(TAxis::kAxisRange);
+}
+
+/** Can a histogram be filled a block at a time, and if so get its statistics */
+bool can_fill_blocks(TH1* aHist, double* aStats) {
+  if (aHist->GetBufferSize() != 0 || !is_uniform(aHist->GetXaxis()) ||
+      (aHist->GetDimension() > 1 && !is_uniform(aHist->GetYaxis()))) {
+    return false;
+  }
+  // GetStats works the sums out again from the bin contents if the sum of weights is zero with
+  // entries present (e.g. weights cancelling), which TH1::Fill never does, so such a histogram
+  // is filled value by value until the sum of weights is non-zero again
+  aHist->GetStats(aStats);
+  return aStats[0] != 0.0 || aHist->GetEntries() == 0.0;
+}
+
+/** Work out the bin number of each value, as TAxis::FindFixBin: 0 below the axis, n + 1 at or
+ *  above its top (and for NaN). Written without branches so the compiler can vectorise it.
+ */
+void find_bins(const TAxis* aAxis, const double* aX, size_t aN, int* aBins) {
+  const int nbins = aAxis->GetNbins();
+  const double low = aAxis->GetXmin();
+  const double up = aAxis->GetXmax();
+  const double width = up - low;
+  for (size_t i = 0; i < aN; ++i) {
+    double t = nbins * (aX[i] - low) / width;
+    t = aX[i] < low ? -1.0 : t;
+    t = aX[i] < up ? t : nbins;
+    aBins[i] = 1 + static_cast<int>(t);
+  }
+}
+
+/** Switch on the per-bin errors if TH1::Fill would for one of the weights */
+void check_sumw2(TH1* aHist, const std::vector<double>& aW) {
+  if (aHist->GetSumw2N() > 0 || aHist->TestBit(TH1::kIsNotW)) return;
+  for (double w : aW) {
+    if (w != 1.0) {
+      aHist->Sumw2();
+      return;
+    }
+  }
+}
+} // ~anonymous namespace
+
+BufferedFill::BufferedFill(TH1* aHist) : mHist{aHist} {
+  mX.reserve(kBlockSize);
+  mW.reserve(kBlockSize);
+}
+
+void BufferedFill::Flush() {
+  size_t n = mX.size();
+  if (n == 0) return;
+
+  double stats[TH1::kNstat];
+  if (!can_fill_blocks(mHist, stats)) {
+    for (size_t i = 0; i < n; ++i) {
+      if (mW[i] == 1.0) {
+        mHist->Fill(mX[i]);
+      } else {
+        mHist->Fill(mX[i], mW[i]);
+      }
+    }
+    mX.clear();
+    mW.clear();
+    return;
+  }
+
+  mBins.resize(n);
+  find_bins(mHist->GetXaxis(), mX.data(), n, mBins.data());
+
+  // Apply the block in order, with the same arithmetic as TH1::Fill so the sums come out the same
+  check_sumw2(mHist, mW);
+  TArrayD* contents = dynamic_cast<TArrayD*>(mHist);
+  double* sumw2 = mHist->GetSumw2N() > 0 ? mHist->GetSumw2()->fArray : nullptr;
+  const int nbins = mHist->GetXaxis()->GetNbins();
+  const bool stat_overflows = mHist->GetStatOverflowsBehaviour();
+  bool stats_changed = false;
+  for (size_t i = 0; i < n; ++i) {
+    int bin = mBins[i];
+    double x = mX[i];
+    double w = mW[i];
+    if (contents) {
+      contents->fArray[bin] += w;
+    } else {
+      mHist->AddBinContent(bin, w);
+    }
+    if (sumw2) sumw2[bin] += w * w;
+    if ((bin == 0 || bin > nbins) && !stat_overflows) continue;
+    stats[0] += w;
+    stats[1] += w * w;
+    stats[2] += w * x;
+    stats[3] += w * x * x;
+    stats_changed = true;
+  }
+  if (stats_changed) mHist->PutStats(stats);
+  mHist->SetEntries(mHist->GetEntries() + n);
+  mX.clear();
+  mW.clear();
+}
+
+BufferedFill2D::BufferedFill2D(TH2* aHist) : mHist{aHist} {
+  mX.reserve(kBlockSize);
+  mY.reserve(kBlockSize);
+  mW.reserve(kBlockSize);
+}
+
+void BufferedFill2D::Flush() {
+  size_t n = mX.size();
+  if (n == 0) return;
+
+  double stats[TH1::kNstat];
+  if (!can_fill_blocks(mHist, stats)) {
+    for (size_t i = 0; i < n; ++i) {
+      if (mW[i] == 1.0) {
+        mHist->Fill(mX[i], mY[i]);
+      } else {
+        mHist->Fill(mX[i], mY[i], mW[i]);
+      }
+    }
+    mX.clear();
+    mY.clear();
+    mW.clear();
+    return;
+  }
+
+  mBinsX.resize(n);
+  mBinsY.resize(n);
+  find_bins(mHist->GetXaxis(), mX.data(), n, mBinsX.data());
+  find_bins(mHist->GetYaxis(), mY.data(), n, mBinsY.data());
+
+  // Apply the block in order, with the same arithmetic as TH2::Fill so the sums come out the same
+  check_sumw2(mHist, mW);
+  TArrayD* contents = dynamic_cast<TArrayD*>(mHist);
+  double* sumw2 = mHist->GetSumw2N() > 0 ? mHist->GetSumw2()->fArray : nullptr;
+  const int nbinsx = mHist->GetXaxis()->GetNbins();
+  const int nbinsy = mHist->GetYaxis()->GetNbins();
+  const bool stat_overflows = mHist->GetStatOverflowsBehaviour();
+  bool stats_changed = false;
+  for (size_t i = 0; i < n; ++i) {
+    int binx = mBinsX[i];
+    int biny = mBinsY[i];
+    int bin = biny * (nbinsx + 2) + binx;
+    double x = mX[i];
+    double y = mY[i];
+    double w = mW[i];
+    if (contents) {
+      contents->fArray[bin] += w;
+    } else {
+      mHist->AddBinContent(bin, w);
+    }
+    if (sumw2) sumw2[bin] += w * w;
+    if ((binx == 0 || binx > nbinsx || biny == 0 || biny > nbinsy) && !stat_overflows) continue;
+    stats[0] += w;
+    stats[1] += w * w;
+    stats[2] += w * x;
+    stats[3] += w * x * x;
+    stats[4] += w * y;
+    stats[5] += w * y * y;
+    stats[6] += w * x * y;
+    stats_changed = true;
+  }
+  if (stats_changed) mHist->PutStats(stats);
+  mHist->SetEntries(mHist->GetEntries() + n);
+  mX.clear();
+  mY.clear();
+  mW.clear();
+}
+} // ~namespace mica
@@ -0,0 +1,110 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/CutFlow.hh"
+
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+
+#include "mica/StateIO.hh"
+#include "mica/TimingStats.hh"
+
+namespace mica {
+
+std::atomic<bool> CutFlow::mAdaptive{false};
+
+double CutFlowEntry::GetRank() const {
+  if (seen == 0 || timed == 0) return 0.0; // Unmeasured, try it early to learn about it
+  double rejected = static_cast<double>(seen - passed) / seen;
+  if (rejected <= 0.0) return std::numeric_limits<double>::max();
+  return (time / timed) / rejected;
+}
+
+bool CutFlow::IsTimed() {
+  return GetAdaptive() || TimingStats::IsEnabled();
+}
+
+void CutFlow::Resize(size_t aNCuts) {
+  if (aNCuts == mEntries.size()) return;
+  mEntries.resize(aNCuts);
+  mOrder.clear();
+  for (size_t i = 0; i < aNCuts; ++i) mOrder.push_back(i);
+}
+
+void CutFlow::EndEvaluation() {
+  if (!GetAdaptive()) return;
+  if (++mNEvaluations < kReorderInterval) return;
+  mNEvaluations = 0;
+  reorder();
+}
+
+void CutFlow::reorder() {
+  std::stable_sort(mOrder.begin(), mOrder.end(), [this](size_t a, size_t b) {
+    return mEntries[a].GetRank() < mEntries[b].GetRank();
+  });
+}
+
+CutFlow& CutFlow::operator+=(const CutFlow& aOther) {
+  if (aOther.size() > size()) Resize(aOther.size());
+  for (size_t i = 0; i < aOther.size(); ++i) {
+    mEntries[i].seen += aOther.mEntries[i].seen;
+    mEntries[i].passed += aOther.mEntries[i].passed;
+    mEntries[i].time += aOther.mEntries[i].time;
+    mEntries[i].timed += aOther.mEntries[i].timed;
+  }
+  return *this;
+}
+
+void CutFlow::Reset() {
+  for (auto& entry : mEntries) entry = CutFlowEntry();
+  mNEvaluations = 0;
+}
+
+bool CutFlow::Save(TDirectory* aDir, size_t aCut) const {
+  if (aCut >= size()) return true; // Never applied, nothing to save
+  const CutFlowEntry& entry = mEntries[aCut];
+  bool result = StateIO::Save(aDir, "CutFlowSeen", static_cast<Long64_t>(entry.seen));
+  result = StateIO::Save(aDir, "CutFlowPassed", static_cast<Long64_t>(entry.passed)) && result;
+  result = StateIO::Save(aDir, "CutFlowTime", entry.time) && result;
+  return StateIO::Save(aDir, "CutFlowTimed", static_cast<Long64_t>(entry.timed)) && result;
+}
+
+bool CutFlow::Load(TDirectory* aDir, size_t aCut) {
+  Long64_t seen = 0;
+  Long64_t passed = 0;
+  Long64_t timed = 0;
+  double time = 0.0;
+  if (!StateIO::Load(aDir, "CutFlowSeen", seen)) return true; // Saved before it was applied
+  bool result = StateIO::Load(aDir, "CutFlowPassed", passed);
+  result = StateIO::Load(aDir, "CutFlowTime", time) && result;
+  result = StateIO::Load(aDir, "CutFlowTimed", timed) && result;
+  if (aCut >= size()) Resize(aCut + 1);
+  mEntries[aCut].seen = seen;
+  mEntries[aCut].passed = passed;
+  mEntries[aCut].time = time;
+  mEntries[aCut].timed = timed;
+  return result;
+}
+
+void CutFlow::Print(std::ostream& aOut, const std::vector<std::string>& aNames,
+                    const std::string& aIndent) const {
+  std::ios::fmtflags flags = aOut.flags();
+  std::streamsize precision = aOut.precision();
+  for (size_t i = 0; i < aNames.size(); ++i) {
+    CutFlowEntry entry;
+    if (i < size()) entry = mEntries[i];
+    double eff = entry.seen > 0 ? 100.0 * entry.passed / entry.seen : 0.0;
+    aOut << aIndent << std::left << std::setw(32) << aNames[i] << std::right
+         << std::setw(12) << entry.seen << std::setw(12) << entry.passed
+         << std::setw(9) << std::fixed << std::setprecision(2) << eff << "%";
+    if (entry.timed > 0) {
+      aOut << std::setw(12) << std::setprecision(3) << 1e6 * entry.time / entry.timed << " us";
+    }
+    aOut << "\n";
+  }
+  aOut.flags(flags);
+  aOut.precision(precision);
+}
+} // ~namespace mica
@@ -0,0 +1,97 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/CutRegistry.hh"
+
+#include <iostream>
+#include <string>
+
+#include "mica/Log.hh"
+#include "mica/TimingStats.hh"
+
+namespace mica {
+
+int CutRegistry::AddCut(CutsBase* aCut) {
+  if (!aCut) return -1;
+  if (mCuts.size() >= static_cast<size_t>(kMaxCuts)) {
+    MICA_LOG_WARNING("CutRegistry: Only " << kMaxCuts << " cuts may be registered");
+    delete aCut;
+    return -1;
+  }
+  mOwnedCuts.emplace_back(aCut);
+  mCuts.push_back(aCut);
+  return static_cast<int>(mCuts.size() - 1);
+}
+
+int CutRegistry::ShareCut(CutsBase* aCut) {
+  if (!aCut) return -1;
+  for (size_t i = 0; i < mCuts.size(); ++i) {
+    if (mCuts[i] == aCut || mCuts[i]->IsEquivalent(*aCut)) return static_cast<int>(i);
+  }
+  if (mCuts.size() >= static_cast<size_t>(kMaxCuts)) {
+    MICA_LOG_WARNING("CutRegistry: Only " << kMaxCuts << " cuts may be registered");
+    return -1;
+  }
+  mCuts.push_back(aCut);
+  return static_cast<int>(mCuts.size() - 1);
+}
+
+bool CutRegistry::Passes(std::uint64_t aMask, const EventContext& aContext) {
+  EventContext::CutMemo& memo = aContext.GetCutMemo();
+
+  // Anything already known to have failed settles it without running more cuts
+  if (aMask & memo.evaluated & ~memo.passed) return false;
+
+  std::uint64_t todo = aMask & ~memo.evaluated;
+  if (todo == 0) return true;
+  mCutFlow.Resize(mCuts.size());
+  bool timed = CutFlow::IsTimed();
+  bool result = true;
+  for (size_t i : mCutFlow.GetOrder()) {
+    std::uint64_t bit = std::uint64_t(1) << i;
+    if (!(todo & bit)) continue;
+    todo &= ~bit;
+    TimingStats::Clock::time_point start;
+    if (timed) start = TimingStats::Clock::now();
+    result = mCuts[i]->Cut(aContext);
+    double time = timed ?
+        std::chrono::duration<double>(TimingStats::Clock::now() - start).count() : 0.0;
+    mCutFlow.Record(i, result, time);
+    memo.evaluated |= bit;
+    if (!result) break;
+    memo.passed |= bit;
+    if (todo == 0) break;
+  }
+  mCutFlow.EndEvaluation();
+  return result;
+}
+
+unsigned int CutRegistry::GetDataRequirements(std::uint64_t aMask) const {
+  unsigned int result = kNoData;
+  for (size_t i = 0; i < mCuts.size(); ++i) {
+    if (aMask & (std::uint64_t(1) << i)) result |= mCuts[i]->GetDataRequirements();
+  }
+  return result;
+}
+
+bool CutRegistry::Save(TDirectory* aDir) const {
+  if (!aDir) return false;
+  bool result = true;
+  for (size_t i = 0; i < mCuts.size(); ++i) {
+    TDirectory* dir = aDir->mkdir(("cut" + std::to_string(i)).c_str());
+    if (!dir || !mCuts[i]->Save(dir) || !mCutFlow.Save(dir, i)) result = false;
+  }
+  return result;
+}
+
+bool CutRegistry::Load(TDirectory* aDir) {
+  if (!aDir) return false;
+  bool result = true;
+  for (size_t i = 0; i < mCuts.size(); ++i) {
+    TDirectory* dir = aDir->GetDirectory(("cut" + std::to_string(i)).c_str());
+    if (!dir || !mCuts[i]->Load(dir) || !mCutFlow.Load(dir, i)) result = false;
+  }
+  return result;
+}
+} // ~namespace mica
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "mica/CutsTOFTime.hh"
+#include "mica/StateIO.hh"
 
 #include "src/common_cpp/DataStructure/TOFEvent.hh"
 #include "src/common_cpp/DataStructure/TOFEventSpacePoint.hh"
@@ -15,27 +16,33 @@ namespace mica {
 CutsTOFTime::CutsTOFTime() : mLowerTimeCut(27.0), mUpperTimeCut(50.0) {}
 
 bool CutsTOFTime::Cut(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent) {
-  if (!aReconEvent)
-    return false;
-
-  MAUS::TOFEvent* tofEvent = aReconEvent->GetTOFEvent();
-  if (!tofEvent)
-    return false;
-
-  std::vector<MAUS::TOFSpacePoint>* tof1Spoints =
-      tofEvent->GetTOFEventSpacePointPtr()->GetTOF1SpacePointArrayPtr();
-  std::vector<MAUS::TOFSpacePoint>* tof2Spoints =
-      tofEvent->GetTOFEventSpacePointPtr()->GetTOF2SpacePointArrayPtr();
+  return Cut(EventContext(aReconEvent, aMCEvent));
+}
 
-  if (tof1Spoints->size() != 1 || tof2Spoints->size() != 1)
+bool CutsTOFTime::Cut(const EventContext& aContext) {
+  if (!aContext.HasTOF12())
     return false;
 
-  double dt = tof2Spoints->at(0).GetTime() - tof1Spoints->at(0).GetTime();
+  double dt = aContext.GetTOF12();
   if (dt > mLowerTimeCut && dt < mUpperTimeCut)
     return true;
 
   return false;
 }
 
+bool CutsTOFTime::IsEquivalent(const CutsBase& aCut) const {
+  const CutsTOFTime* other = dynamic_cast<const CutsTOFTime*>(&aCut);
+  return other && other->mLowerTimeCut == mLowerTimeCut && other->mUpperTimeCut == mUpperTimeCut;
+}
+
+bool CutsTOFTime::Save(TDirectory* aDir) const {
+  bool result = StateIO::Save(aDir, "LowerTimeCut", mLowerTimeCut);
+  return StateIO::Save(aDir, "UpperTimeCut", mUpperTimeCut) && result;
+}
+
+bool CutsTOFTime::Load(TDirectory* aDir) {
+  bool result = StateIO::Load(aDir, "LowerTimeCut", mLowerTimeCut);
+  return StateIO::Load(aDir, "UpperTimeCut", mUpperTimeCut) && result;
+}
 } // ~namespace mica
 
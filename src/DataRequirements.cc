@@ -0,0 +1,111 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/DataRequirements.hh"
+
+#include <map>
+#include <sstream>
+
+#include "TBranch.h"
+#include "TObjArray.h"
+
+namespace mica {
+
+namespace {
+
+/** MAUS data member names and the flags which require them to be read */
+const std::map<std::string, unsigned int> kMemberRequirements {
+  {"_daq_data", kDAQData},
+  {"_scalars", kDAQData},
+  {"_emr_spill_data", kEMRData},
+  {"_emr_event", kEMRData},
+  {"_kl_event", kKLData},
+  {"_ckov_event", kCkovData},
+  {"_global_event", kGlobalData},
+  {"_trigger_event", kTriggerData},
+  {"_tof_event", kTOFData},
+  {"_tof_digits", kTOFDigits},
+  {"_tof_slab_hits", kTOFSlabHits},
+  {"_tof_space_points", kTOFSpacePoints},
+  {"_scifi_event", kSciFiData},
+  {"_scifidigits", kSciFiDigits},
+  {"_scificlusters", kSciFiClusters},
+  {"_scifispacepoints", kSciFiSpacePoints},
+  {"_scifiseeds", kSciFiSeeds},
+  {"_scifihelicalprtracks", kSciFiPRTracks},
+  {"_scifistraightprtracks", kSciFiPRTracks},
+  {"_scifitracks", kSciFiTracks},
+  {"_mc_events", kMCData}
+};
+
+/** MCEvent data member names, only matched below an _mc_events branch */
+const std::map<std::string, unsigned int> kMCMemberRequirements {
+  {"_primary", kMCPrimary},
+  {"_tracks", kMCTracks},
+  {"_sci_fi_hits", kMCSciFiHits},
+  {"_sci_fi_noise_hits", kMCSciFiHits},
+  {"_tof_hits", kMCTOFHits},
+  {"_virtual_hits", kMCVirtualHits},
+  {"_special_virtual_hits", kMCVirtualHits},
+  {"_ckov_hits", kMCOtherHits},
+  {"_kl_hits", kMCOtherHits},
+  {"_emr_hits", kMCOtherHits}
+};
+
+/** Flag names, in bit order, used by Describe */
+const std::vector<std::string> kFlagNames {
+  "SciFiDigits", "SciFiClusters", "SciFiSpacePoints", "SciFiSeeds", "SciFiPRTracks",
+  "SciFiTracks", "TOFDigits", "TOFSlabHits", "TOFSpacePoints", "Ckov", "KL", "EMR", "Global",
+  "Trigger", "DAQ", "MCPrimary", "MCTracks", "MCSciFiHits", "MCTOFHits", "MCVirtualHits",
+  "MCOtherHits"
+};
+} // ~anonymous namespace
+
+int BranchSelector::Apply(TTree* aTree, unsigned int aRequirements) {
+  if (!aTree || aRequirements == kAllData) return 0;
+  return apply(aTree, aTree->GetListOfBranches(), aRequirements, false);
+}
+
+std::string BranchSelector::Describe(unsigned int aRequirements) {
+  if (aRequirements == kAllData) return "All";
+  std::stringstream ss;
+  for (size_t i = 0; i < kFlagNames.size(); ++i) {
+    if (aRequirements & (1u << i)) ss << (ss.tellp() > 0 ? " " : "") << kFlagNames[i];
+  }
+  return ss.tellp() > 0 ? ss.str() : "None";
+}
+
+int BranchSelector::apply(TTree* aTree, TObjArray* aBranches, unsigned int aRequirements,
+                          bool aDisable) {
+  if (!aBranches) return 0;
+  int ndisabled = 0;
+  for (int i = 0; i < aBranches->GetEntriesFast(); ++i) {
+    TBranch* branch = static_cast<TBranch*>(aBranches->UncheckedAt(i));
+    if (!branch) continue;
+    bool disable = aDisable || !(branch_requirements(branch->GetName()) & aRequirements);
+    if (disable) {
+      aTree->SetBranchStatus(branch->GetName(), false);
+      ++ndisabled;
+    }
+    ndisabled += apply(aTree, branch->GetListOfBranches(), aRequirements, disable);
+  }
+  return ndisabled;
+}
+
+unsigned int BranchSelector::branch_requirements(const std::string& aBranchName) {
+  // A branch is needed if any requested flag is common to every MAUS member in its name
+  unsigned int result = kAllData;
+  bool in_mc = false;
+  std::stringstream ss(aBranchName);
+  std::string member;
+  while (std::getline(ss, member, '.')) {
+    const auto& members = in_mc ? kMCMemberRequirements : kMemberRequirements;
+    auto it = members.find(member);
+    if (it == members.end()) continue;
+    result &= it->second;
+    if (member == "_mc_events") in_mc = true;
+  }
+  return result;
+}
+} // ~namespace mica
@@ -0,0 +1,106 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/EventContext.hh"
+
+#include "src/common_cpp/DataStructure/SciFiHelicalPRTrack.hh"
+#include "src/common_cpp/DataStructure/SciFiStraightPRTrack.hh"
+#include "src/common_cpp/DataStructure/TOFEventSpacePoint.hh"
+
+namespace mica {
+
+EventContext::EventContext(MAUS::ReconEvent* const aReconEvent, MAUS::MCEvent* const aMCEvent,
+                           Long64_t aSpillEntry, int aEvent)
+    : mReconEvent{aReconEvent},
+      mMCEvent{aMCEvent},
+      mSpillEntry{aSpillEntry},
+      mEvent{aEvent},
+      mSciFiEvent{nullptr},
+      mTOFEvent{nullptr},
+      mTOFSpacePoints(),
+      mHasTOF12{false},
+      mTOF12{0.0} {
+  mTOFSpacePoints.fill(nullptr);
+  if (!mReconEvent) return;
+  mTOFEvent = mReconEvent->GetTOFEvent();
+  mSciFiEvent = mReconEvent->GetSciFiEvent();
+  extract_tof();
+  extract_scifi();
+}
+
+const MCTruth* EventContext::GetMCTruth(const MCTruth::Settings& aSettings) const {
+  if (!mMCEvent) return nullptr;
+  if (mMCTruth && mMCTruth->GetSettings() == aSettings) return mMCTruth.get();
+  for (const auto& truth : mOtherMCTruths) {
+    if (truth->GetSettings() == aSettings) return truth.get();
+  }
+
+  // The first truth is held in place, so the usual single truth of an event allocates nothing
+  if (!mMCTruth) {
+    mMCTruth = MCTruth::Make(mMCEvent, aSettings);
+    return mMCTruth.get();
+  }
+  mOtherMCTruths.push_back(MCTruth::Make(mMCEvent, aSettings));
+  return mOtherMCTruths.back().get();
+}
+
+MAUS::SciFiTrackPoint* EventContext::GetTrackPoint(const MAUS::SciFiTrack* aTrack, int aStation,
+                                                   int aPlane) const {
+  if (aStation < 1 || aStation > kNStations || aPlane < 0 || aPlane >= kNPlanes) return nullptr;
+  for (size_t i = 0; i < mTracks.size(); ++i) {
+    if (mTracks[i] == aTrack) return mTrackPoints[i][(aStation - 1) * kNPlanes + aPlane];
+  }
+  return nullptr;
+}
+
+void EventContext::extract_tof() {
+  if (!mTOFEvent) return;
+  MAUS::TOFEventSpacePoint* tofsps = mTOFEvent->GetTOFEventSpacePointPtr();
+  if (!tofsps) return;
+  mTOFSpacePoints[0] = tofsps->GetTOF0SpacePointArrayPtr();
+  mTOFSpacePoints[1] = tofsps->GetTOF1SpacePointArrayPtr();
+  mTOFSpacePoints[2] = tofsps->GetTOF2SpacePointArrayPtr();
+  if (mTOFSpacePoints[1] && mTOFSpacePoints[2] &&
+      mTOFSpacePoints[1]->size() == 1 && mTOFSpacePoints[2]->size() == 1) {
+    mHasTOF12 = true;
+    mTOF12 = mTOFSpacePoints[2]->at(0).GetTime() - mTOFSpacePoints[1]->at(0).GetTime();
+  }
+}
+
+void EventContext::extract_scifi() {
+  if (!mSciFiEvent) return;
+
+  // Kalman tracks, by tracker, plus a trackpoint lookup table for each. Where a track has more
+  // than one trackpoint on a plane the last is kept.
+  mTracks = mSciFiEvent->scifitracks();
+  mTrackPoints.resize(mTracks.size());
+  for (size_t i = 0; i < mTracks.size(); ++i) {
+    MAUS::SciFiTrack* trk = mTracks[i];
+    if (trk->tracker() == 0 || trk->tracker() == 1) mTrackerTracks[trk->tracker()].push_back(trk);
+    mTrackPoints[i].fill(nullptr);
+    for (auto tp : trk->scifitrackpoints()) {
+      if (tp->station() < 1 || tp->station() > kNStations || tp->plane() < 0 ||
+          tp->plane() >= kNPlanes) continue;
+      mTrackPoints[i][(tp->station() - 1) * kNPlanes + tp->plane()] = tp;
+    }
+  }
+
+  // Pattern recognition tracks, anything not in TkU is counted as TkD
+  for (auto trk : mSciFiEvent->helicalprtracks()) {
+    mPRTracks[trk->get_tracker() == 0 ? 0 : 1].push_back(trk);
+  }
+  for (auto trk : mSciFiEvent->straightprtracks()) {
+    mPRTracks[trk->get_tracker() == 0 ? 0 : 1].push_back(trk);
+  }
+
+  // Spacepoints, by tracker and station
+  mSpacePoints = mSciFiEvent->spacepoints();
+  for (auto sp : mSpacePoints) {
+    int tracker = sp->get_tracker();
+    int station = sp->get_station();
+    if (tracker < 0 || tracker >= kNTrackers || station < 1 || station > kNStations) continue;
+    mStationSpacePoints[tracker][station - 1].push_back(sp);
+  }
+}
+} // ~namespace mica
@@ -0,0 +1,560 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/EventLoop.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "TChain.h"
+#include "TFile.h"
+#include "TROOT.h"
+
+#include "src/common_cpp/DataStructure/ReconEvent.hh"
+#include "src/common_cpp/DataStructure/MCEvent.hh"
+
+#include "mica/DataRequirements.hh"
+#include "mica/SpillReader.hh"
+#include "mica/StateIO.hh"
+#include "mica/Log.hh"
+
+namespace mica {
+
+EventLoop::EventLoop() : mMaker{nullptr},
+                         mNThreads{1},
+                         mPrefetchDepth{0},
+                         mEventsPerTask{16},
+                         mSkipUnusedData{true},
+                         mDataRequirements{kAllData},
+                         mFirstEntry{0},
+                         mLastEntry{-1},
+                         mNEntries{0},
+                         mBegin{0},
+                         mEnd{0},
+                         mNextEntry{0},
+                         mSpillsProcessed{0},
+                         mEventsProcessed{0},
+                         mReading{0},
+                         mCheckpointInterval{300.0},
+                         mWatermark{0},
+                         mPauseRequested{false},
+                         mPausedWorkers{0},
+                         mActiveWorkers{0} {
+  // Do nothing
+}
+
+EventLoop::EventLoop(GroupMaker aMaker) : EventLoop() {
+  mMaker = aMaker;
+}
+
+bool EventLoop::Run(const std::string& aFileName, AnalyserGroup& aAnalysers) {
+  return Run(std::vector<std::string>{aFileName}, aAnalysers);
+}
+
+bool EventLoop::Run(const std::vector<std::string>& aFileNames, AnalyserGroup& aAnalysers) {
+  // Check the input files and count the spills, each worker then builds its own chain
+  TChain chain("Spill");
+  for (const auto& fname : aFileNames) {
+    if (chain.Add(fname.c_str(), 0) < 1) {
+      MICA_LOG_ERROR("Failed to find Spill tree in file: " << fname);
+      return false;
+    }
+  }
+  mFileNames = aFileNames;
+  mNEntries = chain.GetEntries();
+  MICA_LOG_INFO("Found " << mNEntries << " spills in " << chain.GetNtrees() << " files");
+
+  // Clamp the requested entry range to the chain
+  mBegin = std::min(std::max(mFirstEntry, Long64_t(0)), mNEntries);
+  mEnd = (mLastEntry < 0 || mLastEntry > mNEntries) ? mNEntries : mLastEntry;
+  if (mEnd < mBegin) mEnd = mBegin;
+  if (mBegin != 0 || mEnd != mNEntries) {
+    MICA_LOG_INFO("Analysing entries " << mBegin << " to " << mEnd);
+  }
+
+  // With a selection index only the listed entries in the range are queued, so the queue then
+  // runs over positions in that list rather than over the entries themselves
+  mEntryList.clear();
+  if (mSelectionInput) {
+    if (mSelectionInput->GetNSpills() != mNEntries) {
+      MICA_LOG_ERROR("Selection index " << mSelectionInput->GetName() << " was made on input with "
+                     << mSelectionInput->GetNSpills() << " spills, not " << mNEntries);
+      return false;
+    }
+    for (Long64_t entry : mSelectionInput->GetEntries()) {
+      if (entry >= mBegin && entry < mEnd) mEntryList.push_back(entry);
+    }
+    MICA_LOG_INFO("Selection " << mSelectionInput->GetName() << ": reading " << mEntryList.size()
+                  << " of " << (mEnd - mBegin) << " spills");
+    mBegin = 0;
+    mEnd = static_cast<Long64_t>(mEntryList.size());
+  }
+
+  // Only read the parts of the spill the analysers use
+  mDataRequirements = mSkipUnusedData ? aAnalysers.GetDataRequirements() : kAllData;
+  if (mSlimOutput) mDataRequirements |= SlimEvent::kDataRequirements;
+  int ndisabled = BranchSelector::Apply(&chain, mDataRequirements);
+  MICA_LOG_INFO("Reading spill data: " << BranchSelector::Describe(mDataRequirements)
+                << " (" << ndisabled << " branches skipped)");
+
+  mNextEntry = mBegin;
+  mSpillsProcessed = 0;
+  mEventsProcessed = 0;
+  mReading = 0;
+  mPrefetchStats = QueueStats();
+
+  int nthreads = mNThreads;
+  if (nthreads > 1 && !mMaker) {
+    MICA_LOG_WARNING("EventLoop::Run: No analyser maker supplied, running on 1 thread");
+    nthreads = 1;
+  }
+
+  mScheduler.reset(new SpillScheduler(nthreads));
+  mWorkerStats.assign(nthreads, WorkerStats());
+  mWorkerSelected.assign(nthreads, std::vector<SelectionIndex::Entry>());
+  mWatermark = mBegin;
+  mDoneEntries.clear();
+  mSkipEntries.clear();
+  mPauseRequested = false;
+  mPausedWorkers = 0;
+  mActiveWorkers = nthreads;
+
+  // Pick up from the last checkpoint, if there is one
+  if (!mCheckpointFile.empty() && std::ifstream(mCheckpointFile).good()) {
+    if (!read_checkpoint(aAnalysers)) return false;
+  }
+
+  // Serial running, analyse everything in this thread (plus a reader thread if prefetching)
+  if (nthreads < 2 && mCheckpointFile.empty()) {
+    if (mPrefetchDepth > 0) ROOT::EnableThreadSafety();
+    work(0, aAnalysers);
+    print_prefetch_stats();
+    collect_selected();
+    Log::FlushSuppressed();
+    return true;
+  }
+
+  // Parallel running, the first worker uses the analysers passed in, the others get replicas.
+  // When checkpointing, this thread is left free to coordinate the checkpoints.
+  ROOT::EnableThreadSafety();
+  std::vector<AnalyserGroup> replicas;
+  for (int i = 1; i < nthreads; ++i) {
+    replicas.push_back(mMaker());
+  }
+  std::vector<std::thread> workers;
+  workers.emplace_back(&EventLoop::work, this, 0, std::ref(aAnalysers));
+  for (size_t i = 0; i < replicas.size(); ++i) {
+    workers.emplace_back(&EventLoop::work, this, static_cast<int>(i + 1), std::ref(replicas[i]));
+  }
+  if (!mCheckpointFile.empty()) {
+    std::vector<AnalyserGroup*> groups {&aAnalysers};
+    for (auto& replica : replicas) groups.push_back(&replica);
+    if (groups.size() > 1) mCheckpointSum.reset(new AnalyserGroup(mMaker()));
+    checkpoint_loop(groups);
+    write_checkpoint(groups);
+    mCheckpointSum.reset();
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  MICA_LOG_INFO("Spills processed: " << mSpillsProcessed << " of " << (mEnd - mBegin)
+                << ", events processed: " << mEventsProcessed);
+  print_prefetch_stats();
+  print_worker_stats();
+  collect_selected();
+  Log::FlushSuppressed();
+
+  // Fold the replicas back into the main analysers
+  bool merged = true;
+  for (auto& replica : replicas) {
+    if (!aAnalysers.Merge(&replica)) merged = false;
+  }
+  if (!merged) {
+    MICA_LOG_WARNING("EventLoop::Run: Not all analysers support merging, their results "
+                     << "cover only part of the input");
+  }
+  return true;
+}
+
+void EventLoop::work(int aWorker, AnalyserGroup& aAnalysers) {
+  auto wall_start = std::chrono::steady_clock::now();
+  WorkerStats& stats = mWorkerStats[aWorker];
+
+  // Set up the spill input, either a background reader or direct access to our own chain
+  std::unique_ptr<SpillReader> reader;
+  std::unique_ptr<TChain> chain;
+  MAUS::Data* data = nullptr;  // Don't forget = nullptr or you get a seg fault
+  if (mPrefetchDepth > 0) {
+    reader.reset(new SpillReader(mFileNames, mPrefetchDepth, [this]() { return next_entry(); },
+                                 mDataRequirements));
+  } else {
+    chain.reset(new TChain("Spill"));
+    for (const auto& fname : mFileNames) {
+      chain->Add(fname.c_str());
+    }
+    BranchSelector::Apply(chain.get(), mDataRequirements);
+  }
+
+  // Read the next spill into a new MAUS::Data, which is then shared by the tasks made from it
+  auto read_spill = [&](SpillReader::Entry& aEntry) {
+    if (reader) return reader->Next(aEntry);
+    Long64_t i = next_entry();
+    if (i < 0) return false;
+    data = new MAUS::Data();
+    chain->SetBranchAddress("data", &data); // Yes, this is the *address* of a *pointer*
+    if (TimingStats::IsEnabled()) {
+      TimingStats::Clock::time_point start = TimingStats::Clock::now();
+      int nbytes = chain->GetEntry(i);
+      stats.get_entry.Record(start, nbytes > 0);
+    } else {
+      chain->GetEntry(i);
+    }
+    aEntry = SpillReader::Entry(i, std::unique_ptr<MAUS::Data>(data));
+    return true;
+  };
+
+  // Analyse our own tasks first, then read a new spill, and once the input is exhausted
+  // steal tasks from the other workers until there is nothing left anywhere
+  bool exhausted = false;
+  SpillTask task;
+  while (true) {
+    bool stolen = false;
+    if (!mScheduler->Pop(aWorker, task)) {
+      if (!exhausted && !mPauseRequested) {
+        ++mReading;
+        auto read_start = std::chrono::steady_clock::now();
+        SpillReader::Entry entry;
+        exhausted = !read_spill(entry);
+        if (!exhausted) schedule_spill(aWorker, entry);
+        stats.read += std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - read_start).count();
+        --mReading;
+        mScheduler->Notify(); // The idle workers may be waiting for this read to finish
+        continue;
+      }
+      // Anything pushed after reading the version wakes the wait below straight away
+      unsigned long version = mScheduler->GetVersion();
+      stolen = mScheduler->Steal(aWorker, task);
+      if (!stolen) {
+        if (mPauseRequested) {
+          pause();
+          continue;
+        }
+        if (exhausted && mReading == 0 && mScheduler->Empty()) break;
+        mScheduler->Wait(version);
+        continue;
+      }
+    }
+
+    // Call the analysers
+    auto busy_start = std::chrono::steady_clock::now();
+    int nevents = analyse_task(aWorker, task, aAnalysers);
+    task.data.reset();
+    stats.busy += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - busy_start).count();
+    stats.events += nevents;
+    ++stats.tasks;
+    if (stolen) ++stats.stolen;
+
+    int events_processed = (mEventsProcessed += nevents);
+    MICA_LOG_PROGRESS("Spills processed: " << mSpillsProcessed << " of " << (mEnd - mBegin)
+                      << ", events processed: " << events_processed);
+  }
+
+  if (reader) {
+    std::lock_guard<std::mutex> lock(mOutputMutex);
+    mPrefetchStats += reader->GetStats();
+    stats.get_entry += reader->GetReadTiming();
+  } else {
+    chain->ResetBranchAddresses();
+  }
+  stats.wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+  // Let the checkpoint coordinator know we are finished
+  std::lock_guard<std::mutex> lock(mPauseMutex);
+  --mActiveWorkers;
+  mPauseCV.notify_all();
+}
+
+Long64_t EventLoop::next_entry() {
+  Long64_t i = mNextEntry++;
+  while (i < mEnd && mSkipEntries.count(i)) i = mNextEntry++; // Done before the last checkpoint
+  if (i >= mEnd) return -1;
+  return mSelectionInput ? mEntryList[i] : i;
+}
+
+Long64_t EventLoop::queue_position(Long64_t aEntry) const {
+  if (!mSelectionInput) return aEntry;
+  return std::lower_bound(mEntryList.begin(), mEntryList.end(), aEntry) - mEntryList.begin();
+}
+
+void EventLoop::mark_done(Long64_t aEntry) {
+  Long64_t position = queue_position(aEntry);
+  std::lock_guard<std::mutex> lock(mDoneMutex);
+  mDoneEntries.insert(position);
+  while (!mDoneEntries.empty() && *mDoneEntries.begin() == mWatermark) {
+    mDoneEntries.erase(mDoneEntries.begin());
+    ++mWatermark;
+  }
+}
+
+void EventLoop::pause() {
+  std::unique_lock<std::mutex> lock(mPauseMutex);
+  ++mPausedWorkers;
+  mPauseCV.notify_all();
+  mPauseCV.wait(lock, [this] { return !mPauseRequested; });
+  --mPausedWorkers;
+}
+
+void EventLoop::checkpoint_loop(const std::vector<AnalyserGroup*>& aGroups) {
+  std::unique_lock<std::mutex> lock(mPauseMutex);
+  auto interval = std::chrono::duration<double>(mCheckpointInterval);
+  auto next = std::chrono::steady_clock::now() +
+              std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
+  while (!mPauseCV.wait_until(lock, next, [this] { return mActiveWorkers == 0; })) {
+    // Stop the workers at a point where every spill they have taken is fully analysed
+    mPauseRequested = true;
+    mScheduler->Notify(); // Wake the idle workers so they pause
+    mPauseCV.wait(lock, [this] { return mPausedWorkers == mActiveWorkers; });
+    lock.unlock();
+    write_checkpoint(aGroups);
+    lock.lock();
+    mPauseRequested = false;
+    mPauseCV.notify_all();
+    next = std::chrono::steady_clock::now() +
+           std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
+  }
+}
+
+bool EventLoop::write_checkpoint(const std::vector<AnalyserGroup*>& aGroups) {
+  auto start = std::chrono::steady_clock::now();
+
+  // Sum the worker results into one group, unless there is only the one. The sum is emptied
+  // and reused each time, only analysers which cannot be reset need it building again.
+  AnalyserGroup* state = aGroups[0];
+  if (aGroups.size() > 1) {
+    if (!mCheckpointSum->Reset()) *mCheckpointSum = mMaker();
+    for (auto group : aGroups) mCheckpointSum->Merge(group);
+    state = mCheckpointSum.get();
+  }
+
+  // The entries finished so far: everything below the watermark plus a few stragglers above
+  // it, stored as (first entry, number of entries) ranges
+  Long64_t watermark = 0;
+  std::vector<Long64_t> done;
+  {
+    std::lock_guard<std::mutex> lock(mDoneMutex);
+    watermark = mWatermark;
+    for (auto entry : mDoneEntries) {
+      if (!done.empty() && done[done.size() - 2] + done.back() == entry) {
+        ++done.back();
+      } else {
+        done.push_back(entry);
+        done.push_back(1);
+      }
+    }
+  }
+
+  // The events passing the selection so far, so the index is complete after a restart, stored
+  // as (entry, event) pairs
+  std::vector<Long64_t> selected;
+  for (const auto& worker : mWorkerSelected) {
+    for (const auto& event : worker) {
+      selected.push_back(event.first);
+      selected.push_back(event.second);
+    }
+  }
+
+  // Write to a temporary file then rename, so a pre-emption never leaves a partial checkpoint
+  std::string tmpname = mCheckpointFile + ".tmp";
+  TFile f(tmpname.c_str(), "RECREATE", "MICA checkpoint", 1);
+  if (!f.IsOpen()) {
+    MICA_LOG_WARNING("EventLoop: Failed to open checkpoint file " << tmpname);
+    return false;
+  }
+  bool saved = StateIO::Save(&f, "NEntries", mNEntries);
+  saved = StateIO::Save(&f, "Begin", mBegin) && saved;
+  saved = StateIO::Save(&f, "End", mEnd) && saved;
+  saved = StateIO::Save(&f, "Watermark", watermark) && saved;
+  saved = StateIO::Save(&f, "DoneRanges", done) && saved;
+  saved = StateIO::Save(&f, "SelectedEvents", selected) && saved;
+  TDirectory* dir = f.mkdir("analysers");
+  if (!dir || !state->Save(dir)) {
+    MICA_LOG_WARNING("EventLoop: Not all analysers support checkpointing, their results "
+                     << "will be incomplete after a restart");
+  }
+  f.Close();
+  if (!saved || std::rename(tmpname.c_str(), mCheckpointFile.c_str()) != 0) {
+    MICA_LOG_WARNING("EventLoop: Failed to write checkpoint " << mCheckpointFile);
+    return false;
+  }
+  MICA_LOG_INFO("Checkpoint written to " << mCheckpointFile << ", spills done up to entry "
+                << watermark << " ("
+                << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+                << " s)");
+  return true;
+}
+
+bool EventLoop::read_checkpoint(AnalyserGroup& aAnalysers) {
+  TFile f(mCheckpointFile.c_str(), "READ");
+  Long64_t nentries = -1;
+  Long64_t begin = -1;
+  Long64_t end = -1;
+  Long64_t watermark = -1;
+  std::vector<Long64_t> done;
+  if (!f.IsOpen() || !StateIO::Load(&f, "NEntries", nentries) ||
+      !StateIO::Load(&f, "Begin", begin) || !StateIO::Load(&f, "End", end) ||
+      !StateIO::Load(&f, "Watermark", watermark) || !StateIO::Load(&f, "DoneRanges", done)) {
+    MICA_LOG_ERROR("Failed to read checkpoint file: " << mCheckpointFile);
+    return false;
+  }
+  if (nentries != mNEntries || begin != mBegin || end != mEnd) {
+    MICA_LOG_ERROR("Checkpoint " << mCheckpointFile << " was made with different input, remove "
+                   << "it to start again");
+    return false;
+  }
+  if (!aAnalysers.Load(f.GetDirectory("analysers"))) {
+    MICA_LOG_WARNING("EventLoop: Not all analysers could be restored from the checkpoint, "
+                     << "their results will be incomplete");
+  }
+
+  // Carry on from the watermark, skipping the entries above it which were already done
+  mWatermark = watermark;
+  for (size_t i = 0; i + 1 < done.size(); i += 2) {
+    for (Long64_t entry = done[i]; entry < done[i] + done[i + 1]; ++entry) {
+      mSkipEntries.insert(entry);
+      mDoneEntries.insert(entry);
+    }
+  }
+
+  // The list is empty when no selection is being recorded
+  std::vector<Long64_t> selected;
+  StateIO::Load(&f, "SelectedEvents", selected);
+  for (size_t i = 0; i + 1 < selected.size(); i += 2) {
+    mWorkerSelected[0].push_back(SelectionIndex::Entry(selected[i],
+                                                       static_cast<int>(selected[i + 1])));
+  }
+  mNextEntry = mWatermark;
+  MICA_LOG_INFO("Resuming from checkpoint " << mCheckpointFile << " at entry " << mWatermark);
+  return true;
+}
+
+void EventLoop::schedule_spill(int aWorker, SpillReader::Entry& aEntry) {
+  ++mSpillsProcessed;
+  mark_done(aEntry.first); // Tasks are always finished before a checkpoint is taken
+  if (!aEntry.second) {
+    MICA_LOG_WARNING("EventLoop: Data is NULL");
+    return;
+  }
+  MAUS::Spill* spill = aEntry.second->GetSpill();
+  if (spill == nullptr) {
+    MICA_LOG_WARNING("EventLoop: Spill is NULL");
+    return;
+  }
+  if (spill->GetDaqEventType() != "physics_event") {
+    MICA_LOG_TRACE("Spill is of type " << spill->GetDaqEventType() << ", not a usable spill");
+    return;
+  }
+
+  // Split the recon events into tasks of at most mEventsPerTask events. They are pushed last
+  // first, so this worker takes them in order while thieves take from the end of the spill.
+  SpillTask task;
+  task.data = std::shared_ptr<MAUS::Data>(std::move(aEntry.second));
+  task.entry = aEntry.first;
+  size_t nevents = spill->GetReconEvents()->size();
+  size_t step = mEventsPerTask > 0 ? mEventsPerTask : std::max(nevents, size_t(1));
+  size_t ntasks = (nevents + step - 1) / step;
+  for (size_t i = ntasks; i-- > 0; ) {
+    task.first = i * step;
+    task.last = std::min(nevents, task.first + step);
+    mScheduler->Push(aWorker, task);
+  }
+}
+
+void EventLoop::print_prefetch_stats() const {
+  if (mPrefetchDepth < 1) return;
+  const QueueStats& s = mPrefetchStats;
+  MICA_LOG_INFO("Prefetch (depth " << mPrefetchDepth << "): analysis waited for the reader on "
+                << s.consumer_stalls << " of " << s.pops << " spills (" << s.consumer_wait
+                << " s), reader waited on a full queue " << s.producer_stalls << " times ("
+                << s.producer_wait << " s)");
+}
+
+TimingStats EventLoop::GetReadTiming() const {
+  TimingStats result;
+  for (const auto& s : mWorkerStats) result += s.get_entry;
+  return result;
+}
+
+void EventLoop::print_worker_stats() const {
+  if (mWorkerStats.size() < 2) return;
+  // One message for all the workers, so that none are lost to the rate limit
+  std::ostringstream out;
+  for (size_t i = 0; i < mWorkerStats.size(); ++i) {
+    const WorkerStats& s = mWorkerStats[i];
+    if (i > 0) out << "\n";
+    out << "Worker " << i << ": busy " << s.busy << " s of " << s.wall << " s ("
+        << (s.wall > 0.0 ? 100.0 * s.busy / s.wall : 0.0) << "%), reading " << s.read
+        << " s, " << s.events << " events in " << s.tasks << " tasks, " << s.stolen
+        << " tasks stolen";
+  }
+  MICA_LOG_INFO(out.str());
+}
+
+int EventLoop::analyse_task(int aWorker, const SpillTask& aTask, AnalyserGroup& aAnalysers) {
+  MAUS::Spill* spill = aTask.data->GetSpill();
+  auto revts = spill->GetReconEvents();
+  auto mevts = spill->GetMCEvents();
+
+  // When reading a selection index, only the listed events of the spill are analysed
+  const std::vector<int>* listed = nullptr;
+  if (mSelectionInput) {
+    listed = mSelectionInput->GetEvents(aTask.entry);
+    if (!listed) return 0;
+  }
+
+  // Work out the context of each event, then hand the analysers all the events of the task at
+  // once, so they can batch their work across the spill (see AnalyserBase::AnalyseSpill)
+  std::vector<EventContext> contexts;
+  std::vector<int> events;
+  contexts.reserve(aTask.last - aTask.first);
+  events.reserve(aTask.last - aTask.first);
+  for (size_t i = aTask.first; i < aTask.last; ++i) {
+    int event = static_cast<int>(i);
+    if (listed && !std::binary_search(listed->begin(), listed->end(), event)) continue;
+    MAUS::MCEvent* mevt = nullptr;
+    if (mevts && i < mevts->size()) mevt = mevts->at(i);
+    contexts.emplace_back(revts->at(i), mevt, aTask.entry, event);
+    events.push_back(event);
+  }
+  std::vector<const EventContext*> pointers;
+  pointers.reserve(contexts.size());
+  for (const auto& context : contexts) pointers.push_back(&context);
+  aAnalysers.AnalyseSpill(pointers);
+
+  for (size_t i = 0; i < contexts.size(); ++i) {
+    if (mSelection && mSelection(contexts[i])) {
+      mWorkerSelected[aWorker].push_back(SelectionIndex::Entry(aTask.entry, events[i]));
+    }
+    if (mSlimOutput) mSlimOutput->Fill(contexts[i], aTask.entry, events[i]);
+  }
+  return static_cast<int>(contexts.size());
+}
+
+void EventLoop::collect_selected() {
+  mSelected = SelectionIndex(mSelectionName, mNEntries);
+  for (const auto& worker : mWorkerSelected) {
+    for (const auto& event : worker) mSelected.Add(event);
+  }
+  if (mSelection) {
+    MICA_LOG_INFO("Selection " << mSelectionName << ": " << mSelected.size() << " events in "
+                  << mSelected.GetEntries().size() << " spills");
+  }
+}
+} // ~namespace mica
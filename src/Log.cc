@@ -0,0 +1,102 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/Log.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace mica {
+
+std::atomic<int> Log::mLevel{MICA_LOG_LEVEL_INFO};
+
+namespace {
+
+// The sites are function-local statics which may be destroyed in any order relative to this
+// file's statics, so the state they use at exit is allocated once and never destroyed
+
+/** Keeps the lines of different threads apart */
+std::mutex& output_mutex() {
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+/** Guards sites() */
+std::mutex& sites_mutex() {
+  static std::mutex* mutex = new std::mutex();
+  return *mutex;
+}
+
+/** The places which have suppressed messages and are not yet destroyed */
+std::vector<LogSite*>& sites() {
+  static std::vector<LogSite*>* registered = new std::vector<LogSite*>();
+  return *registered;
+}
+
+/** Report the messages still suppressed when the programme ends */
+void flush_at_exit() {
+  Log::FlushSuppressed();
+}
+
+/** Return the prefix printed before a message of a level */
+const char* prefix(LogLevel aLevel) {
+  switch (aLevel) {
+    case LogLevel::kTrace: return "TRACE: ";
+    case LogLevel::kDebug: return "DEBUG: ";
+    case LogLevel::kInfo: return "";
+    case LogLevel::kWarning: return "WARNING: ";
+    case LogLevel::kError: return "ERROR: ";
+  }
+  return "";
+}
+} // ~anonymous namespace
+
+bool Log::SetLevel(const std::string& aName) {
+  if (aName == "trace") {
+    SetLevel(LogLevel::kTrace);
+  } else if (aName == "debug") {
+    SetLevel(LogLevel::kDebug);
+  } else if (aName == "info") {
+    SetLevel(LogLevel::kInfo);
+  } else if (aName == "warning") {
+    SetLevel(LogLevel::kWarning);
+  } else if (aName == "error") {
+    SetLevel(LogLevel::kError);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void Log::Write(LogLevel aLevel, const std::string& aMessage, long aNSuppressed) {
+  std::lock_guard<std::mutex> lock(output_mutex());
+  std::cerr << prefix(aLevel) << aMessage;
+  if (aNSuppressed > 0) std::cerr << " (" << aNSuppressed << " similar messages suppressed)";
+  std::cerr << '\n';
+}
+
+void Log::FlushSuppressed() {
+  std::lock_guard<std::mutex> lock(sites_mutex());
+  for (auto site : sites()) site->FlushSuppressed();
+}
+
+void Log::Register(LogSite* aSite) {
+  static bool registered_at_exit = false;
+  std::lock_guard<std::mutex> lock(sites_mutex());
+  if (!registered_at_exit) {
+    std::atexit(flush_at_exit);
+    registered_at_exit = true;
+  }
+  sites().push_back(aSite);
+}
+
+void Log::Unregister(LogSite* aSite) {
+  std::lock_guard<std::mutex> lock(sites_mutex());
+  aSite->FlushSuppressed();
+  sites().erase(std::remove(sites().begin(), sites().end(), aSite), sites().end());
+}
+} // ~namespace mica
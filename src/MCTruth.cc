@@ -0,0 +1,249 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <utility>
+
+#include "mica/MCTruth.hh"
+#include "mica/Log.hh"
+#include "mica/MemoryUsage.hh"
+
+namespace mica {
+
+const size_t MCTruth::kPoolSize;
+
+namespace {
+
+/** The idle truths of this thread, ready to be built again */
+thread_local std::vector<std::unique_ptr<MCTruth> > tPool;
+
+/** Estimated bytes held by the truths this thread has in use, while tracking */
+thread_local size_t tHeld = 0;
+
+/** Largest value of tHeld seen in any thread */
+std::atomic<size_t> gPeakHeld{0};
+} // ~anonymous namespace
+
+void MCTruth::release(const MCTruth* aTruth) {
+  MCTruth* truth = const_cast<MCTruth*>(aTruth);
+  tHeld -= std::min(tHeld, truth->mMemoryUsage);
+  truth->mMemoryUsage = 0;
+  if (tPool.size() < kPoolSize) {
+    tPool.emplace_back(truth);
+  } else {
+    delete truth;
+  }
+}
+
+size_t MCTruth::GetPeakMemoryUsage() {
+  return gPeakHeld.load();
+}
+
+MCTruth::Handle MCTruth::Make(MAUS::MCEvent* const aMCEvent, const Settings& aSettings) {
+  std::unique_ptr<MCTruth> truth;
+  if (!tPool.empty()) {
+    truth = std::move(tPool.back());
+    tPool.pop_back();
+  } else {
+    truth.reset(new MCTruth());
+  }
+  truth->Build(aMCEvent, aSettings);
+  return Handle(truth.release());
+}
+
+MCTruth::~MCTruth() {
+  tHeld -= std::min(tHeld, mMemoryUsage);
+}
+
+void MCTruth::Build(MAUS::MCEvent* const aMCEvent, const Settings& aSettings) {
+  tHeld -= std::min(tHeld, mMemoryUsage);
+  mMemoryUsage = 0;
+  mSettings = aSettings;
+  mValid = false;
+  mLookup.reset();
+  mMCDataTkU.clear();
+  mMCDataTkD.clear();
+  mDigitIds.clear();
+  mDigitOffsets.clear();
+  mDigitTracks.clear();
+  if (!aMCEvent) return;
+  mLookup.reset(new MAUS::SciFiLookup());
+  if (!mLookup->make_hits_map(aMCEvent)) {
+    MICA_LOG_WARNING("MCTruth::Build: Failed to make SciFiLookup");
+    return;
+  }
+  // The lookup hands out a copy of its map, so take it only once
+  const std::map<double, std::vector<MAUS::SciFiHit*> > hits_map = mLookup->get_hits_map();
+  if (hits_map.size() == 0) return;
+  mValid = true;
+  index_digits(hits_map);
+  fill_mc_track_data(aMCEvent);
+
+  if (MemoryUsage::IsEnabled()) {
+    mMemoryUsage = estimate_memory(hits_map);
+    tHeld += mMemoryUsage;
+    size_t peak = gPeakHeld.load();
+    while (tHeld > peak && !gPeakHeld.compare_exchange_weak(peak, tHeld)) {}
+  }
+}
+
+MCTruth::DigitTracks MCTruth::GetDigitTracks(double aDigitId) const {
+  DigitTracks result = {nullptr, nullptr};
+  auto id = std::lower_bound(mDigitIds.begin(), mDigitIds.end(), aDigitId);
+  if (id == mDigitIds.end() || *id != aDigitId) return result;
+  size_t index = id - mDigitIds.begin();
+  result.first = mDigitTracks.data() + mDigitOffsets[index];
+  result.last = mDigitTracks.data() + mDigitOffsets[index + 1];
+  return result;
+}
+
+size_t MCTruth::estimate_memory(
+    const std::map<double, std::vector<MAUS::SciFiHit*> >& aHitsMap) const {
+  size_t result = sizeof(MCTruth);
+  if (mLookup) {
+    // Estimate the lookup map as one tree node (about four pointers) per digit plus its hits
+    result += sizeof(MAUS::SciFiLookup);
+    for (const auto& digit : aHitsMap) {
+      result += sizeof(digit) + 4 * sizeof(void*) + MemoryUsage::OfElements(digit.second);
+    }
+  }
+  result += MemoryUsage::OfElements(mRecords);
+  for (const auto& record : mRecords) result += MemoryUsage::OfElements(record.stations_hit);
+  result += MemoryUsage::OfElements(mMCDataTkU) + MemoryUsage::OfElements(mMCDataTkD);
+  result += MemoryUsage::OfElements(mDigitIds) + MemoryUsage::OfElements(mDigitOffsets) +
+            MemoryUsage::OfElements(mDigitTracks);
+  for (int tracker = 0; tracker < 2; ++tracker) {
+    result += MemoryUsage::OfElements(mTrackIds[tracker]) +
+              MemoryUsage::OfElements(mTrackStations[tracker]);
+  }
+  return result + MemoryUsage::OfElements(mEntries);
+}
+
+void MCTruth::index_digits(const std::map<double, std::vector<MAUS::SciFiHit*> >& aHitsMap) {
+  mDigitIds.reserve(aHitsMap.size());
+  mDigitOffsets.reserve(aHitsMap.size() + 1);
+  for (const auto& digit : aHitsMap) {
+    size_t first = mDigitTracks.size();
+    mDigitIds.push_back(digit.first);
+    mDigitOffsets.push_back(first);
+    for (auto hit : digit.second) {
+      DigitTrack track;
+      track.track_id = hit->GetTrackId();
+      track.plane = TrackHitMasks::GetBit(hit->GetChannelId()->GetStationNumber(),
+                                          hit->GetChannelId()->GetPlaneNumber());
+      // A digit is made by very few tracks, so a linear search finds the repeats
+      bool repeat = false;
+      for (size_t i = first; i < mDigitTracks.size(); ++i) {
+        if (mDigitTracks[i].track_id == track.track_id) {
+          mDigitTracks[i].plane |= track.plane;
+          repeat = true;
+          break;
+        }
+      }
+      if (!repeat) mDigitTracks.push_back(track);
+    }
+  }
+  mDigitOffsets.push_back(mDigitTracks.size());
+}
+
+std::map<int, std::vector<int> > \
+    MCTruth::calc_stations_hit_by_track(std::map<int, std::vector<MAUS::SciFiHit*> >& hit_map,
+                                        int aNPlanes) {
+  TrackHitMasks masks;
+  for (auto& station : hit_map) {
+    for (auto hit : station.second) {
+      masks.Add(hit->GetTrackId(), station.first, hit->GetChannelId()->GetPlaneNumber());
+    }
+  }
+  std::map<int, std::vector<int> > stations_hit_by_track; // stations_hit_by_track[trk_id]
+  for (const auto& entry : masks.GetEntries()) {
+    unsigned int stations = TrackHitMasks::GetStationsHit(entry.mask, aNPlanes);
+    if (stations) station_numbers(stations, stations_hit_by_track[entry.track_id]);
+  }
+  return stations_hit_by_track;
+}
+
+void MCTruth::station_numbers(unsigned int aStations, std::vector<int>& aNumbers) {
+  aNumbers.clear();
+  for (int st = 1; st <= TrackHitMasks::kNStations; ++st) {
+    if (aStations & (1u << (st - 1))) aNumbers.push_back(st);
+  }
+}
+
+void MCTruth::fill_mc_track_data(MAUS::MCEvent* const aMCEvent) {
+  auto hits = aMCEvent->GetSciFiHits();
+  if (!hits) return;
+
+  // Record the planes hit by each track, for each tracker
+  for (auto& masks : mMasks) masks.Clear();
+  for (auto&& hit : *hits) {
+    int tracker = hit.GetChannelId()->GetTrackerNumber();
+    if (tracker != 0 && tracker != 1) continue;
+    mMasks[tracker].Add(hit.GetTrackId(), hit.GetChannelId()->GetStationNumber(),
+                        hit.GetChannelId()->GetPlaneNumber());
+  }
+
+  // See which track ids produced hits in n_planes or more planes of n_stations or more stations,
+  // that is all the track ids which could have created a reconstructible track
+  for (int tracker = 0; tracker < 2; ++tracker) {
+    mTrackIds[tracker].clear();
+    mTrackStations[tracker].clear();
+    mEntries.assign(mMasks[tracker].GetEntries().begin(), mMasks[tracker].GetEntries().end());
+    std::sort(mEntries.begin(), mEntries.end(),
+              [](const TrackHitMasks::Entry& a, const TrackHitMasks::Entry& b) {
+                return a.track_id < b.track_id;
+              });
+    for (const auto& entry : mEntries) {
+      unsigned int stations = TrackHitMasks::GetStationsHit(entry.mask, mSettings.n_planes);
+      if (TrackHitMasks::CountStations(entry.mask, mSettings.n_planes) < mSettings.n_stations) {
+        continue;
+      }
+      mTrackIds[tracker].push_back(entry.track_id);
+      mTrackStations[tracker].push_back(stations);
+    }
+  }
+
+  // One record per reconstructible track, TkU first. The array only ever grows, so the records
+  // keep their stations_hit capacity from event to event.
+  if (mRecords.size() < mTrackIds[0].size() + mTrackIds[1].size()) {
+    mRecords.resize(mTrackIds[0].size() + mTrackIds[1].size());
+  }
+  std::array<std::vector<const MCTrackData*>*, 2> data = {{&mMCDataTkU, &mMCDataTkD}};
+  std::array<size_t, 2> first_record = {{0, mTrackIds[0].size()}};
+  for (int tracker = 0; tracker < 2; ++tracker) {
+    data[tracker]->assign(mTrackIds[tracker].size(), nullptr);
+  }
+
+  // Take the data of each of those tracks from its first hit in the reference plane
+  for (auto&& hit_ref : *hits) {
+    MAUS::SciFiHit* hit = &hit_ref;
+    int tracker = hit->GetChannelId()->GetTrackerNumber();
+    if ((tracker != 0 && tracker != 1) || \
+        hit->GetChannelId()->GetStationNumber() != mSettings.ref_station || \
+        hit->GetChannelId()->GetPlaneNumber() != mSettings.ref_plane) continue;
+    const std::vector<int>& ids = mTrackIds[tracker];
+    auto id = std::lower_bound(ids.begin(), ids.end(), hit->GetTrackId());
+    if (id == ids.end() || *id != hit->GetTrackId()) continue;
+    size_t index = id - ids.begin();
+    if ((*data[tracker])[index]) continue;
+    MCTrackData& datum = mRecords[first_record[tracker] + index];
+    datum.tracker = tracker;
+    datum.track_id = hit->GetTrackId();
+    datum.pid = hit->GetParticleId();
+    datum.energy = hit->GetEnergy();
+    datum.pos = hit->GetPosition();
+    datum.mom = hit->GetMomentum();
+    station_numbers(mTrackStations[tracker][index], datum.stations_hit);
+    (*data[tracker])[index] = &datum;
+  }
+
+  // Drop the tracks with no hit in the reference plane
+  for (int tracker = 0; tracker < 2; ++tracker) {
+    data[tracker]->erase(std::remove(data[tracker]->begin(), data[tracker]->end(), nullptr),
+                         data[tracker]->end());
+  }
+}
+} // ~namespace mica
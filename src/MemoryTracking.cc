@@ -0,0 +1,86 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+// Replacements of the global allocation functions, counting the bytes allocated and freed by each
+// thread while MemoryUsage tracking is on. Only linked into the programmes which report memory,
+// never into the MicaCore library, since they take over the allocator of the whole programme.
+
+#include <cstdlib>
+#include <new>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "mica/MemoryUsage.hh"
+
+#ifdef __GLIBC__
+namespace mica {
+
+namespace {
+
+/** Tell MemoryUsage the allocations can be tracked, when the programme starts */
+const bool kTrackingRegistered = (MemoryUsage::SetTrackingAvailable(), true);
+
+/** Allocate as the standard operator new does, calling the new handler until malloc succeeds */
+void* allocate(std::size_t aSize) {
+  if (aSize == 0) aSize = 1;
+  void* ptr = nullptr;
+  while ((ptr = std::malloc(aSize)) == nullptr) {
+    std::new_handler handler = std::get_new_handler();
+    if (!handler) throw std::bad_alloc();
+    handler();
+  }
+  if (MemoryUsage::IsEnabled()) MemoryUsage::RecordAllocation(malloc_usable_size(ptr));
+  return ptr;
+}
+
+/** Free memory from allocate */
+void deallocate(void* aPtr) {
+  if (aPtr && MemoryUsage::IsEnabled()) MemoryUsage::RecordFree(malloc_usable_size(aPtr));
+  std::free(aPtr);
+}
+} // ~anonymous namespace
+} // ~namespace mica
+
+void* operator new(std::size_t aSize) {
+  return mica::allocate(aSize);
+}
+
+void* operator new[](std::size_t aSize) {
+  return mica::allocate(aSize);
+}
+
+void* operator new(std::size_t aSize, const std::nothrow_t&) noexcept {
+  try {
+    return mica::allocate(aSize);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void* operator new[](std::size_t aSize, const std::nothrow_t&) noexcept {
+  try {
+    return mica::allocate(aSize);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void operator delete(void* aPtr) noexcept {
+  mica::deallocate(aPtr);
+}
+
+void operator delete[](void* aPtr) noexcept {
+  mica::deallocate(aPtr);
+}
+
+void operator delete(void* aPtr, const std::nothrow_t&) noexcept {
+  mica::deallocate(aPtr);
+}
+
+void operator delete[](void* aPtr, const std::nothrow_t&) noexcept {
+  mica::deallocate(aPtr);
+}
+#endif
@@ -0,0 +1,146 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/MemoryUsage.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+
+#include "TArrayC.h"
+#include "TArrayD.h"
+#include "TArrayF.h"
+#include "TArrayI.h"
+#include "TArrayS.h"
+#include "TClass.h"
+
+namespace mica {
+
+std::atomic<bool> MemoryUsage::mEnabled{false};
+std::atomic<bool> MemoryUsage::mTrackingAvailable{false};
+
+namespace {
+
+thread_local long tLive = 0; ///< Bytes live on the heap from this thread, while tracking
+thread_local long tPeak = 0; ///< Highest value of tLive since the last reset
+
+/** Return the bytes per bin of a histogram, from the ROOT array class it inherits */
+size_t bytes_per_bin(const TH1* aHist) {
+  if (dynamic_cast<const TArrayD*>(aHist)) return sizeof(Double_t);
+  if (dynamic_cast<const TArrayF*>(aHist)) return sizeof(Float_t);
+  if (dynamic_cast<const TArrayI*>(aHist)) return sizeof(Int_t);
+  if (dynamic_cast<const TArrayS*>(aHist)) return sizeof(Short_t);
+  if (dynamic_cast<const TArrayC*>(aHist)) return sizeof(Char_t);
+  return sizeof(Double_t);
+}
+
+/** Return the bytes held by the bin edges of an axis, non-zero only for variable binning */
+size_t axis_bytes(const TAxis* aAxis) {
+  if (!aAxis || !aAxis->GetXbins()) return 0;
+  return aAxis->GetXbins()->GetSize() * sizeof(Double_t);
+}
+
+} // ~anonymous namespace
+
+size_t MemoryUsage::Of(const TH1* aHist) {
+  if (!aHist) return 0;
+  size_t result = aHist->IsA() ? aHist->IsA()->Size() : sizeof(TH1);
+  result += aHist->GetNcells() * bytes_per_bin(aHist);
+  result += aHist->GetSumw2N() * sizeof(Double_t);
+  result += aHist->GetBufferSize() * sizeof(Double_t);
+  result += axis_bytes(aHist->GetXaxis());
+  result += axis_bytes(aHist->GetYaxis());
+  result += axis_bytes(aHist->GetZaxis());
+  return result;
+}
+
+size_t MemoryUsage::Of(const TGraph* aGraph) {
+  if (!aGraph) return 0;
+  size_t result = aGraph->IsA() ? aGraph->IsA()->Size() : sizeof(TGraph);
+  return result + 2 * aGraph->GetMaxSize() * sizeof(Double_t);
+}
+
+void MemoryUsage::RecordAllocation(size_t aBytes) {
+  tLive += static_cast<long>(aBytes);
+  if (tLive > tPeak) tPeak = tLive;
+}
+
+void MemoryUsage::RecordFree(size_t aBytes) {
+  tLive -= static_cast<long>(aBytes);
+}
+
+long MemoryUsage::GetThreadLive() {
+  return tLive;
+}
+
+long MemoryUsage::GetThreadPeak() {
+  return tPeak;
+}
+
+void MemoryUsage::ResetThreadPeak() {
+  tPeak = tLive;
+}
+
+void MemoryReport::AddAnalyser(const std::string& aName, size_t aHeld, long aPeakTransient) {
+  AnalyserMemory memory;
+  memory.name = aName;
+  memory.held = aHeld;
+  memory.peak_transient = aPeakTransient;
+  memory.shared = false;
+  mAnalysers.push_back(memory);
+}
+
+void MemoryReport::AddShared(const std::string& aName, size_t aHeld) {
+  AnalyserMemory memory;
+  memory.name = aName + " (shared)";
+  memory.held = aHeld;
+  memory.peak_transient = 0;
+  memory.shared = true;
+  mAnalysers.push_back(memory);
+}
+
+size_t MemoryReport::GetTotalHeld() const {
+  size_t result = 0;
+  for (const auto& an : mAnalysers) result += an.held;
+  return result;
+}
+
+void MemoryReport::Print(std::ostream& aOut, int aNReplicas) const {
+  std::vector<AnalyserMemory> ranked = mAnalysers;
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [](const AnalyserMemory& a, const AnalyserMemory& b) {
+                     return a.held > b.held;
+                   });
+  const double mib = 1024.0 * 1024.0;
+  size_t total = GetTotalHeld();
+  bool tracked = MemoryUsage::IsEnabled() && MemoryUsage::IsTrackingAvailable();
+
+  aOut << "Memory summary (MiB held per replica, peak transient = largest heap growth "
+       << "during one event" << (tracked ? "" : ", not tracked") << ")\n";
+  aOut << std::left << std::setw(36) << "Analyser" << std::right << std::setw(12) << "Held"
+       << std::setw(8) << "%" << std::setw(16) << "Peak transient" << "\n";
+  int rank = 1;
+  aOut << std::fixed;
+  for (const auto& an : ranked) {
+    std::string name = std::to_string(rank++) + ". " + an.name;
+    aOut << std::left << std::setw(36) << name << std::right << std::setw(12)
+         << std::setprecision(3) << an.held / mib << std::setw(8) << std::setprecision(1)
+         << (total > 0 ? 100.0 * an.held / total : 0.0) << std::setw(16);
+    if (an.shared) {
+      aOut << "-";
+    } else {
+      aOut << std::setprecision(3) << (tracked ? std::max(an.peak_transient, 0L) / mib : 0.0);
+    }
+    aOut << "\n";
+  }
+  aOut << std::left << std::setw(36) << "Total per replica" << std::right << std::setw(12)
+       << std::setprecision(3) << total / mib << "\n";
+  if (aNReplicas > 1) {
+    aOut << std::left << std::setw(36) << ("Total for " + std::to_string(aNReplicas) + " replicas")
+         << std::right << std::setw(12) << aNReplicas * (total / mib) << "\n";
+  }
+  aOut.unsetf(std::ios::floatfield);
+}
+} // ~namespace mica
+
@@ -0,0 +1,193 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/ResultsFile.hh"
+
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#include "TFile.h"
+#include "TNamed.h"
+
+#include "mica/AnalyserFactory.hh"
+#include "mica/CutsBase.hh"
+#include "mica/Log.hh"
+#include "mica/StateIO.hh"
+
+namespace mica {
+
+namespace {
+
+/** The directory name of each analyser, its name, made unique by its position if necessary */
+std::vector<std::string> directory_names(const std::vector<std::string>& aNames) {
+  std::vector<std::string> result;
+  std::set<std::string> used;
+  for (size_t i = 0; i < aNames.size(); ++i) {
+    std::string name = aNames[i].empty() ? "analyser" : aNames[i];
+    if (used.count(name)) name += "_" + std::to_string(i);
+    used.insert(name);
+    result.push_back(name);
+  }
+  return result;
+}
+
+/** Write a list of names as the title of a TNamed */
+bool write_names(TDirectory* aDir, const std::string& aKey,
+                 const std::vector<std::string>& aNames) {
+  std::string list;
+  for (size_t i = 0; i < aNames.size(); ++i) list += (i > 0 ? " " : "") + aNames[i];
+  TNamed list_obj(aKey.c_str(), list.c_str());
+  return aDir->WriteTObject(&list_obj) > 0;
+}
+
+/** Return a list of names written by write_names */
+bool read_names(TDirectory* aDir, const std::string& aKey, std::vector<std::string>& aNames) {
+  if (!aDir) return false;
+  TNamed* list = nullptr;
+  aDir->GetObject(aKey.c_str(), list);
+  if (!list) return false;
+  std::stringstream names(list->GetTitle());
+  std::string name;
+  while (names >> name) aNames.push_back(name);
+  delete list;
+  return true;
+}
+
+/** The names of a list of cuts */
+std::vector<std::string> cut_names(const std::vector<CutsBase*>& aCuts) {
+  std::vector<std::string> result;
+  for (auto cut : aCuts) result.push_back(cut->GetName());
+  return result;
+}
+
+/** Create cuts from their names, returning false if any is unknown */
+bool create_cuts(const std::vector<std::string>& aNames, std::vector<CutsBase*>& aCuts) {
+  for (const auto& name : aNames) {
+    CutsBase* cut = AnalyserFactory::CreateCut(name);
+    if (!cut) {
+      MICA_LOG_WARNING("ResultsFile: Unknown cut " << name);
+      for (auto created : aCuts) delete created;
+      aCuts.clear();
+      return false;
+    }
+    aCuts.push_back(cut);
+  }
+  return true;
+}
+} // ~anonymous namespace
+
+bool ResultsFile::Write(const std::string& aFileName, AnalyserGroup& aAnalysers) {
+  TFile f(aFileName.c_str(), "RECREATE", "MICA results");
+  if (!f.IsOpen()) {
+    MICA_LOG_ERROR("Failed to open results file: " << aFileName);
+    return false;
+  }
+
+  std::vector<std::string> names;
+  for (size_t i = 0; i < aAnalysers.size(); ++i) names.push_back(aAnalysers[i]->GetName());
+  bool success = write_names(&f, "Analysers", names);
+
+  // The group-level cuts, with their settings and cut-flow counters
+  const CutRegistry& registry = aAnalysers.GetCutRegistry();
+  if (registry.size() > 0) {
+    std::vector<CutsBase*> cuts;
+    for (size_t i = 0; i < registry.size(); ++i) cuts.push_back(registry.GetCut(i));
+    TDirectory* dir = f.mkdir("cuts");
+    if (!write_names(&f, "Cuts", cut_names(cuts)) || !dir || !registry.Save(dir)) {
+      MICA_LOG_WARNING("ResultsFile: Could not save the group cuts");
+      success = false;
+    }
+  }
+
+  // Each analyser's results and options, the group cuts it subscribes to, and its own cuts
+  std::vector<std::string> dirs = directory_names(names);
+  for (size_t i = 0; i < aAnalysers.size(); ++i) {
+    TDirectory* dir = f.mkdir(dirs[i].c_str());
+    if (!dir || !aAnalysers[i]->Save(dir) ||
+        !StateIO::Save(dir, "CutMask", static_cast<Long64_t>(aAnalysers[i]->GetCutMask())) ||
+        !write_names(dir, "Cuts", cut_names(aAnalysers[i]->GetCuts()))) {
+      MICA_LOG_WARNING("ResultsFile: Could not save the results of " << dirs[i]);
+      success = false;
+    }
+  }
+  f.Close();
+  return success;
+}
+
+bool ResultsFile::Read(const std::string& aFileName, AnalyserGroup& aAnalysers) {
+  TFile f(aFileName.c_str(), "READ");
+  std::vector<std::string> names;
+  if (!f.IsOpen() || !read_names(&f, "Analysers", names)) {
+    MICA_LOG_ERROR("Failed to read results file: " << aFileName);
+    return false;
+  }
+
+  // Recreate the group-level cuts first, so the bits the analysers subscribe to line up
+  aAnalysers = AnalyserGroup();
+  bool success = true;
+  std::vector<std::string> group_cut_names;
+  std::vector<CutsBase*> group_cuts;
+  if (read_names(&f, "Cuts", group_cut_names) && !create_cuts(group_cut_names, group_cuts)) {
+    MICA_LOG_WARNING("ResultsFile: Could not restore the group cuts from " << aFileName);
+    success = false;
+  }
+  for (auto cut : group_cuts) aAnalysers.AddCut(cut);
+
+  std::vector<std::string> dirs = directory_names(names);
+  for (size_t i = 0; i < names.size(); ++i) {
+    AnalyserBase* analyser = AnalyserFactory::CreateAnalyser(names[i]);
+    if (!analyser) {
+      MICA_LOG_WARNING("ResultsFile: Unknown analyser " << names[i] << " in " << aFileName
+                       << ", skipping");
+      success = false;
+      continue;
+    }
+    TDirectory* dir = f.GetDirectory(dirs[i].c_str());
+    std::vector<std::string> own_cut_names;
+    std::vector<CutsBase*> own_cuts;
+    if (read_names(dir, "Cuts", own_cut_names) && !create_cuts(own_cut_names, own_cuts)) {
+      success = false;
+    }
+    for (auto cut : own_cuts) analyser->AdoptCut(cut);
+    if (!analyser->Load(dir)) {
+      MICA_LOG_WARNING("ResultsFile: Could not restore the results of " << dirs[i]
+                       << " from " << aFileName);
+      success = false;
+    }
+    aAnalysers.AddAnalyser(analyser);
+    Long64_t mask = 0;
+    StateIO::Load(dir, "CutMask", mask);
+    for (size_t j = 0; j < group_cuts.size(); ++j) {
+      if (mask & (Long64_t(1) << j)) aAnalysers.SubscribeCut(aAnalysers.size() - 1, static_cast<int>(j));
+    }
+  }
+  if (!group_cuts.empty() && !aAnalysers.GetCutRegistry().Load(f.GetDirectory("cuts"))) {
+    MICA_LOG_WARNING("ResultsFile: Could not restore the group cut flow from " << aFileName);
+    success = false;
+  }
+  return success;
+}
+
+bool ResultsFile::Read(const std::vector<std::string>& aFileNames, AnalyserGroup& aAnalysers) {
+  if (aFileNames.empty()) return false;
+  bool success = Read(aFileNames[0], aAnalysers);
+  for (size_t i = 1; i < aFileNames.size(); ++i) {
+    AnalyserGroup analysers;
+    if (!Read(aFileNames[i], analysers)) success = false;
+    bool same = analysers.size() == aAnalysers.size();
+    for (size_t j = 0; same && j < analysers.size(); ++j) {
+      same = analysers[j]->GetName() == aAnalysers[j]->GetName();
+    }
+    if (!same) {
+      MICA_LOG_WARNING("ResultsFile: " << aFileNames[i] << " holds different analysers "
+                       << "to " << aFileNames[0] << ", skipping");
+      success = false;
+      continue;
+    }
+    if (!aAnalysers.Merge(&analysers)) success = false;
+  }
+  return success;
+}
+} // ~namespace mica
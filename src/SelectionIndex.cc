@@ -0,0 +1,103 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/SelectionIndex.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+#include "mica/AnalyserTrackerPREfficiency.hh"
+#include "mica/CutsTOFTime.hh"
+#include "mica/Log.hh"
+
+namespace mica {
+
+void SelectionIndex::Add(Long64_t aEntry, int aEvent) {
+  std::vector<int>& events = mEvents[aEntry];
+  auto it = std::lower_bound(events.begin(), events.end(), aEvent);
+  if (it == events.end() || *it != aEvent) events.insert(it, aEvent);
+}
+
+size_t SelectionIndex::size() const {
+  size_t n = 0;
+  for (const auto& entry : mEvents) n += entry.second.size();
+  return n;
+}
+
+std::vector<Long64_t> SelectionIndex::GetEntries() const {
+  std::vector<Long64_t> entries;
+  entries.reserve(mEvents.size());
+  for (const auto& entry : mEvents) entries.push_back(entry.first);
+  return entries;
+}
+
+const std::vector<int>* SelectionIndex::GetEvents(Long64_t aEntry) const {
+  auto it = mEvents.find(aEntry);
+  return it != mEvents.end() ? &it->second : nullptr;
+}
+
+bool SelectionIndex::Write(const std::string& aFileName) const {
+  std::ofstream out(aFileName);
+  if (!out) return false;
+  out << "# MICA selection index: tree entry and recon event number of each selected event\n";
+  out << "selection " << mName << "\n";
+  out << "spills " << mNSpills << "\n";
+  for (const auto& entry : mEvents) {
+    for (int event : entry.second) out << entry.first << " " << event << "\n";
+  }
+  return static_cast<bool>(out);
+}
+
+bool SelectionIndex::Read(const std::string& aFileName) {
+  std::ifstream in(aFileName);
+  if (!in) {
+    MICA_LOG_ERROR("Failed to open selection index: " << aFileName);
+    return false;
+  }
+  mName = "";
+  mNSpills = 0;
+  mEvents.clear();
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::stringstream ss(line);
+    std::string key;
+    ss >> key;
+    if (key == "selection") {
+      ss >> mName;
+    } else if (key == "spills") {
+      ss >> mNSpills;
+    } else {
+      Long64_t entry = 0;
+      int event = 0;
+      std::stringstream values(line);
+      if (!(values >> entry >> event)) {
+        MICA_LOG_ERROR("Bad line in selection index " << aFileName << ": " << line);
+        return false;
+      }
+      Add(entry, event);
+    }
+  }
+  return true;
+}
+
+SelectionIndex::Selection SelectionIndex::MakeSelection(const std::string& aName,
+                                                        const AnalyserGroup& aAnalysers) {
+  if (aName == "CutsTOFTime") {
+    std::shared_ptr<CutsTOFTime> cut = std::make_shared<CutsTOFTime>();
+    return [cut](const EventContext& aContext) { return cut->Cut(aContext); };
+  }
+  if (aName == "AnalyserTrackerPREfficiency") {
+    for (size_t i = 0; i < aAnalysers.size(); ++i) {
+      const AnalyserTrackerPREfficiency* an =
+          dynamic_cast<const AnalyserTrackerPREfficiency*>(aAnalysers[i]);
+      if (an) return [an](const EventContext& aContext) { return an->IsGoodEvent(aContext); };
+    }
+  }
+  return Selection();
+}
+} // ~namespace mica
@@ -0,0 +1,296 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/SlimTree.hh"
+
+#include <algorithm>
+#include <iostream>
+
+#include "TChain.h"
+
+#include "mica/Log.hh"
+
+#include "src/common_cpp/DataStructure/SciFiEvent.hh"
+#include "src/common_cpp/DataStructure/SciFiHelicalPRTrack.hh"
+#include "src/common_cpp/DataStructure/SciFiTrack.hh"
+#include "src/common_cpp/DataStructure/SciFiTrackPoint.hh"
+#include "src/common_cpp/DataStructure/ThreeVector.hh"
+#include "src/common_cpp/DataStructure/TOFEvent.hh"
+#include "src/common_cpp/DataStructure/TOFEventSpacePoint.hh"
+#include "src/common_cpp/DataStructure/TOFSpacePoint.hh"
+
+namespace mica {
+
+namespace {
+
+const char* kTreeName = "SlimEvents";
+
+/** One branch of the slim tree */
+struct Column {
+  const char* name; ///< The branch name
+  void* address; ///< The row member holding the value
+  const char* count; ///< The branch holding the array length, empty for a single value
+  char type; ///< The ROOT leaf type code
+};
+
+/** Return the branches of a row */
+std::vector<Column> columns(SlimEvent& aRow) {
+  return {{"entry", &aRow.entry, "", 'L'},
+          {"event", &aRow.event, "", 'I'},
+          {"ntof1", &aRow.ntof1, "", 'I'},
+          {"ntof2", &aRow.ntof2, "", 'I'},
+          {"tof1_t", &aRow.tof1_t, "", 'D'},
+          {"tof2_t", &aRow.tof2_t, "", 'D'},
+          {"ntrk", &aRow.ntrk, "", 'I'},
+          {"trk_tracker", aRow.trk_tracker, "ntrk", 'I'},
+          {"trk_charge", aRow.trk_charge, "ntrk", 'I'},
+          {"trk_ndf", aRow.trk_ndf, "ntrk", 'I'},
+          {"trk_npoints", aRow.trk_npoints, "ntrk", 'I'},
+          {"trk_chi2", aRow.trk_chi2, "ntrk", 'D'},
+          {"trk_pvalue", aRow.trk_pvalue, "ntrk", 'D'},
+          {"trk_station", aRow.trk_station, "ntrk", 'I'},
+          {"trk_plane", aRow.trk_plane, "ntrk", 'I'},
+          {"trk_x", aRow.trk_x, "ntrk", 'D'},
+          {"trk_y", aRow.trk_y, "ntrk", 'D'},
+          {"trk_z", aRow.trk_z, "ntrk", 'D'},
+          {"trk_px", aRow.trk_px, "ntrk", 'D'},
+          {"trk_py", aRow.trk_py, "ntrk", 'D'},
+          {"trk_pz", aRow.trk_pz, "ntrk", 'D'},
+          {"nprh", &aRow.nprh, "", 'I'},
+          {"prh_tracker", aRow.prh_tracker, "nprh", 'I'},
+          {"prh_charge", aRow.prh_charge, "nprh", 'I'},
+          {"prh_npoints", aRow.prh_npoints, "nprh", 'I'},
+          {"prh_circle_ndf", aRow.prh_circle_ndf, "nprh", 'I'},
+          {"prh_sz_ndf", aRow.prh_sz_ndf, "nprh", 'I'},
+          {"prh_circle_chisq", aRow.prh_circle_chisq, "nprh", 'D'},
+          {"prh_sz_chisq", aRow.prh_sz_chisq, "nprh", 'D'},
+          {"prh_R", aRow.prh_R, "nprh", 'D'},
+          {"prh_x0", aRow.prh_x0, "nprh", 'D'},
+          {"prh_y0", aRow.prh_y0, "nprh", 'D'},
+          {"prh_dsdz", aRow.prh_dsdz, "nprh", 'D'},
+          {"prh_sz_c", aRow.prh_sz_c, "nprh", 'D'}};
+}
+} // ~anonymous namespace
+
+bool SlimEvent::Fill(const EventContext& aContext, int aStation, int aPlane) {
+  ntof1 = 0;
+  ntof2 = 0;
+  tof1_t = 0.0;
+  tof2_t = 0.0;
+  ntrk = 0;
+  nprh = 0;
+  bool complete = true;
+
+  std::vector<MAUS::TOFSpacePoint>* tof1 = aContext.GetTOFSpacePoints(1);
+  std::vector<MAUS::TOFSpacePoint>* tof2 = aContext.GetTOFSpacePoints(2);
+  if (tof1) ntof1 = static_cast<Int_t>(tof1->size());
+  if (tof2) ntof2 = static_cast<Int_t>(tof2->size());
+  if (ntof1 > 0) tof1_t = tof1->at(0).GetTime();
+  if (ntof2 > 0) tof2_t = tof2->at(0).GetTime();
+
+  for (auto trk : aContext.GetTracks()) {
+    if (ntrk == kMaxTracks) {
+      complete = false;
+      break;
+    }
+    int i = ntrk++;
+    trk_tracker[i] = trk->tracker();
+    trk_charge[i] = trk->charge();
+    trk_ndf[i] = trk->ndf();
+    trk_npoints[i] = static_cast<Int_t>(trk->scifitrackpoints().size());
+    trk_chi2[i] = trk->chi2();
+    trk_pvalue[i] = trk->P_value();
+    MAUS::SciFiTrackPoint* tp = aContext.GetTrackPoint(trk, aStation, aPlane);
+    trk_station[i] = tp ? aStation : 0;
+    trk_plane[i] = aPlane;
+    MAUS::ThreeVector pos = tp ? tp->pos() : MAUS::ThreeVector(0.0, 0.0, 0.0);
+    MAUS::ThreeVector mom = tp ? tp->mom() : MAUS::ThreeVector(0.0, 0.0, 0.0);
+    trk_x[i] = pos.x();
+    trk_y[i] = pos.y();
+    trk_z[i] = pos.z();
+    trk_px[i] = mom.x();
+    trk_py[i] = mom.y();
+    trk_pz[i] = mom.z();
+  }
+
+  if (!aContext.GetSciFiEvent()) return complete;
+  for (auto trk : aContext.GetSciFiEvent()->helicalprtracks()) {
+    if (nprh == kMaxTracks) {
+      complete = false;
+      break;
+    }
+    int i = nprh++;
+    prh_tracker[i] = trk->get_tracker();
+    prh_charge[i] = trk->get_charge();
+    prh_npoints[i] = trk->get_num_points();
+    prh_circle_ndf[i] = trk->get_circle_ndf();
+    prh_sz_ndf[i] = trk->get_line_sz_ndf();
+    prh_circle_chisq[i] = trk->get_circle_chisq();
+    prh_sz_chisq[i] = trk->get_line_sz_chisq();
+    prh_R[i] = trk->get_R();
+    prh_x0[i] = trk->get_circle_x0();
+    prh_y0[i] = trk->get_circle_y0();
+    prh_dsdz[i] = trk->get_dsdz();
+    prh_sz_c[i] = trk->get_line_sz_c();
+  }
+  return complete;
+}
+
+MAUS::ReconEvent* SlimEvent::MakeReconEvent() const {
+  MAUS::ReconEvent* revt = new MAUS::ReconEvent();
+  revt->SetPartEventNumber(event);
+
+  // TOF spacepoints, with only their time set
+  MAUS::TOFSpacePoint sp1;
+  sp1.SetTime(tof1_t);
+  MAUS::TOFSpacePoint sp2;
+  sp2.SetTime(tof2_t);
+  MAUS::TOFEventSpacePoint tofsps;
+  tofsps.SetTOF1SpacePointArray(std::vector<MAUS::TOFSpacePoint>(ntof1, sp1));
+  tofsps.SetTOF2SpacePointArray(std::vector<MAUS::TOFSpacePoint>(ntof2, sp2));
+  MAUS::TOFEvent* tofevt = new MAUS::TOFEvent();
+  tofevt->SetTOFEventSpacePoint(tofsps);
+  revt->SetTOFEvent(tofevt);
+
+  // Kalman tracks, each with its reference trackpoint
+  MAUS::SciFiEvent* sfevt = new MAUS::SciFiEvent();
+  for (int i = 0; i < ntrk; ++i) {
+    MAUS::SciFiTrack* trk = new MAUS::SciFiTrack();
+    trk->set_tracker(trk_tracker[i]);
+    trk->set_charge(trk_charge[i]);
+    trk->set_ndf(trk_ndf[i]);
+    trk->set_chi2(trk_chi2[i]);
+    trk->set_P_value(trk_pvalue[i]);
+    if (trk_station[i] > 0) {
+      MAUS::SciFiTrackPoint* tp = new MAUS::SciFiTrackPoint();
+      tp->set_tracker(trk_tracker[i]);
+      tp->set_station(trk_station[i]);
+      tp->set_plane(trk_plane[i]);
+      tp->set_pos(MAUS::ThreeVector(trk_x[i], trk_y[i], trk_z[i]));
+      tp->set_mom(MAUS::ThreeVector(trk_px[i], trk_py[i], trk_pz[i]));
+      trk->add_scifitrackpoint(tp);
+    }
+    sfevt->add_scifitrack(trk);
+  }
+
+  // Helical pattern recognition tracks, without their spacepoints
+  for (int i = 0; i < nprh; ++i) {
+    MAUS::SciFiHelicalPRTrack* trk = new MAUS::SciFiHelicalPRTrack();
+    trk->set_tracker(prh_tracker[i]);
+    trk->set_charge(prh_charge[i]);
+    trk->set_num_points(prh_npoints[i]);
+    trk->set_circle_ndf(prh_circle_ndf[i]);
+    trk->set_line_sz_ndf(prh_sz_ndf[i]);
+    trk->set_circle_chisq(prh_circle_chisq[i]);
+    trk->set_line_sz_chisq(prh_sz_chisq[i]);
+    trk->set_R(prh_R[i]);
+    trk->set_circle_x0(prh_x0[i]);
+    trk->set_circle_y0(prh_y0[i]);
+    trk->set_dsdz(prh_dsdz[i]);
+    trk->set_line_sz_c(prh_sz_c[i]);
+    sfevt->add_helicalprtrack(trk);
+  }
+  revt->SetSciFiEvent(sfevt);
+  return revt;
+}
+
+void SlimEvent::Branch(TTree* aTree) {
+  for (const auto& col : columns(*this)) {
+    std::string leaves = col.name;
+    if (col.count[0] != '\0') leaves += std::string("[") + col.count + "]";
+    leaves += std::string("/") + col.type;
+    aTree->Branch(col.name, col.address, leaves.c_str());
+  }
+}
+
+void SlimEvent::SetBranchAddresses(TTree* aTree) {
+  for (const auto& col : columns(*this)) aTree->SetBranchAddress(col.name, col.address);
+}
+
+SlimTreeWriter::SlimTreeWriter(int aStation, int aPlane) : mStation{aStation},
+                                                           mPlane{aPlane},
+                                                           mTree{nullptr},
+                                                           mRow(),
+                                                           mNRows{0},
+                                                           mNTruncated{0} {
+  // Do nothing
+}
+
+bool SlimTreeWriter::Open(const std::string& aFileName) {
+  Close();
+  mFile.reset(new TFile(aFileName.c_str(), "RECREATE", "MICA slim tracker ntuple"));
+  if (!mFile->IsOpen()) {
+    MICA_LOG_ERROR("Failed to open slim ntuple file: " << aFileName);
+    mFile.reset();
+    return false;
+  }
+  mTree = new TTree(kTreeName, "MICA slim tracker ntuple");
+  mTree->SetDirectory(mFile.get());
+  mRow.Branch(mTree);
+  mNRows = 0;
+  mNTruncated = 0;
+  return true;
+}
+
+void SlimTreeWriter::Fill(const EventContext& aContext, Long64_t aEntry, int aEvent) {
+  // Work out the row outside the lock, so only the copy and the tree fill are serialised
+  SlimEvent row;
+  row.entry = aEntry;
+  row.event = aEvent;
+  bool complete = row.Fill(aContext, mStation, mPlane);
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mTree) return;
+  mRow = row;
+  mTree->Fill();
+  ++mNRows;
+  if (!complete) ++mNTruncated;
+}
+
+bool SlimTreeWriter::Close() {
+  if (!mFile) return true;
+  mFile->cd();
+  bool written = mTree->Write() > 0;
+  mFile->Close();
+  mFile.reset();
+  mTree = nullptr;
+  MICA_LOG_INFO("Slim ntuple: " << mNRows << " events written");
+  if (mNTruncated > 0) {
+    MICA_LOG_WARNING("SlimTreeWriter: " << mNTruncated << " events had more than "
+                     << SlimEvent::kMaxTracks
+                     << " tracks of a kind, the extra tracks were dropped");
+  }
+  return written;
+}
+
+bool SlimTreeReader::Run(const std::vector<std::string>& aFileNames, AnalyserGroup& aAnalysers) {
+  TChain chain(kTreeName);
+  for (const auto& fname : aFileNames) {
+    if (chain.Add(fname.c_str(), 0) < 1) {
+      MICA_LOG_ERROR("Failed to find " << kTreeName << " tree in file: " << fname);
+      return false;
+    }
+  }
+  unsigned int missing = aAnalysers.GetDataRequirements() & ~SlimEvent::kDataRequirements;
+  if (missing != kNoData) {
+    MICA_LOG_WARNING("SlimTreeReader: The slim ntuple does not hold "
+                     << BranchSelector::Describe(missing) << ", analysers using it will see none");
+  }
+
+  SlimEvent row;
+  row.SetBranchAddresses(&chain);
+  Long64_t nentries = chain.GetEntries();
+  MICA_LOG_INFO("Found " << nentries << " events in " << chain.GetNtrees() << " slim files");
+  for (Long64_t i = 0; i < nentries; ++i) {
+    chain.GetEntry(i);
+    std::unique_ptr<MAUS::ReconEvent> revt(row.MakeReconEvent());
+    aAnalysers.Analyse(EventContext(revt.get(), nullptr));
+    if ((i + 1) % 100000 == 0 || i + 1 == nentries) {
+      MICA_LOG_INFO("Events processed: " << (i + 1) << " of " << nentries);
+    }
+  }
+  chain.ResetBranchAddresses();
+  return true;
+}
+} // ~namespace mica
@@ -0,0 +1,47 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/SpillReader.hh"
+
+#include "TChain.h"
+
+namespace mica {
+
+SpillReader::SpillReader(const std::vector<std::string>& aFileNames, size_t aDepth, EntrySource aSource,
+                         unsigned int aRequirements)
+    : mFileNames{aFileNames}, mSource{aSource}, mRequirements{aRequirements}, mQueue{aDepth} {
+  mThread = std::thread(&SpillReader::read, this);
+}
+
+SpillReader::~SpillReader() {
+  mQueue.Close(); // Release the reader if it is waiting on a full queue
+  if (mThread.joinable()) mThread.join();
+}
+
+void SpillReader::read() {
+  TChain chain("Spill");
+  for (const auto& fname : mFileNames) {
+    chain.Add(fname.c_str());
+  }
+  TTree* T = &chain;
+  BranchSelector::Apply(T, mRequirements);
+
+  // Each entry is read into a new MAUS::Data so that ownership can pass to the consumer
+  MAUS::Data* data = nullptr;
+  for (Long64_t i = mSource(); i >= 0; i = mSource()) {
+    data = new MAUS::Data();
+    T->SetBranchAddress("data", &data);
+    if (TimingStats::IsEnabled()) {
+      TimingStats::Clock::time_point start = TimingStats::Clock::now();
+      int nbytes = T->GetEntry(i);
+      mReadTiming.Record(start, nbytes > 0);
+    } else {
+      T->GetEntry(i);
+    }
+    if (!mQueue.Push(Entry(i, std::unique_ptr<MAUS::Data>(data)))) break;
+  }
+  T->ResetBranchAddresses();
+  mQueue.Close();
+}
+} // ~namespace mica
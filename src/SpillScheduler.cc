@@ -0,0 +1,74 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/SpillScheduler.hh"
+
+#include <utility>
+
+namespace mica {
+
+SpillScheduler::SpillScheduler(int aNWorkers) : mVersion{0} {
+  for (int i = 0; i < aNWorkers; ++i) {
+    mQueues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+  }
+}
+
+void SpillScheduler::Push(int aWorker, SpillTask aTask) {
+  WorkerQueue& q = *mQueues[aWorker];
+  {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    q.tasks.push_back(std::move(aTask));
+  }
+  Notify();
+}
+
+bool SpillScheduler::Pop(int aWorker, SpillTask& aTask) {
+  WorkerQueue& q = *mQueues[aWorker];
+  std::lock_guard<std::mutex> lock(q.mutex);
+  if (q.tasks.empty()) return false;
+  aTask = std::move(q.tasks.back());
+  q.tasks.pop_back();
+  return true;
+}
+
+bool SpillScheduler::Steal(int aWorker, SpillTask& aTask) {
+  // Start with the next worker along, so thieves spread themselves over the victims
+  int nworkers = GetNWorkers();
+  for (int i = 1; i < nworkers; ++i) {
+    WorkerQueue& q = *mQueues[(aWorker + i) % nworkers];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty()) continue;
+    aTask = std::move(q.tasks.front());
+    q.tasks.pop_front();
+    return true;
+  }
+  return false;
+}
+
+bool SpillScheduler::Empty() const {
+  for (auto& q : mQueues) {
+    std::lock_guard<std::mutex> lock(q->mutex);
+    if (!q->tasks.empty()) return false;
+  }
+  return true;
+}
+
+unsigned long SpillScheduler::GetVersion() const {
+  std::lock_guard<std::mutex> lock(mWaitMutex);
+  return mVersion;
+}
+
+void SpillScheduler::Wait(unsigned long aVersion) const {
+  std::unique_lock<std::mutex> lock(mWaitMutex);
+  mWaitCV.wait(lock, [this, aVersion] { return mVersion != aVersion; });
+}
+
+void SpillScheduler::Notify() {
+  {
+    std::lock_guard<std::mutex> lock(mWaitMutex);
+    ++mVersion;
+  }
+  mWaitCV.notify_all();
+}
+} // ~namespace mica
@@ -0,0 +1,111 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/StateIO.hh"
+
+#include <memory>
+
+#include "TParameter.h"
+
+namespace mica {
+
+namespace {
+
+template <typename T>
+bool save_parameter(TDirectory* aDir, const std::string& aKey, T aValue) {
+  if (!aDir) return false;
+  TParameter<T> par(aKey.c_str(), aValue);
+  return aDir->WriteTObject(&par, aKey.c_str()) > 0;
+}
+
+template <typename T>
+bool load_parameter(TDirectory* aDir, const std::string& aKey, T& aValue) {
+  if (!aDir) return false;
+  TParameter<T>* par = nullptr;
+  aDir->GetObject(aKey.c_str(), par);
+  if (!par) return false;
+  aValue = par->GetVal();
+  delete par;
+  return true;
+}
+} // ~anonymous namespace
+
+bool StateIO::Save(TDirectory* aDir, const TH1* aHist) {
+  if (!aDir || !aHist) return false;
+  return aDir->WriteTObject(aHist, aHist->GetName()) > 0;
+}
+
+bool StateIO::Load(TDirectory* aDir, TH1* aHist) {
+  if (!aDir || !aHist) return false;
+  TH1* saved = nullptr;
+  aDir->GetObject(aHist->GetName(), saved);
+  if (!saved) return false;
+  std::unique_ptr<TH1> owner(saved);
+  aHist->Reset();
+  return aHist->Add(saved);
+}
+
+bool StateIO::Save(TDirectory* aDir, const std::vector<TH1*>& aHists) {
+  bool result = true;
+  for (auto hist : aHists) {
+    if (!Save(aDir, hist)) result = false;
+  }
+  return result;
+}
+
+bool StateIO::Load(TDirectory* aDir, const std::vector<TH1*>& aHists) {
+  bool result = true;
+  for (auto hist : aHists) {
+    if (!Load(aDir, hist)) result = false;
+  }
+  return result;
+}
+
+bool StateIO::Save(TDirectory* aDir, const std::string& aKey, double aValue) {
+  return save_parameter<double>(aDir, aKey, aValue);
+}
+
+bool StateIO::Save(TDirectory* aDir, const std::string& aKey, int aValue) {
+  return save_parameter<int>(aDir, aKey, aValue);
+}
+
+bool StateIO::Save(TDirectory* aDir, const std::string& aKey, Long64_t aValue) {
+  return save_parameter<Long64_t>(aDir, aKey, aValue);
+}
+
+bool StateIO::Load(TDirectory* aDir, const std::string& aKey, double& aValue) {
+  return load_parameter<double>(aDir, aKey, aValue);
+}
+
+bool StateIO::Load(TDirectory* aDir, const std::string& aKey, int& aValue) {
+  return load_parameter<int>(aDir, aKey, aValue);
+}
+
+bool StateIO::Load(TDirectory* aDir, const std::string& aKey, Long64_t& aValue) {
+  return load_parameter<Long64_t>(aDir, aKey, aValue);
+}
+
+bool StateIO::Load(TDirectory* aDir, const std::string& aKey, bool& aValue) {
+  int value = 0;
+  if (!load_parameter<int>(aDir, aKey, value)) return false;
+  aValue = (value != 0);
+  return true;
+}
+
+bool StateIO::Save(TDirectory* aDir, const std::string& aKey,
+                   const std::vector<Long64_t>& aValues) {
+  if (!aDir) return false;
+  return aDir->WriteObject(&aValues, aKey.c_str()) > 0;
+}
+
+bool StateIO::Load(TDirectory* aDir, const std::string& aKey, std::vector<Long64_t>& aValues) {
+  if (!aDir) return false;
+  std::vector<Long64_t>* values = nullptr;
+  aDir->GetObject(aKey.c_str(), values);
+  if (!values) return false;
+  aValues.swap(*values);
+  delete values;
+  return true;
+}
+} // ~namespace mica
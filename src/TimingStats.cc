@@ -0,0 +1,175 @@
+/* This file is part of the MICA (Muon Ionization Cooling Analysis) package.
+ * Author: A. Dobbs
+ */
+
+#include "mica/TimingStats.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace mica {
+
+std::atomic<bool> TimingStats::mEnabled{false};
+
+namespace {
+
+/** Return a string quoted for JSON, with quotes, backslashes and control characters escaped */
+std::string json_string(const std::string& aString) {
+  std::ostringstream out;
+  out << '"';
+  for (char c : aString) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (c == '\n') {
+      out << "\\n";
+    } else if (c == '\t') {
+      out << "\\t";
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+          << static_cast<int>(c) << std::dec << std::setfill(' ');
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+  return out.str();
+}
+
+/** Write one TimingStats as a JSON object */
+void write_json(std::ostream& aOut, const TimingStats& aStats) {
+  aOut << "{\"calls\": " << aStats.GetCalls() << ", \"passed\": " << aStats.GetPassed()
+       << ", \"failed\": " << aStats.GetFailed() << ", \"total_s\": " << aStats.GetTotal()
+       << ", \"mean_s\": " << aStats.GetMean() << ", \"max_s\": " << aStats.GetMax()
+       << ", \"p50_s\": " << aStats.GetQuantile(0.5) << ", \"p99_s\": "
+       << aStats.GetQuantile(0.99) << ", \"latency_log2_ns\": [";
+  for (int i = 0; i < TimingStats::kNBuckets; ++i) {
+    aOut << (i > 0 ? ", " : "") << aStats.GetBuckets()[i];
+  }
+  aOut << "]}";
+}
+
+/** Print one row of the summary table */
+void print_row(std::ostream& aOut, const std::string& aName, const TimingStats& aStats,
+               double aGrandTotal) {
+  std::ios::fmtflags flags = aOut.flags();
+  std::streamsize precision = aOut.precision();
+  aOut << std::left << std::setw(36) << aName << std::right << std::setw(10) << aStats.GetCalls()
+       << std::setw(10) << aStats.GetPassed() << std::setw(12) << std::fixed
+       << std::setprecision(3) << aStats.GetTotal() << std::setw(8) << std::setprecision(1)
+       << (aGrandTotal > 0.0 ? 100.0 * aStats.GetTotal() / aGrandTotal : 0.0)
+       << std::setw(12) << std::setprecision(2) << aStats.GetMean() * 1e6
+       << std::setw(12) << aStats.GetQuantile(0.99) * 1e6
+       << std::setw(12) << aStats.GetMax() * 1e6 << "\n";
+  aOut.flags(flags);
+  aOut.precision(precision);
+}
+} // ~anonymous namespace
+
+TimingStats::TimingStats() : mCalls{0}, mPassed{0}, mTotal{0.0}, mMax{0.0}, mBuckets() {
+  mBuckets.fill(0);
+}
+
+void TimingStats::Record(double aSeconds, bool aPassed) {
+  ++mCalls;
+  if (aPassed) ++mPassed;
+  mTotal += aSeconds;
+  if (aSeconds > mMax) mMax = aSeconds;
+  double ns = aSeconds * 1e9;
+  int bin = ns < 1.0 ? 0 : std::ilogb(ns);
+  mBuckets[std::min(bin, kNBuckets - 1)] += 1;
+}
+
+TimingStats& TimingStats::operator+=(const TimingStats& aOther) {
+  mCalls += aOther.mCalls;
+  mPassed += aOther.mPassed;
+  mTotal += aOther.mTotal;
+  mMax = std::max(mMax, aOther.mMax);
+  for (int i = 0; i < kNBuckets; ++i) mBuckets[i] += aOther.mBuckets[i];
+  return *this;
+}
+
+double TimingStats::GetQuantile(double aFraction) const {
+  if (mCalls == 0) return 0.0;
+  long target = static_cast<long>(std::ceil(aFraction * mCalls));
+  long sum = 0;
+  for (int i = 0; i < kNBuckets; ++i) {
+    sum += mBuckets[i];
+    if (sum >= target) return std::min(std::ldexp(1.0, i + 1) * 1e-9, mMax);
+  }
+  return mMax;
+}
+
+void TimingReport::AddAnalyser(const std::string& aName, const TimingStats& aAnalyse,
+                               const TimingStats& aCuts) {
+  AnalyserTiming timing;
+  timing.name = aName;
+  timing.analyse = aAnalyse;
+  timing.cuts = aCuts;
+  mAnalysers.push_back(timing);
+}
+
+void TimingReport::AddStage(const std::string& aName, const TimingStats& aStats) {
+  mStages.push_back(std::make_pair(aName, aStats));
+}
+
+std::vector<TimingReport::AnalyserTiming> TimingReport::ranked() const {
+  std::vector<AnalyserTiming> result = mAnalysers;
+  std::stable_sort(result.begin(), result.end(),
+                   [](const AnalyserTiming& a, const AnalyserTiming& b) {
+                     return a.analyse.GetTotal() + a.cuts.GetTotal() >
+                            b.analyse.GetTotal() + b.cuts.GetTotal();
+                   });
+  return result;
+}
+
+void TimingReport::Print(std::ostream& aOut) const {
+  double total = 0.0;
+  for (const auto& stage : mStages) total += stage.second.GetTotal();
+  for (const auto& an : mAnalysers) total += an.analyse.GetTotal() + an.cuts.GetTotal();
+
+  std::ios::fmtflags flags = aOut.flags();
+  aOut << "Timing summary (total " << total << " s, times per call in us, "
+       << "passed = analysed for analysers, passed cuts for cuts)\n";
+  aOut << std::left << std::setw(36) << "Stage" << std::right << std::setw(10) << "Calls"
+       << std::setw(10) << "Passed" << std::setw(12) << "Total(s)" << std::setw(8) << "%"
+       << std::setw(12) << "Mean" << std::setw(12) << "p99" << std::setw(12) << "Max" << "\n";
+  for (const auto& stage : mStages) {
+    print_row(aOut, stage.first, stage.second, total);
+  }
+  int rank = 1;
+  for (const auto& an : ranked()) {
+    std::string name = std::to_string(rank++) + ". " + an.name;
+    print_row(aOut, name, an.analyse, total);
+    if (an.cuts.GetCalls() > 0) print_row(aOut, "     cuts", an.cuts, total);
+  }
+  aOut.flags(flags);
+}
+
+bool TimingReport::WriteJson(const std::string& aFileName) const {
+  std::ofstream out(aFileName);
+  if (!out) return false;
+  out << std::setprecision(9);
+  out << "{\n  \"stages\": [";
+  for (size_t i = 0; i < mStages.size(); ++i) {
+    out << (i > 0 ? "," : "") << "\n    {\"name\": " << json_string(mStages[i].first)
+        << ", \"timing\": ";
+    write_json(out, mStages[i].second);
+    out << "}";
+  }
+  out << "\n  ],\n  \"analysers\": [";
+  std::vector<AnalyserTiming> analysers = ranked();
+  for (size_t i = 0; i < analysers.size(); ++i) {
+    out << (i > 0 ? "," : "") << "\n    {\"rank\": " << i + 1 << ", \"name\": "
+        << json_string(analysers[i].name) << ", \"analyse\": ";
+    write_json(out, analysers[i].analyse);
+    out << ", \"cuts\": ";
+    write_json(out, analysers[i].cuts);
+    out << "}";
+  }
+  out << "\n  ]\n}\n";
+  return static_cast<bool>(out);
+}
+} // ~namespace mica